@@ -4,9 +4,31 @@
 #include <stdint.h>
 
 int LLVMFuzzerTestOneInput(const uint8_t *Data, size_t Size) {
-    buffer_t buf = {.offset = 0, .ptr = Data, .size = Size};
+    if (Size == 0) {
+        return 0;
+    }
+
+    // first byte selects the chunk size used to feed the streaming parser
+    size_t chunk_size = Data[0] + 1;
+    buffer_t buf = {.offset = 0, .ptr = Data + 1, .size = Size - 1};
+    tx_parser_t parser;
     transaction_t tx = {0};
+    parser_status_e status = PARSING_OK;
+
+    transaction_parser_init(&parser, &tx);
+    while (status == PARSING_OK && buf.offset < buf.size) {
+        size_t len = buf.size - buf.offset < chunk_size ? buf.size - buf.offset : chunk_size;
+        buffer_t chunk = {.offset = 0, .ptr = buf.ptr + buf.offset, .size = len};
+
+        status = transaction_parse_chunk(&parser, &chunk, &tx);
+        buf.offset += len;
+    }
+    if (status == PARSING_OK) {
+        transaction_parse_finish(&parser);
+    }
 
-    transaction_deserialize(&buf, &tx);
+    buf.offset = 0;
+    transaction_t whole = {0};
+    transaction_deserialize(&buf, &whole);
     return 0;
 }
@@ -28,7 +28,12 @@
 #include "handler/get_version.h"
 #include "handler/get_app_name.h"
 #include "handler/get_public_key.h"
+#include "handler/get_public_keys.h"
+#include "handler/get_account_xpub.h"
 #include "handler/sign_tx.h"
+#include "handler/sign_tx_batch.h"
+#include "handler/resign_tx.h"
+#include "handler/sign_session.h"
 
 int apdu_dispatcher(const command_t *cmd) {
     if (cmd->cla != CLA) {
@@ -37,6 +42,13 @@ int apdu_dispatcher(const command_t *cmd) {
 
     buffer_t buf = {0};
 
+    // While a review is started with the first part of a transaction, only the next parts of that transaction are
+    // accepted until the user rejects it, with SIGN_TX or within a session
+    if ((G_context.review_stream == REVIEW_STREAM_REVIEWING || G_context.review_stream == REVIEW_STREAM_WAITING) &&
+        !(cmd->ins == SIGN_TX && cmd->p1 != P1_START) && !(cmd->ins == SIGN_SESSION && cmd->p1 == P1_SESSION_TX)) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+
     switch (cmd->ins) {
         case GET_VERSION:
             if (cmd->p1 != 0 || cmd->p2 != 0) {
@@ -51,7 +63,7 @@ int apdu_dispatcher(const command_t *cmd) {
 
             return handler_get_app_name();
         case GET_PUBLIC_KEY:
-            if (cmd->p1 > 0 || cmd->p2 > 1) {
+            if (cmd->p1 > PUBKEY_FORMAT_ADDRESS || cmd->p2 > 1) {
                 return io_send_sw(SW_WRONG_P1P2);
             }
 
@@ -63,11 +75,57 @@ int apdu_dispatcher(const command_t *cmd) {
             buf.size = cmd->lc;
             buf.offset = 0;
 
-            return handler_get_public_key(&buf, (bool) cmd->p2);
+            return handler_get_public_key(&buf, (pubkey_format_e) cmd->p1, (bool) cmd->p2);
+        case GET_PUBLIC_KEYS:
+            if ((cmd->p1 != PUBKEY_FORMAT_COMPRESSED && cmd->p1 != PUBKEY_FORMAT_SCRIPT_HASH) || cmd->p2 != 0) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            if (!cmd->data) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+
+            buf.ptr = cmd->data;
+            buf.size = cmd->lc;
+            buf.offset = 0;
+
+            return handler_get_public_keys(&buf, (pubkey_format_e) cmd->p1);
+        case GET_ACCOUNT_XPUB:
+            if (cmd->p1 != 0 || cmd->p2 != 0) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            if (!cmd->data) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+
+            buf.ptr = cmd->data;
+            buf.size = cmd->lc;
+            buf.offset = 0;
+
+            return handler_get_account_xpub(&buf);
         case SIGN_TX:
-            if ((cmd->p1 == P1_START && cmd->p2 != P2_MORE) ||  // first apdu must be the BIP44 path
-                cmd->p1 > P1_MAX ||                             //
-                (cmd->p2 != P2_LAST && cmd->p2 != P2_MORE)) {
+            // P1_START with P2_LAST is the compact mode: BIP44 path, network magic and transaction in one APDU
+            if (cmd->p1 > P1_MAX || (cmd->p2 & ~(P2_MORE | P2_OFFSET | P2_COMPRESSED | P2_PATHS)) != 0) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            if (!cmd->data) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+
+            buf.ptr = cmd->data;
+            buf.size = cmd->lc;
+            buf.offset = 0;
+
+            return handler_sign_tx(&buf,
+                                   cmd->p1,
+                                   (bool) (cmd->p2 & P2_MORE),
+                                   (bool) (cmd->p2 & P2_OFFSET),
+                                   (bool) (cmd->p2 & P2_COMPRESSED),
+                                   (bool) (cmd->p2 & P2_PATHS));
+        case SIGN_TX_BATCH:
+            if (cmd->p1 > P1_BATCH_SIGNATURE || (cmd->p2 & ~(P2_MORE | P2_OFFSET | P2_COMPRESSED)) != 0) {
                 return io_send_sw(SW_WRONG_P1P2);
             }
 
@@ -79,7 +137,46 @@ int apdu_dispatcher(const command_t *cmd) {
             buf.size = cmd->lc;
             buf.offset = 0;
 
-            return handler_sign_tx(&buf, cmd->p1, (bool) (cmd->p2 & P2_MORE));
+            return handler_sign_tx_batch(&buf,
+                                         cmd->p1,
+                                         (bool) (cmd->p2 & P2_MORE),
+                                         (bool) (cmd->p2 & P2_OFFSET),
+                                         (bool) (cmd->p2 & P2_COMPRESSED));
+#ifdef HAVE_RESIGN_TX
+        case RESIGN_TX:
+            if (cmd->p1 != 0 || cmd->p2 != 0) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            if (!cmd->data) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+
+            buf.ptr = cmd->data;
+            buf.size = cmd->lc;
+            buf.offset = 0;
+
+            return handler_resign_tx(&buf);
+#endif
+        case SIGN_SESSION:
+            if (cmd->p1 > P1_SESSION_TX || (cmd->p1 < P1_SESSION_TX_START && cmd->p2 != 0) ||
+                (cmd->p2 & ~(P2_MORE | P2_COMPRESSED)) != 0) {
+                return io_send_sw(SW_WRONG_P1P2);
+            }
+
+            // closing the session has no data
+            if (!cmd->data && cmd->p1 != P1_SESSION_CLOSE) {
+                return io_send_sw(SW_WRONG_DATA_LENGTH);
+            }
+
+            buf.ptr = cmd->data;
+            buf.size = cmd->lc;
+            buf.offset = 0;
+
+            return handler_sign_session(&buf,
+                                        cmd->p1,
+                                        (bool) (cmd->p2 & P2_MORE),
+                                        (bool) (cmd->p2 & P2_COMPRESSED));
         default:
             return io_send_sw(SW_INS_NOT_SUPPORTED);
     }
@@ -10,6 +10,23 @@
  * Parameter 2 for more APDU to receive.
  */
 #define P2_MORE 0x80
+/**
+ * Parameter 2 flag for a transaction chunk starting with its byte offset in the transaction.
+ * The response to each chunk is then the number of transaction bytes received so far, so that an interrupted upload
+ * can resume from there. Chunks, or parts of them, which were already received are skipped.
+ */
+#define P2_OFFSET 0x40
+/**
+ * Parameter 2 flag for a transaction sent in the compressed encoding of expander.h.
+ * It is set on the network magic APDU and on every transaction chunk, or on the compact mode APDU. Chunks of a
+ * compressed transaction can't be sent with their offset: it would not locate them in the compressed stream.
+ */
+#define P2_COMPRESSED 0x20
+/**
+ * Parameter 2 flag for a first SIGN_TX APDU carrying a list of BIP44 paths instead of a single one.
+ * The transaction is reviewed once and signed with each path, the response holds one signature per path.
+ */
+#define P2_PATHS 0x10
 /**
  * Parameter 1 for first APDU number.
  */
@@ -19,10 +36,41 @@
  * Parameter 1 for maximum APDU number.
  * First apdu must always be the BIP44 path (P1 chunk 0)
  * Second apdu must always be the network magic, (P1 chunk 1)
- * The maximum APDU length is 255 bytes. Subtracting the 5 bytes header leaves 250 bytes per APDU of actual data.
- * With MAX_TRANSACTION_LEN set to 1024 we should at most need 5 APDU's to transmit the transaction part (P1 chunk 2..6)
+ * The transaction part follows in as many APDUs as needed (P1 chunk 2 and up). It is parsed and hashed as it arrives,
+ * so its length is only bounded by the transaction format itself. A script of 0xFFFF bytes needs more chunks than
+ * P1 can number, hosts must keep using P1_MAX for all chunks beyond it. Chunks sent with P2_OFFSET are located by
+ * their offset instead, whatever their P1.
+ *
+ * A transaction that fits in a single APDU can also be sent in compact mode: P1_START with P2_LAST, where the
+ * command data is the BIP44 path, the network magic and the transaction.
+ */
+#define P1_MAX 0x7F
+
+/**
+ * Parameter 1 of SIGN_TX_BATCH for a chunk of the current transaction of the batch.
+ */
+#define P1_BATCH_TX 0x01
+/**
+ * Parameter 1 of SIGN_TX_BATCH to get the signature of a transaction of an approved batch.
+ */
+#define P1_BATCH_SIGNATURE 0x02
+
+/**
+ * Parameter 1 of SIGN_SESSION to open a session with a BIP44 path and a network magic.
+ */
+#define P1_SESSION_OPEN 0x00
+/**
+ * Parameter 1 of SIGN_SESSION to close the session.
+ */
+#define P1_SESSION_CLOSE 0x01
+/**
+ * Parameter 1 of SIGN_SESSION for the first chunk of a transaction of the session.
+ */
+#define P1_SESSION_TX_START 0x02
+/**
+ * Parameter 1 of SIGN_SESSION for the next chunks of the transaction.
  */
-#define P1_MAX 0x06
+#define P1_SESSION_TX 0x03
 
 /**
  * Dispatch APDU command received to the right handler.
@@ -16,7 +16,7 @@
 
 #include <stddef.h>  // size_t
 #include <stdint.h>  // uint*_t
-#include <string.h>  // memset
+#include <string.h>  // memset, memcpy
 
 #include "base58.h"
 
@@ -151,4 +151,72 @@ int base58_encode(const uint8_t *in, size_t in_len, char *out, size_t out_len) {
     }
 
     return i;
-}
\ No newline at end of file
+}
+
+/**
+ * 58^4: each limb holds 4 base 58 digits, and limb * 256 + 255 still fits in 32 bits.
+ */
+#define BASE58_LIMB_BASE 11316496u
+/**
+ * Number of limbs for 2^200: 35 base 58 digits, rounded up to a multiple of 4.
+ */
+#define BASE58_ADDRESS_LIMBS 9
+
+/**
+ * Exact quotients by reciprocal multiplication, valid on the given input ranges:
+ * there is no hardware divider on the Cortex-M0.
+ */
+#define DIV_LIMB_BASE(x) ((uint32_t) (((uint64_t) (x) * 0x5EE204F5ull) >> 54))  // x < 2^32
+#define DIV_3364(x)      ((uint32_t) (((uint64_t) (x) * 0x137B483ull) >> 36))   // x < 2^24
+#define DIV_58(x)        ((uint32_t) (((uint32_t) (x) * 0x235u) >> 15))         // x < 2^12
+
+int base58_encode_address(const uint8_t in[static BASE58_ADDRESS_INPUT_SIZE], char *out, size_t out_len) {
+    uint32_t limbs[BASE58_ADDRESS_LIMBS] = {0};  // least significant limb first
+    char digits[BASE58_ADDRESS_LIMBS * 4];
+    size_t zero_count = 0;
+
+    while ((zero_count < BASE58_ADDRESS_INPUT_SIZE) && (in[zero_count] == 0)) {
+        ++zero_count;
+    }
+
+    // limbs = limbs * 256 + byte, for each input byte
+    for (size_t i = 0; i < BASE58_ADDRESS_INPUT_SIZE; i++) {
+        uint32_t carry = in[i];
+        for (size_t j = 0; j < BASE58_ADDRESS_LIMBS; j++) {
+            const uint32_t value = limbs[j] * 256 + carry;
+            carry = DIV_LIMB_BASE(value);
+            limbs[j] = value - carry * BASE58_LIMB_BASE;
+        }
+    }
+
+    // split every limb in 4 digits, most significant first
+    for (size_t j = 0; j < BASE58_ADDRESS_LIMBS; j++) {
+        const uint32_t limb = limbs[BASE58_ADDRESS_LIMBS - 1 - j];
+        const uint32_t high = DIV_3364(limb);
+        const uint32_t low = limb - high * 3364;
+        char *const ptr = &digits[4 * j];
+
+        ptr[0] = (char) DIV_58(high);
+        ptr[1] = (char) (high - DIV_58(high) * 58);
+        ptr[2] = (char) DIV_58(low);
+        ptr[3] = (char) (low - DIV_58(low) * 58);
+    }
+
+    size_t j = 0;
+    while (j < sizeof(digits) && digits[j] == 0) {
+        j += 1;
+    }
+
+    if (out_len < zero_count + sizeof(digits) - j) {
+        return -1;
+    }
+
+    memset(out, BASE58_ALPHABET[0], zero_count);
+
+    size_t i = zero_count;
+    while (j < sizeof(digits)) {
+        out[i++] = BASE58_ALPHABET[(uint8_t) digits[j++]];
+    }
+
+    return i;
+}
@@ -12,6 +12,10 @@
  * Maximum length of input when encoding in base 58.
  */
 #define MAX_ENC_INPUT_SIZE 120
+/**
+ * Length of the input of base58_encode_address() (version byte, script hash and checksum).
+ */
+#define BASE58_ADDRESS_INPUT_SIZE 25
 
 /**
  * Decode input string in base 58.
@@ -49,4 +53,22 @@ int base58_decode(const char *in, size_t in_len, uint8_t *out, size_t out_len);
  * @return number of bytes encoded, -1 otherwise.
  *
  */
-int base58_encode(const uint8_t *in, size_t in_len, char *out, size_t out_len);
\ No newline at end of file
+int base58_encode(const uint8_t *in, size_t in_len, char *out, size_t out_len);
+
+/**
+ * Encode a 25-byte address payload in base 58.
+ *
+ * Same output as base58_encode() on BASE58_ADDRESS_INPUT_SIZE bytes, computed
+ * on 32-bit limbs holding 4 base 58 digits each, with fixed loop bounds.
+ *
+ * @param[in]  in
+ *   Pointer to input byte buffer.
+ * @param[out] out
+ *   Pointer to output string buffer.
+ * @param[in]  out_len
+ *   Maximum length to write in output byte buffer.
+ *
+ * @return number of bytes encoded, -1 otherwise.
+ *
+ */
+int base58_encode_address(const uint8_t in[static BASE58_ADDRESS_INPUT_SIZE], char *out, size_t out_len);
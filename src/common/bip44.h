@@ -16,4 +16,16 @@
  * @return false if failed to parse a BIP44 path or any validation fails.
  */
 
-bool buffer_read_and_validate_bip44(buffer_t *in, uint32_t *bip44path_out, uint16_t *status_out);
\ No newline at end of file
+bool buffer_read_and_validate_bip44(buffer_t *in, uint32_t *bip44path_out, uint16_t *status_out);
+
+/**
+ * @brief Parse the account level of a BIP44 path (purpose, coin type and account) from buffer and perform the same
+ * validations as buffer_read_and_validate_bip44 on them
+ *
+ * @param in
+ * @param bip44path_out array where the 3 BIP44 path numbers will be stored
+ * @param status_out a status word indicating the failure reason
+ * @return true if an account level BIP44 path is successfully parsed and passes all validations
+ * @return false if failed to parse the path or any validation fails.
+ */
+bool buffer_read_and_validate_bip44_account(buffer_t *in, uint32_t *bip44path_out, uint16_t *status_out);
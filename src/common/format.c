@@ -21,88 +21,142 @@
 
 #include "format.h"
 
-bool format_i64(char *dst, size_t dst_len, const int64_t value) {
-    char temp[] = "-9223372036854775808";
+/**
+ * "00" to "99": decimal digits are emitted two at a time.
+ */
+static const char DIGIT_PAIRS[200] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/**
+ * High 64 bits of the 128-bit product a * b, from 32x32->64 partial products only.
+ */
+static uint64_t mul_hi_u64(uint64_t a, uint64_t b) {
+    const uint64_t a_lo = (uint32_t) a;
+    const uint64_t a_hi = a >> 32;
+    const uint64_t b_lo = (uint32_t) b;
+    const uint64_t b_hi = b >> 32;
+
+    const uint64_t lo_lo = a_lo * b_lo;
+    const uint64_t hi_lo = a_hi * b_lo;
+    const uint64_t lo_hi = a_lo * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (uint32_t) hi_lo + lo_hi;
+
+    return a_hi * b_hi + (hi_lo >> 32) + (cross >> 32);
+}
 
-    char *ptr = temp;
-    int64_t num = value;
-    int sign = 1;
+/**
+ * Exact value / 10^8 for any 64-bit value, by multiplication with ceil(2^90 / 10^8).
+ */
+static uint64_t div_1e8(uint64_t value) {
+    return mul_hi_u64(value, 0xABCC77118461CEFDull) >> 26;
+}
 
-    if (value < 0) {
-        sign = -1;
+/**
+ * Exact value / 100 and value / 10000 for any 32-bit value.
+ */
+#define DIV_100(x)   ((uint32_t) (((uint64_t) (x) * 0x51EB851Full) >> 37))
+#define DIV_10000(x) ((uint32_t) (((uint64_t) (x) * 0xD1B71759ull) >> 45))
+
+/**
+ * Write 'value' in decimal, right-aligned, ending at 'end' (exclusive).
+ *
+ * The target has no hardware divider: every 64-bit division by 10 would be a
+ * call to the runtime division helper, so the value is split into 8-digit
+ * chunks with reciprocal multiplications and each chunk is emitted with the
+ * two-digit table.
+ *
+ * @return pointer to the most significant digit.
+ */
+static char *format_u64_digits(char *end, uint64_t value) {
+    char *ptr = end;
+
+    while (value >= 100000000ull) {
+        const uint64_t quotient = div_1e8(value);
+        const uint32_t chunk = (uint32_t) (value - quotient * 100000000ull);
+        const uint32_t high = DIV_10000(chunk);
+        const uint32_t low = chunk - high * 10000;
+        const uint32_t high_hundreds = DIV_100(high);
+        const uint32_t low_hundreds = DIV_100(low);
+
+        ptr -= 8;
+        memcpy(ptr, &DIGIT_PAIRS[2 * high_hundreds], 2);
+        memcpy(ptr + 2, &DIGIT_PAIRS[2 * (high - high_hundreds * 100)], 2);
+        memcpy(ptr + 4, &DIGIT_PAIRS[2 * low_hundreds], 2);
+        memcpy(ptr + 6, &DIGIT_PAIRS[2 * (low - low_hundreds * 100)], 2);
+        value = quotient;
     }
 
-    while (num != 0) {
-        *ptr++ = '0' + (num % 10) * sign;
-        num /= 10;
+    uint32_t rest = (uint32_t) value;
+
+    while (rest >= 100) {
+        const uint32_t quotient = DIV_100(rest);
+        ptr -= 2;
+        memcpy(ptr, &DIGIT_PAIRS[2 * (rest - quotient * 100)], 2);
+        rest = quotient;
     }
 
-    if (value < 0) {
-        *ptr++ = '-';
-    } else if (value == 0) {
-        *ptr++ = '0';
+    if (rest >= 10) {
+        ptr -= 2;
+        memcpy(ptr, &DIGIT_PAIRS[2 * rest], 2);
+    } else {
+        *--ptr = (char) ('0' + rest);
     }
 
-    int distance = (ptr - temp) + 1;
+    return ptr;
+}
 
-    if ((int) dst_len < distance) {
-        return false;
+bool format_i64(char *dst, size_t dst_len, const int64_t value) {
+    char temp[] = "-9223372036854775808";
+    char *end = temp + sizeof(temp) - 1;
+
+    // two's complement negation is well-defined on the unsigned type, even for INT64_MIN
+    const uint64_t magnitude = (value < 0) ? -(uint64_t) value : (uint64_t) value;
+    char *ptr = format_u64_digits(end, magnitude);
+
+    if (value < 0) {
+        *--ptr = '-';
     }
 
-    size_t index = 0;
+    const size_t len = end - ptr;
 
-    while (--ptr >= temp) {
-        dst[index++] = *ptr;
+    if (dst_len < len + 1) {
+        return false;
     }
 
-    dst[index] = '\0';
+    memcpy(dst, ptr, len + 1);
 
     return true;
 }
 
 bool format_u64(char *out, size_t outLen, uint64_t in) {
-    uint8_t i = 0;
+    char temp[] = "18446744073709551615";
+    char *end = temp + sizeof(temp) - 1;
+    const char *ptr = format_u64_digits(end, in);
+    const size_t len = end - ptr;
 
-    if (outLen == 0) {
+    if (outLen < len + 1) {
         return false;
     }
-    outLen--;
 
-    while (in > 9) {
-        out[i] = in % 10 + '0';
-        in /= 10;
-        i++;
-        if (i + 1 > outLen) {
-            return false;
-        }
-    }
-    out[i] = in + '0';
-    out[i + 1] = '\0';
-
-    uint8_t j = 0;
-    char tmp;
+    memcpy(out, ptr, len + 1);
 
-    // revert the string
-    while (j < i) {
-        // swap out[j] and out[i]
-        tmp = out[j];
-        out[j] = out[i];
-        out[i] = tmp;
-
-        i--;
-        j++;
-    }
     return true;
 }
 
-bool format_fpu64(char *dst, size_t dst_len, const uint64_t value, uint8_t decimals) {
-    char buffer[21] = {0};
-
-    if (!format_u64(buffer, sizeof(buffer), value)) {
-        return false;
-    }
-
-    size_t digits = strlen(buffer);
+/**
+ * Place the decimal separator in the decimal string 'digits', 'decimals' digits from its end.
+ */
+static bool format_fixed_point(char *dst, size_t dst_len, const char *digits_str, uint8_t decimals) {
+    size_t digits = strlen(digits_str);
 
     if (digits <= decimals) {
         if (dst_len <= 2 + decimals - digits) {
@@ -114,25 +168,99 @@ bool format_fpu64(char *dst, size_t dst_len, const uint64_t value, uint8_t decim
             *dst = '0';
         }
         dst_len -= 2 + decimals - digits;
-        strncpy(dst, buffer, dst_len);
+        strncpy(dst, digits_str, dst_len);
     } else {
         if (dst_len <= digits + 1 + decimals) {
             return false;
         }
 
         const size_t shift = digits - decimals;
-        memcpy(dst, buffer, shift);
+        memcpy(dst, digits_str, shift);
         dst[shift] = '.';
         if (decimals == 0) {
             dst[shift + 1] = '0';
         } else {
-            strncpy(dst + shift + 1, buffer + shift, decimals);
+            strncpy(dst + shift + 1, digits_str + shift, decimals);
+        }
+    }
+
+    return true;
+}
+
+bool format_fpu64(char *dst, size_t dst_len, const uint64_t value, uint8_t decimals) {
+    char buffer[21] = {0};
+
+    if (!format_u64(buffer, sizeof(buffer), value)) {
+        return false;
+    }
+
+    return format_fixed_point(dst, dst_len, buffer, decimals);
+}
+
+/**
+ * Exact value / 10^9 for any value below 10^9 * 2^32, by multiplication with ceil(2^90 / 10^9).
+ */
+static uint32_t div_1e9(uint64_t value) {
+    return (uint32_t) (mul_hi_u64(value, 0x112E0BE826D694B3ull) >> 26);
+}
+
+bool format_u256(char *dst, size_t dst_len, const uint256_t *value) {
+    char temp[UINT256_MAX_DIGITS + 1];
+    char *end = temp + sizeof(temp) - 1;
+    char *ptr = end;
+    uint32_t limbs[UINT256_LIMBS];
+    size_t top = UINT256_LIMBS;
+
+    *end = '\0';
+    memcpy(limbs, value->limbs, sizeof(limbs));
+    while (top > 1 && limbs[top - 1] == 0) {
+        top--;
+    }
+
+    // long division by 10^9, one limb at a time: each remainder is a group of 9 digits
+    while (top > 1 || limbs[0] >= 1000000000u) {
+        uint32_t remainder = 0;
+
+        for (size_t i = top; i-- > 0;) {
+            const uint64_t current = ((uint64_t) remainder << 32) | limbs[i];
+            const uint32_t quotient = div_1e9(current);
+
+            remainder = (uint32_t) (current - (uint64_t) quotient * 1000000000u);
+            limbs[i] = quotient;
+        }
+        if (limbs[top - 1] == 0) {
+            top--;
+        }
+
+        char *group_end = ptr;
+        ptr = format_u64_digits(ptr, remainder);
+        while (ptr > group_end - 9) {
+            *--ptr = '0';
         }
     }
+    ptr = format_u64_digits(ptr, limbs[0]);
+
+    const size_t len = end - ptr;
+
+    if (dst_len < len + 1) {
+        return false;
+    }
+
+    memcpy(dst, ptr, len + 1);
 
     return true;
 }
 
+bool format_fpu256(char *dst, size_t dst_len, const uint256_t *value, uint8_t decimals) {
+    char buffer[UINT256_MAX_DIGITS + 1] = {0};
+
+    if (!format_u256(buffer, sizeof(buffer), value)) {
+        return false;
+    }
+
+    return format_fixed_point(dst, dst_len, buffer, decimals);
+}
+
 int format_hex(const uint8_t *in, size_t in_len, char *out, size_t out_len) {
     if (out_len < 2 * in_len + 1) {
         return -1;
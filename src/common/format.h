@@ -4,6 +4,23 @@
 #include <stdint.h>   // int*_t, uint*_t
 #include <stdbool.h>  // bool
 
+/**
+ * Number of 32-bit limbs of a 256-bit integer.
+ */
+#define UINT256_LIMBS 8
+
+/**
+ * Number of decimal digits of the largest 256-bit integer.
+ */
+#define UINT256_MAX_DIGITS 78
+
+/**
+ * Fixed-width unsigned integer of up to 256 bits (NeoVM PUSHINT128 and PUSHINT256 operands).
+ */
+typedef struct {
+    uint32_t limbs[UINT256_LIMBS];  // least significant first
+} uint256_t;
+
 /**
  * Format 64-bit signed integer as string.
  *
@@ -51,6 +68,38 @@ bool format_u64(char *dst, size_t dst_len, uint64_t value);
  */
 bool format_fpu64(char *dst, size_t dst_len, const uint64_t value, uint8_t decimals);
 
+/**
+ * Format 256-bit unsigned integer as string.
+ *
+ * @param[out] dst
+ *   Pointer to output string.
+ * @param[in]  dst_len
+ *   Length of output string.
+ * @param[in]  value
+ *   256-bit unsigned integer to format.
+ *
+ * @return true if success, false otherwise.
+ *
+ */
+bool format_u256(char *dst, size_t dst_len, const uint256_t *value);
+
+/**
+ * Format 256-bit unsigned integer as string with decimals.
+ *
+ * @param[out] dst
+ *   Pointer to output string.
+ * @param[in]  dst_len
+ *   Length of output string.
+ * @param[in]  value
+ *   256-bit unsigned integer to format.
+ * @param[in]  decimals
+ *   Number of digits after decimal separator.
+ *
+ * @return true if success, false otherwise.
+ *
+ */
+bool format_fpu256(char *dst, size_t dst_len, const uint256_t *value, uint8_t decimals);
+
 /**
  * Format byte buffer to uppercase hexadecimal string.
  *
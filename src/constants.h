@@ -20,11 +20,6 @@
  */
 #define MAX_APPNAME_LEN 64
 
-/**
- * Maximum transaction length (bytes).
- */
-#define MAX_TRANSACTION_LEN 1024
-
 /**
  * Maximum signature length (bytes).
  */
@@ -44,6 +39,17 @@
 /** Length of BIP44 path, in bytes */
 #define BIP44_BYTE_LENGTH (BIP44_PATH_LEN * sizeof(unsigned int))
 
+/**
+ * Maximum number of BIP44 paths signing the same transaction, their signatures must fit in a single response.
+ */
+#define MAX_SIGN_TX_PATHS 3
+
+/** Length of the account level of a BIP44 path: purpose, coin type and account */
+#define BIP44_ACCOUNT_PATH_LEN 3
+
+/** Length of the account level of a BIP44 path, in bytes */
+#define BIP44_ACCOUNT_BYTE_LENGTH (BIP44_ACCOUNT_PATH_LEN * sizeof(unsigned int))
+
 /**
  * Coin type 888 as described in
  * https://github.com/satoshilabs/slips/blob/master/slip-0044.md
@@ -53,6 +59,9 @@
 /** BIP44 purpose 44' */
 #define BIP44_PURPOSE 0x8000002C
 
+/** Upper bound (excluded) of the BIP44 address index */
+#define BIP44_MAX_ADDRESS_INDEX 5000
+
 /** NEO Main network magic */
 #define NETWORK_MAINNET 860833102
 
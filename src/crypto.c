@@ -24,7 +24,10 @@
 #include "globals.h"
 #include "sw.h"
 
-int crypto_derive_private_key(cx_ecfp_private_key_t *private_key, const uint32_t *bip32_path, uint8_t bip32_path_len) {
+int crypto_derive_private_key(cx_ecfp_private_key_t *private_key,
+                              uint8_t *chain_code,
+                              const uint32_t *bip32_path,
+                              uint8_t bip32_path_len) {
     cx_err_t error = CX_OK;
     uint8_t raw_private_key[64] = {0};
 
@@ -33,7 +36,7 @@ int crypto_derive_private_key(cx_ecfp_private_key_t *private_key, const uint32_t
                                                 bip32_path,
                                                 bip32_path_len,
                                                 raw_private_key,
-                                                NULL,
+                                                chain_code,
                                                 NULL,
                                                 0));
 
@@ -68,39 +71,43 @@ end:
     return 0;
 }
 
-int crypto_sign_tx() {
-    size_t sig_len = sizeof(G_context.tx_info.signature);
+int crypto_sign_tx_hash(const uint32_t *bip44_path,
+                        const uint8_t tx_hash[static 32],
+                        uint8_t *signature,
+                        uint8_t *signature_len) {
+    size_t sig_len = MAX_DER_SIG_LEN;
     cx_err_t error = CX_OK;
 
     // derive private key according to BIP44 path
     cx_ecfp_private_key_t private_key = {0};
-    crypto_derive_private_key(&private_key, G_context.bip44_path, BIP44_PATH_LEN);
+    crypto_derive_private_key(&private_key, NULL, bip44_path, BIP44_PATH_LEN);
 
     // The data we need to hash is the network magic (uint32_t) + sha256(signed data portion of TX)
-    // the latter is stored in tx_info.hash
-    memcpy(G_context.tx_info.raw_tx, (void *) &G_context.network_magic, 4);
-    memcpy(G_context.tx_info.raw_tx + 4, G_context.tx_info.hash, 32);
+    uint8_t data[sizeof(G_context.network_magic) + 32];
+    memcpy(data, (void *) &G_context.network_magic, 4);
+    memcpy(data + 4, tx_hash, 32);
 
     // Hash the data before signing
+    uint8_t digest[32];
     cx_sha256_t msg_hash;
     cx_sha256_init(&msg_hash);
     CX_CHECK(cx_hash_no_throw((cx_hash_t *) &msg_hash,
                               CX_LAST /*mode*/,
-                              G_context.tx_info.raw_tx /* data in */,
-                              sizeof(G_context.network_magic) + sizeof(G_context.tx_info.hash) /* data in len */,
-                              G_context.tx_info.hash /* hash out*/,
-                              sizeof(G_context.tx_info.hash) /* hash out len */));
+                              data /* data in */,
+                              sizeof(data) /* data in len */,
+                              digest /* hash out*/,
+                              sizeof(digest) /* hash out len */));
 
     CX_CHECK(cx_ecdsa_sign_no_throw(&private_key,
                                     CX_RND_RFC6979 | CX_LAST,
                                     CX_SHA256,
-                                    G_context.tx_info.hash,
-                                    sizeof(G_context.tx_info.hash),
-                                    G_context.tx_info.signature,
+                                    digest,
+                                    sizeof(digest),
+                                    signature,
                                     &sig_len,
                                     NULL));
     PRINTF("Private key:%.*H\n", 32, private_key.d);
-    PRINTF("Signature: %.*H\n", sig_len, G_context.tx_info.signature);
+    PRINTF("Signature: %.*H\n", sig_len, signature);
 
 end:
     explicit_bzero(&private_key, sizeof(cx_ecfp_256_private_key_t));
@@ -109,7 +116,14 @@ end:
         return -1;
     }
 
-    G_context.tx_info.signature_len = sig_len;
+    *signature_len = sig_len;
 
     return 0;
 }
+
+int crypto_sign_tx() {
+    return crypto_sign_tx_hash(G_context.bip44_path,
+                               G_context.tx_info.hash,
+                               G_context.tx_info.signature,
+                               &G_context.tx_info.signature_len);
+}
@@ -10,6 +10,8 @@
  *
  * @param[out] private_key
  *   Pointer to private key.
+ * @param[out] chain_code
+ *   Pointer to 32 bytes buffer for the chain code, or NULL if not needed.
  * @param[in]  bip32_path
  *   Pointer to buffer with BIP32 path.
  * @param[in]  bip32_path_len
@@ -20,7 +22,10 @@
  * @throw INVALID_PARAMETER
  *
  */
-int crypto_derive_private_key(cx_ecfp_private_key_t *private_key, const uint32_t *bip32_path, uint8_t bip32_path_len);
+int crypto_derive_private_key(cx_ecfp_private_key_t *private_key,
+                              uint8_t *chain_code,
+                              const uint32_t *bip32_path,
+                              uint8_t bip32_path_len);
 
 /**
  * Initialize public key given private key.
@@ -41,6 +46,30 @@ int crypto_init_public_key(cx_ecfp_private_key_t *private_key,
                            cx_ecfp_public_key_t *public_key,
                            uint8_t raw_public_key[static 64]);
 
+/**
+ * Sign network magic + the hash of a transaction with a BIP44 path.
+ *
+ * @see G_context.network_magic
+ *
+ * @param[in]  bip44_path
+ *   BIP44 path of BIP44_PATH_LEN levels.
+ * @param[in]  tx_hash
+ *   Hash of the signed part of the transaction.
+ * @param[out] signature
+ *   Pointer to buffer of MAX_DER_SIG_LEN bytes for the signature encoded in ASN1.DER.
+ * @param[out] signature_len
+ *   Length of the signature.
+ *
+ * @return 0 if success, -1 otherwise.
+ *
+ * @throw INVALID_PARAMETER
+ *
+ */
+int crypto_sign_tx_hash(const uint32_t *bip44_path,
+                        const uint8_t tx_hash[static 32],
+                        uint8_t *signature,
+                        uint8_t *signature_len);
+
 /**
  * Sign network magic + message hash in global context.
  *
@@ -0,0 +1,57 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *   (c) 2021 COZ Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <string.h>   // explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+
+#include "get_account_xpub.h"
+#include "constants.h"
+#include "io.h"
+#include "sw.h"
+#include "crypto.h"
+#include "common/buffer.h"
+#include "common/bip44.h"
+#include "ui/utils.h"
+
+int handler_get_account_xpub(buffer_t *cdata) {
+    uint32_t bip44_path[BIP44_ACCOUNT_PATH_LEN];
+
+    uint16_t status;
+    if (!buffer_read_and_validate_bip44_account(cdata, bip44_path, &status)) return io_send_sw(status);
+
+    cx_ecfp_private_key_t private_key = {0};
+    cx_ecfp_public_key_t public_key = {0};
+    uint8_t raw_public_key[64];
+    uint8_t resp[COMPRESSED_PUBKEY_LEN + CHAIN_CODE_LEN];
+
+    // Derive the account private key and chain code, m/44'/888'/account'
+    crypto_derive_private_key(&private_key, resp + COMPRESSED_PUBKEY_LEN, bip44_path, BIP44_ACCOUNT_PATH_LEN);
+    // Generate corresponding public key
+    crypto_init_public_key(&private_key, &public_key, raw_public_key);
+    // Clear private key
+    explicit_bzero(&private_key, sizeof(private_key));
+
+    compress_public_key(raw_public_key, resp);
+
+    return io_send_response(&(const buffer_t){.ptr = resp, .size = sizeof(resp), .offset = 0}, SW_OK);
+}
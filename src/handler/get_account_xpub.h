@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>   // size_t
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "common/buffer.h"
+
+/**
+ * Length of a BIP32 chain code.
+ */
+#define CHAIN_CODE_LEN 32
+
+/**
+ * Handler for GET_ACCOUNT_XPUB command. If the account level BIP44 path (m/44'/888'/account') is parsed
+ * successfully, send the compressed public key and chain code of the account in the APDU response.
+ * Change and address keys are non-hardened children of it, the host can derive them without the device.
+ *
+ * @param[in,out] cdata
+ *   Command data with account level BIP44 path.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_account_xpub(buffer_t *cdata);
@@ -35,10 +35,11 @@
 #include "helper/send_response.h"
 #include "ui_get_public_key.h"
 
-int handler_get_public_key(buffer_t *cdata, bool show_on_screen) {
+int handler_get_public_key(buffer_t *cdata, pubkey_format_e format, bool show_on_screen) {
     explicit_bzero(&G_context, sizeof(G_context));
     G_context.req_type = CONFIRM_ADDRESS;
     G_context.state = STATE_NONE;
+    G_context.pk_format = format;
 
     uint16_t status;
     if (!buffer_read_and_validate_bip44(cdata, G_context.bip44_path, &status)) return io_send_sw(status);
@@ -47,7 +48,7 @@ int handler_get_public_key(buffer_t *cdata, bool show_on_screen) {
     cx_ecfp_public_key_t public_key = {0};
 
     // Derive private key according to BIP44 path
-    crypto_derive_private_key(&private_key, G_context.bip44_path, BIP44_PATH_LEN);
+    crypto_derive_private_key(&private_key, NULL, G_context.bip44_path, BIP44_PATH_LEN);
     // Generate corresponding public key
     crypto_init_public_key(&private_key, &public_key, G_context.raw_public_key);
     // Clear private key
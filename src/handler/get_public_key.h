@@ -11,14 +11,16 @@
  * Handler for GET_PUBLIC_KEY command. If the BIP44 path is parsed successfully
  * derive the public key and send APDU response.
  *
- * @see G_context.bip44_path and G_context.raw_public_key
+ * @see G_context.bip44_path, G_context.raw_public_key and G_context.pk_format
  *
  * @param[in,out] cdata
  *   Command data with BIP44 path.
+ * @param[in]     format
+ *   Format of the public key in the response.
  * @param[in]     show_on_screen
  *   Whether to display address on screen or not.
  *
  * @return zero or positive integer if success, negative integer otherwise.
  *
  */
-int handler_get_public_key(buffer_t *cdata, bool show_on_screen);
+int handler_get_public_key(buffer_t *cdata, pubkey_format_e format, bool show_on_screen);
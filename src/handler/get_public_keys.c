@@ -0,0 +1,80 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *   (c) 2021 COZ Inc.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <string.h>   // explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+
+#include "get_public_keys.h"
+#include "constants.h"
+#include "types.h"
+#include "io.h"
+#include "sw.h"
+#include "crypto.h"
+#include "common/buffer.h"
+#include "common/bip44.h"
+#include "ui/utils.h"
+
+int handler_get_public_keys(buffer_t *cdata, pubkey_format_e format) {
+    uint32_t bip44_path[BIP44_PATH_LEN];
+    uint8_t count;
+
+    uint16_t status;
+    if (!buffer_read_and_validate_bip44(cdata, bip44_path, &status)) return io_send_sw(status);
+
+    size_t item_len = (format == PUBKEY_FORMAT_COMPRESSED) ? COMPRESSED_PUBKEY_LEN : UINT160_LEN;
+    if (!buffer_read_u8(cdata, &count) || count == 0 || count * item_len > MAX_PUBLIC_KEYS_RESPONSE_LEN) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+
+    // the last address index must pass the same validation as the first one
+    if (bip44_path[4] + count > BIP44_MAX_ADDRESS_INDEX) {
+        return io_send_sw(SW_BIP44_BAD_ADDRESS);
+    }
+
+    uint8_t resp[MAX_PUBLIC_KEYS_RESPONSE_LEN];
+    size_t offset = 0;
+
+    for (uint8_t i = 0; i < count; i++) {
+        cx_ecfp_private_key_t private_key = {0};
+        cx_ecfp_public_key_t public_key = {0};
+        uint8_t raw_public_key[64];
+
+        // Derive private key according to BIP44 path
+        crypto_derive_private_key(&private_key, NULL, bip44_path, BIP44_PATH_LEN);
+        // Generate corresponding public key
+        crypto_init_public_key(&private_key, &public_key, raw_public_key);
+        // Clear private key
+        explicit_bzero(&private_key, sizeof(private_key));
+
+        if (format == PUBKEY_FORMAT_COMPRESSED) {
+            compress_public_key(raw_public_key, resp + offset);
+        } else if (!script_hash_from_pubkey(raw_public_key, resp + offset)) {
+            return io_send_sw(SW_CONVERT_TO_ADDRESS_FAIL);
+        }
+        offset += item_len;
+
+        bip44_path[4]++;
+    }
+
+    return io_send_response(&(const buffer_t){.ptr = resp, .size = offset, .offset = 0}, SW_OK);
+}
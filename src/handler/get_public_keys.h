@@ -0,0 +1,27 @@
+#pragma once
+
+#include <stddef.h>   // size_t
+#include <stdbool.h>  // bool
+#include <stdint.h>   // uint*_t
+
+#include "types.h"
+#include "common/buffer.h"
+
+/**
+ * Maximum length of the packed public keys or script hashes in a GET_PUBLIC_KEYS response.
+ */
+#define MAX_PUBLIC_KEYS_RESPONSE_LEN 255
+
+/**
+ * Handler for GET_PUBLIC_KEYS command. Derive the public keys of 'count' consecutive address indexes, starting at
+ * the BIP44 path, and send them packed in the APDU response without user confirmation.
+ *
+ * @param[in,out] cdata
+ *   Command data with BIP44 path of the first address and the number of addresses (1 byte).
+ * @param[in]     format
+ *   Either PUBKEY_FORMAT_COMPRESSED (33 bytes per key) or PUBKEY_FORMAT_SCRIPT_HASH (20 bytes per key).
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_get_public_keys(buffer_t *cdata, pubkey_format_e format);
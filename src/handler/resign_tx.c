@@ -0,0 +1,116 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+
+#include "os.h"
+#include "cx.h"
+
+#include "resign_tx.h"
+#include "sign_tx_common.h"
+#include "sw.h"
+#include "globals.h"
+#include "common/buffer.h"
+#include "common/read.h"
+#include "transaction/transaction_types.h"
+
+#ifdef HAVE_RESIGN_TX
+
+_Static_assert(sizeof(batch_ctx_t) <= MAX_RESIGN_TAIL_LEN, "The batch must fit in the memory of the tail!");
+
+/**
+ * Offset in the command data of a header field: the command data is the header, from the nonce on.
+ */
+#define CDATA_OFFSET(tx_offset) ((tx_offset) - TX_OFFSET_NONCE)
+
+/**
+ * Hash the transaction again: its version, the new header fields, then the bytes kept after the header.
+ */
+static void hash_tx(const uint8_t *header_fields) {
+    const uint8_t version = G_context.tx_info.transaction.version;
+
+    cx_sha256_init(&G_context.tx_info.hash_ctx);
+    CX_ASSERT(cx_hash_no_throw((cx_hash_t *) &G_context.tx_info.hash_ctx, 0, &version, 1, NULL, 0));
+    CX_ASSERT(cx_hash_no_throw((cx_hash_t *) &G_context.tx_info.hash_ctx,
+                               0,
+                               header_fields,
+                               CDATA_OFFSET(TX_HEADER_LEN),
+                               NULL,
+                               0));
+    CX_ASSERT(cx_hash_no_throw((cx_hash_t *) &G_context.tx_info.hash_ctx,
+                               CX_LAST,
+                               G_context.tx_info.tail,
+                               G_context.tx_info.received - TX_HEADER_LEN,
+                               G_context.tx_info.hash,
+                               sizeof(G_context.tx_info.hash)));
+}
+
+int handler_resign_tx(buffer_t *cdata) {
+    transaction_t *tx = &G_context.tx_info.transaction;
+
+    // only a transaction the user approved, whose bytes after the header were all kept
+    if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_APPROVED ||
+        G_context.tx_info.received - TX_HEADER_LEN > sizeof(G_context.tx_info.tail)) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+    if (cdata->size - cdata->offset != CDATA_OFFSET(TX_HEADER_LEN)) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+
+    const uint8_t *header_fields = cdata->ptr + cdata->offset;
+    const uint32_t nonce = read_u32_le(header_fields, CDATA_OFFSET(TX_OFFSET_NONCE));
+    const int64_t system_fee = read_s64_le(header_fields, CDATA_OFFSET(TX_OFFSET_SYSTEM_FEE));
+    const int64_t network_fee = read_s64_le(header_fields, CDATA_OFFSET(TX_OFFSET_NETWORK_FEE));
+    const uint32_t valid_until_block = read_u32_le(header_fields, CDATA_OFFSET(TX_OFFSET_VALID_UNTIL_BLOCK));
+
+    // same checks as the parser
+    if (system_fee < 0 || network_fee < 0) {
+        char status_char[1] = {(uint8_t) ((system_fee < 0) ? SYSTEM_FEE_VALUE_ERROR : NETWORK_FEE_VALUE_ERROR)};
+        return io_send_response(&(const buffer_t){.ptr = (unsigned char *) status_char, .size = 1, .offset = 0},
+                                SW_TX_PARSING_FAIL);
+    }
+
+    uint8_t changes = 0;
+    if (nonce != tx->nonce) {
+        changes |= RESIGN_FIELD_NONCE;
+    }
+    if (system_fee != tx->system_fee) {
+        changes |= RESIGN_FIELD_SYSTEM_FEE;
+    }
+    if (network_fee != tx->network_fee) {
+        changes |= RESIGN_FIELD_NETWORK_FEE;
+    }
+    if (valid_until_block != tx->valid_until_block) {
+        changes |= RESIGN_FIELD_VALID_UNTIL_BLOCK;
+    }
+
+    tx->nonce = nonce;
+    tx->system_fee = system_fee;
+    tx->network_fee = network_fee;
+    tx->valid_until_block = valid_until_block;
+    hash_tx(header_fields);
+
+    PRINTF("Hash: %.*H\n", sizeof(G_context.tx_info.hash), G_context.tx_info.hash);
+
+    G_context.tx_info.resign_changes = changes;
+    G_context.state = STATE_PARSED;
+    return start_resign_tx();
+}
+
+#endif  // HAVE_RESIGN_TX
@@ -0,0 +1,24 @@
+#pragma once
+
+#include "common/buffer.h"
+
+/**
+ * Handler for RESIGN_TX command. The last transaction approved with SIGN_TX is signed again with a new nonce, new
+ * fees and a new validity: the rest of the transaction is unchanged. The review shows its vote or transfers, the
+ * changed fields, and warns that the transaction signed before stays valid. It is shown even if no field changed.
+ *
+ * The transaction must have been fully kept, see MAX_RESIGN_TAIL_LEN. It is hashed again from its version, the new
+ * header fields and the kept bytes. The response is the same as for SIGN_TX, with the same BIP44 paths.
+ *
+ * Only built with HAVE_RESIGN_TX, which is not set on Nano S: the instruction is not supported there.
+ *
+ * @see G_context.tx_info.tail, G_context.tx_info.resign_changes.
+ *
+ * @param[in,out] cdata
+ *   Command data with the new nonce (4), system fee (8), network fee (8) and valid until block (4), little endian as
+ *   in the transaction.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_resign_tx(buffer_t *cdata);
@@ -0,0 +1,79 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <string.h>   // explicit_bzero
+
+#include "sign_session.h"
+#include "sign_tx.h"
+#include "sw.h"
+#include "io.h"
+#include "constants.h"
+#include "apdu/dispatcher.h"
+#include "common/buffer.h"
+#include "common/bip44.h"
+
+static struct {
+    bool open;
+    uint32_t bip44_path[BIP44_PATH_LEN];
+    uint32_t network_magic;
+} session;
+
+void sign_session_close(void) {
+    explicit_bzero(&session, sizeof(session));
+}
+
+/**
+ * Open a session with the BIP44 path and the network magic, in place of the current one if any.
+ */
+static int open_session(buffer_t *cdata) {
+    uint16_t status;
+
+    sign_session_close();
+    if (!buffer_read_and_validate_bip44(cdata, session.bip44_path, &status)) {
+        sign_session_close();
+        return io_send_sw(status);
+    }
+    if (!buffer_read_u32(cdata, &session.network_magic, LE) || cdata->offset != cdata->size) {
+        sign_session_close();
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+
+    session.open = true;
+    return io_send_sw(SW_OK);
+}
+
+int handler_sign_session(buffer_t *cdata, uint8_t p1, bool more, bool compressed) {
+    switch (p1) {
+        case P1_SESSION_OPEN:
+            return open_session(cdata);
+        case P1_SESSION_CLOSE:
+            sign_session_close();
+            return io_send_sw(SW_OK);
+        default:
+            if (!session.open) {
+                return io_send_sw(SW_BAD_STATE);
+            }
+            return handler_sign_tx_in_session(cdata,
+                                              session.bip44_path,
+                                              session.network_magic,
+                                              p1 == P1_SESSION_TX_START,
+                                              more,
+                                              compressed);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+
+#include "common/buffer.h"
+
+/**
+ * Handler for SIGN_SESSION command. A signing session holds a BIP44 path and a network magic until it is closed or
+ * the app exits: the transactions signed in the session are sent without them, chunk after chunk.
+ *
+ * P1_SESSION_OPEN takes the BIP44 path and the network magic, P1_SESSION_CLOSE forgets them. Each transaction
+ * starts with a P1_SESSION_TX_START chunk, followed by P1_SESSION_TX chunks, and is then reviewed and signed as with
+ * SIGN_TX. The session is kept out of G_context, which every other command resets.
+ *
+ * @param[in,out] cdata
+ *   Command data.
+ * @param[in]     p1
+ *   P1_SESSION_OPEN, P1_SESSION_CLOSE, P1_SESSION_TX_START or P1_SESSION_TX.
+ * @param[in]     more
+ *   Whether more chunks of the transaction are expected to be received or not.
+ * @param[in]     compressed
+ *   Whether the transaction is sent in the compressed encoding, see transaction/expander.h.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_sign_session(buffer_t *cdata, uint8_t p1, bool more, bool compressed);
+
+/**
+ * Close the signing session, if any, when the app exits.
+ */
+void sign_session_close(void);
@@ -18,22 +18,159 @@
 #include <stdint.h>   // uint*_t
 #include <stdbool.h>  // bool
 #include <stddef.h>   // size_t
-#include <string.h>   // memset, explicit_bzero
+#include <string.h>   // memcpy, explicit_bzero
 
 #include "os.h"
 #include "cx.h"
 
 #include "sign_tx.h"
+#include "tx_stream.h"
 #include "sign_tx_common.h"
 #include "sw.h"
 #include "globals.h"
 #include "crypto.h"
+#include "sign_cache.h"
+#include "menu.h"
+#include "shared_context.h"
 #include "common/buffer.h"
 #include "common/bip44.h"
 #include "transaction/transaction_types.h"
 #include "transaction/deserialize.h"
 
-int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
+/**
+ * Script bytes still to be received from which the review starts before the end of the transaction: at least two
+ * more APDUs, smaller transactions are reviewed once complete.
+ */
+#define STREAM_REVIEW_MIN_PENDING_LEN 510
+
+/**
+ * Read the list of BIP44 paths signing the transaction: their number, then each path. The first one goes to
+ * G_context.bip44_path, as a single path does.
+ */
+static bool read_bip44_paths(buffer_t *cdata, uint16_t *status) {
+    uint8_t count;
+
+    if (!buffer_read_u8(cdata, &count) || count == 0 || count > MAX_SIGN_TX_PATHS ||
+        !buffer_can_read(cdata, count * BIP44_BYTE_LENGTH)) {
+        *status = SW_WRONG_DATA_LENGTH;
+        return false;
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t *path = (i == 0) ? G_context.bip44_path : G_context.other_bip44_paths[i - 1];
+
+        if (!buffer_read_and_validate_bip44(cdata, path, status)) {
+            return false;
+        }
+    }
+    G_context.bip44_paths_size = count;
+    return true;
+}
+
+/**
+ * Get ready to receive the transaction, once the BIP44 path and the network magic are known.
+ */
+static void start_tx(bool compressed) {
+    tx_stream_start(compressed);
+    G_context.state = STATE_MAGIC_OK;
+}
+
+/**
+ * Read the network magic and get ready to receive the transaction.
+ */
+static bool read_network_magic(buffer_t *cdata, bool compressed) {
+    if (!buffer_read_u32(cdata, &G_context.network_magic, LE)) {
+        return false;
+    }
+
+    start_tx(compressed);
+    return true;
+}
+
+/**
+ * Signatures of a transaction approved earlier in this session, for each BIP44 path of the request and in the format
+ * of the approval response. A transaction is sent again when that response was lost, it is not reviewed twice.
+ *
+ * @return the length of the response, 0 if a signature is missing.
+ */
+static size_t get_cached_signatures(uint8_t *resp) {
+    const uint8_t paths_size = (G_context.bip44_paths_size > 0) ? G_context.bip44_paths_size : 1;
+    size_t offset = 0;
+
+    for (uint8_t i = 0; i < paths_size; i++) {
+        const uint32_t *path = (i == 0) ? G_context.bip44_path : G_context.other_bip44_paths[i - 1];
+        const sign_cache_entry_t *entry = sign_cache_find(G_context.network_magic, G_context.tx_info.hash, path);
+
+        if (entry == NULL) {
+            return 0;
+        }
+        if (G_context.bip44_paths_size > 0) {
+            resp[offset++] = entry->signature_len;
+        }
+        memcpy(resp + offset, entry->signature, entry->signature_len);
+        offset += entry->signature_len;
+    }
+    return offset;
+}
+
+/**
+ * Hash and parse a part of the transaction, start the review once the last part is received.
+ */
+static int receive_tx_chunk(buffer_t *cdata, bool more, bool with_offset) {
+    if (G_context.review_stream == REVIEW_STREAM_REJECTED) {
+        // the review was rejected before this part of the transaction was received
+        G_context.state = STATE_NONE;
+        G_context.review_stream = REVIEW_STREAM_NONE;
+        return io_send_sw(SW_DENY);
+    }
+
+    parser_status_e status = tx_stream_receive(cdata, more);
+    PRINTF("Parsing status: %d.\n", status);
+    if (status != PARSING_OK) {
+        G_context.state = STATE_NONE;
+        if (G_context.review_stream != REVIEW_STREAM_NONE) {
+            G_context.review_stream = REVIEW_STREAM_NONE;
+            abort_sign_tx_stream_ui();
+        }
+        return tx_stream_send_parsing_status(status);
+    }
+
+    if (more) {  // APDU with another transaction part
+        // Header and signers can be reviewed while a long script is received. The scripts needing that are arbitrary
+        // ones most of the time, so this is only done when they are allowed: they are refused once complete otherwise.
+        if (G_context.review_stream == REVIEW_STREAM_NONE && N_storage.scriptsAllowed &&
+            transaction_script_pending(&G_context.tx_info.parser, &G_context.tx_info.transaction) >=
+                STREAM_REVIEW_MIN_PENDING_LEN) {
+            start_sign_tx_stream();
+        }
+        return with_offset ? tx_stream_send_received_length(SW_OK) : io_send_sw(SW_OK);
+    }
+
+    // Last APDU, the hash is final: let's review and sign
+    uint8_t resp[MAX_SIGN_TX_PATHS * (1 + MAX_DER_SIG_LEN)];
+    size_t resp_len = get_cached_signatures(resp);
+    if (resp_len > 0) {
+        if (G_context.review_stream != REVIEW_STREAM_NONE) {
+            // already approved, the review started with this upload has no purpose
+            G_context.review_stream = REVIEW_STREAM_NONE;
+            ui_menu_main();
+        }
+        G_context.state = STATE_APPROVED;
+        return io_send_response(&(const buffer_t){.ptr = resp, .size = resp_len, .offset = 0}, SW_OK);
+    }
+
+    G_context.state = STATE_PARSED;
+
+    if (G_context.review_stream != REVIEW_STREAM_NONE) {
+        return finish_sign_tx_stream();
+    }
+    return start_sign_tx();
+}
+
+int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more, bool with_offset, bool compressed, bool with_paths) {
+    if ((with_offset && (chunk < 2 || compressed)) || (compressed && chunk == 0 && more) ||
+        (with_paths && chunk != 0)) {
+        return io_send_sw(SW_WRONG_P1P2);
+    }
 
     if (chunk == 0) {  // First APDU, parse BIP44 path
         explicit_bzero(&G_context, sizeof(G_context));
@@ -41,81 +178,72 @@ int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more) {
         G_context.state = STATE_NONE;
 
         uint16_t status;
-        if (!buffer_read_and_validate_bip44(cdata, G_context.bip44_path, &status)) {
+        if (with_paths ? !read_bip44_paths(cdata, &status)
+                       : !buffer_read_and_validate_bip44(cdata, G_context.bip44_path, &status)) {
             return io_send_sw(status);
         }
 
         G_context.state = STATE_BIP44_OK;
-        return io_send_sw(SW_OK);
+        if (more) {
+            return io_send_sw(SW_OK);
+        }
+
+        // Compact mode, the network magic and the whole transaction follow the BIP44 path in this APDU
+        if (!read_network_magic(cdata, compressed)) {
+            G_context.state = STATE_NONE;
+            return io_send_sw(SW_MAGIC_PARSING_FAIL);
+        }
+
+        return receive_tx_chunk(cdata, false, false);
     } else if (chunk == 1) {
-        if (G_context.req_type != CONFIRM_TRANSACTION && G_context.state != STATE_BIP44_OK) {
+        if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_BIP44_OK) {
             return io_send_sw(SW_BAD_STATE);
         }
 
-        if (!buffer_read_u32(cdata, &G_context.network_magic, LE)) {
+        if (!read_network_magic(cdata, compressed)) {
             return io_send_sw(SW_MAGIC_PARSING_FAIL);
         }
-        G_context.state = STATE_MAGIC_OK;
+
         return io_send_sw(SW_OK);
     } else {  // Receive transaction
-        if (G_context.req_type != CONFIRM_TRANSACTION && G_context.state != STATE_MAGIC_OK) {
+        if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_MAGIC_OK || G_context.in_session) {
             return io_send_sw(SW_BAD_STATE);
         }
+        if (compressed != G_context.tx_info.compressed) {
+            // the encoding is selected with the network magic
+            return io_send_sw(SW_WRONG_P1P2);
+        }
 
-        if (more) {  // APDU with another transaction part
-            if (G_context.tx_info.raw_tx_len + cdata->size > MAX_TRANSACTION_LEN ||
-                !buffer_move(cdata, G_context.tx_info.raw_tx + G_context.tx_info.raw_tx_len, cdata->size)) {
-                return io_send_sw(SW_WRONG_TX_LENGTH);
-            }
-
-            G_context.tx_info.raw_tx_len += cdata->size;
+        if (with_offset) {
+            return tx_stream_receive_at_offset(cdata, more, receive_tx_chunk);
+        }
+        return receive_tx_chunk(cdata, more, false);
+    }
+}
 
-            return io_send_sw(SW_OK);
-        } else {  // Last APDU, let's parse and sign
-            if (G_context.tx_info.raw_tx_len + cdata->size > MAX_TRANSACTION_LEN ||
-                !buffer_move(cdata, G_context.tx_info.raw_tx + G_context.tx_info.raw_tx_len, cdata->size)) {
-                return io_send_sw(SW_WRONG_TX_LENGTH);
-            }
-
-            G_context.tx_info.raw_tx_len += cdata->size;
-
-            buffer_t buf = {.ptr = G_context.tx_info.raw_tx, .size = G_context.tx_info.raw_tx_len, .offset = 0};
-
-            parser_status_e status = transaction_deserialize(&buf, &G_context.tx_info.transaction);
-            PRINTF("Parsing status: %d.\n", status);
-            if (status != PARSING_OK) {
-                char status_char[1] = {(uint8_t) status};
-                return io_send_response(&(const buffer_t){.ptr = (unsigned char *) status_char, .size = 1, .offset = 0},
-                                        SW_TX_PARSING_FAIL);
-            }
-
-            G_context.state = STATE_PARSED;
-
-            /**
-             * Here we hash the signed part of the transaction. This is _not_ the final hash used as input for ecdsa
-             * (see crypto_sign_tx()) The final hash is: sha256(network magic + sha256(signed part of tx data)), but we
-             * don't hash this until we've approved among others the network magic
-             */
-
-            cx_sha256_t tx_hash;
-            cx_sha256_init(&tx_hash);
-            CX_ASSERT(cx_hash_no_throw((cx_hash_t *) &tx_hash,
-                             CX_LAST /*mode*/,
-                             G_context.tx_info.raw_tx /* data in */,
-                             G_context.tx_info.raw_tx_len /* data in len */,
-                             G_context.tx_info.hash /* hash out*/,
-                             sizeof(G_context.tx_info.hash) /* hash out len */));
-
-            PRINTF("Hash: %.*H\n", sizeof(G_context.tx_info.hash), G_context.tx_info.hash);
-
-            if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_PARSED) {
-                G_context.state = STATE_NONE;
-                return io_send_sw(SW_BAD_STATE);
-            }
-
-            return start_sign_tx();
+int handler_sign_tx_in_session(buffer_t *cdata,
+                               const uint32_t *bip44_path,
+                               uint32_t network_magic,
+                               bool first,
+                               bool more,
+                               bool compressed) {
+    if (first) {
+        // the BIP44 path and the network magic of the session stand for the first two APDUs of SIGN_TX
+        explicit_bzero(&G_context, sizeof(G_context));
+        G_context.req_type = CONFIRM_TRANSACTION;
+        G_context.in_session = true;
+        memcpy(G_context.bip44_path, bip44_path, sizeof(G_context.bip44_path));
+        G_context.network_magic = network_magic;
+        start_tx(compressed);
+    } else {
+        if (G_context.req_type != CONFIRM_TRANSACTION || G_context.state != STATE_MAGIC_OK || !G_context.in_session) {
+            return io_send_sw(SW_BAD_STATE);
+        }
+        if (compressed != G_context.tx_info.compressed) {
+            // the encoding is selected with the first chunk
+            return io_send_sw(SW_WRONG_P1P2);
         }
     }
 
-    return 0;
+    return receive_tx_chunk(cdata, more, false);
 }
@@ -9,7 +9,12 @@
  * Handler for SIGN_TX command. If the BIP44 path is parsed successfully
  * sign the transaction and send the signature in the APDU response.
  *
- * @see G_context.bip44_path, G_context.tx_info.raw_transaction,
+ * The transaction part is parsed and hashed chunk by chunk as it is received. Chunks sent with their offset are
+ * acknowledged with the number of transaction bytes received so far, an upload can resume from there. A compressed
+ * transaction is expanded on the fly, the hash and the parser only see the expanded bytes. The first APDU may carry a
+ * list of BIP44 paths, the transaction is then reviewed once and signed with each one of them.
+ *
+ * @see G_context.bip44_path, G_context.tx_info.transaction,
  * G_context.tx_info.signature.
  *
  * @param[in,out] cdata
@@ -18,8 +23,43 @@
  *   Index number of the APDU chunk.
  * @param[in]       more
  *   Whether more chunks are expected to be received or not.
+ * @param[in]       with_offset
+ *   Whether the transaction chunk starts with its offset in the transaction (4 bytes, big endian).
+ * @param[in]       compressed
+ *   Whether the transaction is sent in the compressed encoding, see transaction/expander.h.
+ * @param[in]       with_paths
+ *   Whether the first APDU carries a list of BIP44 paths: their number (1 byte) followed by each path.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more, bool with_offset, bool compressed, bool with_paths);
+
+/**
+ * Receive a transaction of a signing session, see handler_sign_session(): the BIP44 path and the network magic are
+ * the ones of the session, only the transaction chunks are sent. They are then handled as by handler_sign_tx().
+ * A transaction is continued by the instruction which started it: SIGN_TX can't send the chunks of a transaction of
+ * the session, nor the session those of a SIGN_TX transaction.
+ *
+ * @param[in,out] cdata
+ *   Command data with the next part of the raw transaction serialized.
+ * @param[in]     bip44_path
+ *   BIP44 path of the session, BIP44_PATH_LEN levels.
+ * @param[in]     network_magic
+ *   Network magic of the session.
+ * @param[in]     first
+ *   Whether this is the first chunk of a new transaction.
+ * @param[in]     more
+ *   Whether more chunks of the transaction are expected to be received or not.
+ * @param[in]     compressed
+ *   Whether the transaction is sent in the compressed encoding, see transaction/expander.h.
  *
  * @return zero or positive integer if success, negative integer otherwise.
  *
  */
-int handler_sign_tx(buffer_t *cdata, uint8_t chunk, bool more);
+int handler_sign_tx_in_session(buffer_t *cdata,
+                               const uint32_t *bip44_path,
+                               uint32_t network_magic,
+                               bool first,
+                               bool more,
+                               bool compressed);
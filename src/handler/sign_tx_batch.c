@@ -0,0 +1,219 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy, memcmp, explicit_bzero
+
+#include "os.h"
+#include "cx.h"
+
+#include "sign_tx_batch.h"
+#include "tx_stream.h"
+#include "sign_tx_common.h"
+#include "sw.h"
+#include "globals.h"
+#include "crypto.h"
+#include "apdu/dispatcher.h"
+#include "common/buffer.h"
+#include "common/bip44.h"
+#include "transaction/transaction_types.h"
+#include "transaction/tx_utils.h"
+
+/**
+ * Index of the token in the batch, added if it is not there yet. MAX_TRANSFER_TOKENS if there is no room left.
+ */
+static uint8_t find_or_add_token(const uint8_t *script_hash) {
+    batch_ctx_t *batch = &G_context.tx_info.batch;
+
+    for (uint8_t i = 0; i < batch->tokens_size; i++) {
+        if (memcmp(batch->tokens[i], script_hash, UINT160_LEN) == 0) {
+            return i;
+        }
+    }
+    if (batch->tokens_size == MAX_TRANSFER_TOKENS) {
+        return MAX_TRANSFER_TOKENS;
+    }
+    memcpy(batch->tokens[batch->tokens_size], script_hash, UINT160_LEN);
+    return batch->tokens_size++;
+}
+
+/**
+ * Whether the signers of the transaction are the single signer of the batch, limited to the entry script: the review
+ * shows that account once for all transactions.
+ */
+static bool check_batch_signer(const transaction_t *tx) {
+    batch_ctx_t *batch = &G_context.tx_info.batch;
+
+    if (tx->signers_size != 1 || (tx->signers[0].scope & ~CALLED_BY_ENTRY) != 0) {
+        return false;
+    }
+    if (batch->received == 0) {
+        memcpy(batch->signer, tx->signers[0].account, UINT160_LEN);
+        return true;
+    }
+    return memcmp(batch->signer, tx->signers[0].account, UINT160_LEN) == 0;
+}
+
+/**
+ * Keep the summary of the transaction just received. Only single NEP-17 transfers of the single signer of the batch
+ * can be batched: the summary is all the user reviews.
+ */
+static uint16_t add_batch_tx(void) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+    batch_ctx_t *batch = &G_context.tx_info.batch;
+
+    if (!tx->is_token_transfer || tx->transfers_size != 1 || !check_batch_signer(tx)) {
+        return SW_BATCH_TX_UNSUPPORTED;
+    }
+
+    // fees are not negative, as guarded by the parser
+    const uint64_t fees = (uint64_t) tx->system_fee + (uint64_t) tx->network_fee;
+    if (fees > UINT64_MAX - batch->fees) {
+        return SW_BATCH_TX_UNSUPPORTED;
+    }
+    const transfer_t *transfer = &tx->transfers[0];
+    if (transfer->amount_len > sizeof(batch->amounts) - batch->amounts_len) {
+        return SW_BATCH_TX_UNSUPPORTED;
+    }
+    uint256_t amount;
+    uint256_t total;
+    transfer_get_amount(tx, transfer, &amount);
+    const uint8_t token_index = find_or_add_token(tx->transfer_tokens[transfer->token_index]);
+    if (token_index == MAX_TRANSFER_TOKENS) {
+        return SW_BATCH_TX_UNSUPPORTED;
+    }
+    // the totals are not kept but summed up again when displayed, they must not overflow then
+    get_batch_token_total(token_index, &total);
+    if (!uint256_add(&total, &amount)) {
+        return SW_BATCH_TX_UNSUPPORTED;
+    }
+    batch->fees += fees;
+
+    batch_tx_t *summary = &batch->txs[batch->received++];
+    memcpy(summary->hash, G_context.tx_info.hash, sizeof(summary->hash));
+    summary->fees = fees;
+    memcpy(summary->dst_script_hash, transfer->dst_script_hash, UINT160_LEN);
+    summary->token_index = token_index;
+    summary->amount_offset = batch->amounts_len;
+    summary->amount_len = transfer->amount_len;
+    memcpy(batch->amounts + batch->amounts_len, TRANSFER_AMOUNT(tx, transfer), transfer->amount_len);
+    batch->amounts_len += transfer->amount_len;
+
+    return SW_OK;
+}
+
+/**
+ * Hash and parse a part of the current transaction of the batch, review the batch once the last one is received.
+ */
+static int receive_batch_tx_chunk(buffer_t *cdata, bool more, bool with_offset) {
+    parser_status_e status = tx_stream_receive(cdata, more);
+    if (status != PARSING_OK) {
+        G_context.state = STATE_NONE;
+        return tx_stream_send_parsing_status(status);
+    }
+    if (more) {
+        return with_offset ? tx_stream_send_received_length(SW_OK) : io_send_sw(SW_OK);
+    }
+
+    // Last chunk of this transaction, its hash is final
+    uint16_t sw = add_batch_tx();
+    if (sw != SW_OK) {
+        G_context.state = STATE_NONE;
+        return io_send_sw(sw);
+    }
+    if (G_context.tx_info.batch.received < G_context.tx_info.batch.count) {
+        tx_stream_start(G_context.tx_info.compressed);
+        return io_send_sw(SW_OK);
+    }
+
+    G_context.state = STATE_PARSED;
+    return start_sign_tx_batch();
+}
+
+/**
+ * Signature of a transaction of an approved batch, computed again from its hash.
+ */
+static int send_batch_signature(buffer_t *cdata) {
+    uint8_t index;
+
+    if (!buffer_read_u8(cdata, &index) || index >= G_context.tx_info.batch.count) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+    if (crypto_sign_tx_hash(G_context.bip44_path,
+                            G_context.tx_info.batch.txs[index].hash,
+                            G_context.tx_info.signature,
+                            &G_context.tx_info.signature_len) < 0) {
+        return io_send_sw(SW_SIGN_FAIL);
+    }
+    return io_send_response(&(const buffer_t){.ptr = G_context.tx_info.signature,
+                                              .size = G_context.tx_info.signature_len,
+                                              .offset = 0},
+                            SW_OK);
+}
+
+int handler_sign_tx_batch(buffer_t *cdata, uint8_t p1, bool more, bool with_offset, bool compressed) {
+    if ((with_offset && (p1 != P1_BATCH_TX || compressed)) || (compressed && p1 == P1_BATCH_SIGNATURE)) {
+        return io_send_sw(SW_WRONG_P1P2);
+    }
+
+    if (p1 == P1_START) {
+        explicit_bzero(&G_context, sizeof(G_context));
+        G_context.req_type = CONFIRM_BATCH;
+        G_context.state = STATE_NONE;
+
+        uint16_t status;
+        if (!buffer_read_and_validate_bip44(cdata, G_context.bip44_path, &status)) {
+            return io_send_sw(status);
+        }
+        if (!buffer_read_u32(cdata, &G_context.network_magic, LE)) {
+            return io_send_sw(SW_MAGIC_PARSING_FAIL);
+        }
+        if (!buffer_read_u8(cdata, &G_context.tx_info.batch.count) || G_context.tx_info.batch.count == 0 ||
+            G_context.tx_info.batch.count > MAX_BATCH_TXS || cdata->offset != cdata->size) {
+            return io_send_sw(SW_WRONG_DATA_LENGTH);
+        }
+
+        tx_stream_start(compressed);
+        G_context.state = STATE_MAGIC_OK;
+        return io_send_sw(SW_OK);
+    }
+
+    if (G_context.req_type != CONFIRM_BATCH) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+    if (p1 == P1_BATCH_TX) {
+        if (G_context.state != STATE_MAGIC_OK) {
+            return io_send_sw(SW_BAD_STATE);
+        }
+        if (compressed != G_context.tx_info.compressed) {
+            // the encoding of all transactions is selected with the batch
+            return io_send_sw(SW_WRONG_P1P2);
+        }
+        if (with_offset) {
+            return tx_stream_receive_at_offset(cdata, more, receive_batch_tx_chunk);
+        }
+        return receive_batch_tx_chunk(cdata, more, false);
+    }
+
+    // P1_BATCH_SIGNATURE
+    if (G_context.state != STATE_APPROVED) {
+        return io_send_sw(SW_BAD_STATE);
+    }
+    return send_batch_signature(cdata);
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+
+#include "common/buffer.h"
+
+/**
+ * Handler for SIGN_TX_BATCH command. Several transactions are signed with the same BIP44 path and network magic
+ * after a single review of their summary.
+ *
+ * The first APDU holds the BIP44 path, the network magic and the number of transactions. The transactions follow one
+ * after the other, each one in as many chunks as needed and parsed as it is received: only a summary of each one is
+ * kept. The review starts once the last one is received, its approval is answered with the signature of the first
+ * transaction, the others are then requested by index. Each transaction is a single NEP-17 transfer whose only signer
+ * is the same account, limited to the entry script, for all of them.
+ *
+ * The chunks are sent as those of SIGN_TX: with their offset in the transaction, or in the compressed encoding
+ * selected with the first APDU for all the transactions.
+ *
+ * @see G_context.bip44_path, G_context.network_magic, G_context.tx_info.batch.
+ *
+ * @param[in,out] cdata
+ *   Command data.
+ * @param[in]     p1
+ *   P1_START, P1_BATCH_TX or P1_BATCH_SIGNATURE.
+ * @param[in]     more
+ *   Whether more chunks of the current transaction are expected to be received or not.
+ * @param[in]     with_offset
+ *   Whether the transaction chunk starts with its offset in the transaction (P1_BATCH_TX only).
+ * @param[in]     compressed
+ *   Whether the transactions are sent in the compressed encoding, see transaction/expander.h.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int handler_sign_tx_batch(buffer_t *cdata, uint8_t p1, bool more, bool with_offset, bool compressed);
@@ -0,0 +1,179 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+#include <stddef.h>   // size_t
+#include <string.h>   // memcpy
+
+#include "os.h"
+#include "cx.h"
+
+#include "tx_stream.h"
+#include "sw.h"
+#include "globals.h"
+#include "common/buffer.h"
+#include "common/write.h"
+#include "transaction/deserialize.h"
+#include "transaction/expander.h"
+
+/**
+ * Transaction bytes expanded at once from a compressed chunk.
+ */
+#define EXPAND_BUFFER_LEN 64
+
+_Static_assert(EXPAND_BUFFER_LEN >= EXPAND_MAX_TOKEN_LEN, "The expansion buffer must hold any token!");
+
+void tx_stream_start(bool compressed) {
+    transaction_parser_init(&G_context.tx_info.parser, &G_context.tx_info.transaction);
+    cx_sha256_init(&G_context.tx_info.hash_ctx);
+    G_context.tx_info.received = 0;
+    G_context.tx_info.compressed = compressed;
+    tx_expander_init(&G_context.tx_info.expander);
+}
+
+#ifdef HAVE_RESIGN_TX
+/**
+ * Keep the bytes of the transaction after its header, as long as they fit: RESIGN_TX hashes them again after a new
+ * header. 'data' starts at offset G_context.tx_info.received of the transaction.
+ */
+static void keep_tx_tail(const buffer_t *data) {
+    const uint8_t *bytes = data->ptr + data->offset;
+    size_t len = data->size - data->offset;
+    uint32_t position = G_context.tx_info.received;
+
+    if (position < TX_HEADER_LEN) {
+        size_t header_len = (len < TX_HEADER_LEN - position) ? len : TX_HEADER_LEN - position;
+
+        bytes += header_len;
+        len -= header_len;
+        position += header_len;
+    }
+    if (position - TX_HEADER_LEN < sizeof(G_context.tx_info.tail)) {
+        size_t room = sizeof(G_context.tx_info.tail) - (position - TX_HEADER_LEN);
+
+        memcpy(G_context.tx_info.tail + position - TX_HEADER_LEN, bytes, (len < room) ? len : room);
+    }
+}
+#endif
+
+/**
+ * Hash and parse the next bytes of the transaction.
+ */
+static parser_status_e consume_tx_data(buffer_t *data) {
+    /**
+     * Here we hash the signed part of the transaction. This is _not_ the final hash used as input for ecdsa
+     * (see crypto_sign_tx()) The final hash is: sha256(network magic + sha256(signed part of tx data)), but we
+     * don't hash this until we've approved among others the network magic
+     */
+    CX_ASSERT(cx_hash_no_throw((cx_hash_t *) &G_context.tx_info.hash_ctx,
+                               0 /*mode*/,
+                               data->ptr + data->offset /* data in */,
+                               data->size - data->offset /* data in len */,
+                               NULL /* hash out*/,
+                               0 /* hash out len */));
+#ifdef HAVE_RESIGN_TX
+    if (G_context.req_type == CONFIRM_TRANSACTION) {
+        // the tail shares its memory with the summaries of a batch
+        keep_tx_tail(data);
+    }
+#endif
+    G_context.tx_info.received += data->size - data->offset;
+
+    // The transaction is parsed as it arrives, none of the raw chunks are kept
+    return transaction_parse_chunk(&G_context.tx_info.parser, data, &G_context.tx_info.transaction);
+}
+
+/**
+ * Expand a compressed part of the transaction, then hash and parse the expanded bytes: the signature covers the
+ * transaction itself, not its encoding.
+ */
+static parser_status_e expand_and_consume(buffer_t *cdata) {
+    uint8_t expanded[EXPAND_BUFFER_LEN];
+    parser_status_e status = PARSING_OK;
+
+    while (status == PARSING_OK && cdata->offset < cdata->size) {
+        size_t len = 0;
+
+        status = tx_expand(&G_context.tx_info.expander, cdata, expanded, sizeof(expanded), &len);
+        if (status == PARSING_OK) {
+            status = consume_tx_data(&(buffer_t){.ptr = expanded, .size = len, .offset = 0});
+        }
+    }
+    return status;
+}
+
+parser_status_e tx_stream_receive(buffer_t *cdata, bool more) {
+    parser_status_e status = G_context.tx_info.compressed ? expand_and_consume(cdata) : consume_tx_data(cdata);
+
+    if (status != PARSING_OK || more) {
+        return status;
+    }
+    if (G_context.tx_info.compressed && !tx_expander_complete(&G_context.tx_info.expander)) {
+        return COMPRESSED_DATA_ERROR;
+    }
+    status = transaction_parse_finish(&G_context.tx_info.parser);
+    if (status != PARSING_OK) {
+        return status;
+    }
+
+    // Last part, finalize the hash
+    CX_ASSERT(cx_hash_no_throw((cx_hash_t *) &G_context.tx_info.hash_ctx,
+                               CX_LAST /*mode*/,
+                               NULL /* data in */,
+                               0 /* data in len */,
+                               G_context.tx_info.hash /* hash out*/,
+                               sizeof(G_context.tx_info.hash) /* hash out len */));
+
+    PRINTF("Hash: %.*H\n", sizeof(G_context.tx_info.hash), G_context.tx_info.hash);
+    return PARSING_OK;
+}
+
+int tx_stream_send_parsing_status(parser_status_e status) {
+    char status_char[1] = {(uint8_t) status};
+
+    return io_send_response(&(const buffer_t){.ptr = (unsigned char *) status_char, .size = 1, .offset = 0},
+                            SW_TX_PARSING_FAIL);
+}
+
+int tx_stream_send_received_length(uint16_t sw) {
+    uint8_t received[4];
+
+    write_u32_be(received, 0, G_context.tx_info.received);
+    return io_send_response(&(const buffer_t){.ptr = received, .size = sizeof(received), .offset = 0}, sw);
+}
+
+int tx_stream_receive_at_offset(buffer_t *cdata, bool more, tx_chunk_receiver_t receive) {
+    uint32_t offset;
+
+    if (!buffer_read_u32(cdata, &offset, BE)) {
+        return io_send_sw(SW_WRONG_DATA_LENGTH);
+    }
+    if (offset > G_context.tx_info.received) {
+        return tx_stream_send_received_length(SW_WRONG_TX_OFFSET);
+    }
+
+    size_t duplicate = G_context.tx_info.received - offset;
+    size_t available = cdata->size - cdata->offset;
+    if (duplicate >= available && more) {
+        // nothing new, e.g. an empty chunk sent to ask where to resume
+        return tx_stream_send_received_length(SW_OK);
+    }
+    buffer_seek_cur(cdata, (duplicate < available) ? duplicate : available);
+
+    return receive(cdata, more, true);
+}
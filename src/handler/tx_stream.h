@@ -0,0 +1,76 @@
+#pragma once
+
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+
+#include "common/buffer.h"
+#include "transaction/transaction_types.h"
+
+/**
+ * Receiver of a transaction chunk, once the part of it which was already received has been skipped.
+ */
+typedef int (*tx_chunk_receiver_t)(buffer_t *cdata, bool more, bool with_offset);
+
+/**
+ * Get ready to receive a transaction in G_context.tx_info: parser, running hash and expander are reset.
+ *
+ * @param[in] compressed
+ *   Whether the transaction is sent in the compressed encoding, see transaction/expander.h.
+ *
+ */
+void tx_stream_start(bool compressed);
+
+/**
+ * Hash and parse the next part of the transaction, expanded first if it is compressed. Once the last part is
+ * received, the parsing is completed and the hash is finalized in G_context.tx_info.hash.
+ *
+ * With HAVE_RESIGN_TX, SIGN_TX transactions also keep their bytes after the header, see G_context.tx_info.tail.
+ *
+ * @param[in,out] cdata
+ *   Command data with the next part of the transaction.
+ * @param[in]     more
+ *   Whether more parts of the transaction are expected to be received or not.
+ *
+ * @return PARSING_OK if success, the parsing error otherwise.
+ *
+ */
+parser_status_e tx_stream_receive(buffer_t *cdata, bool more);
+
+/**
+ * Send the parsing error of a transaction, in a response with SW_TX_PARSING_FAIL.
+ *
+ * @param[in] status
+ *   Parsing error.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int tx_stream_send_parsing_status(parser_status_e status);
+
+/**
+ * Acknowledge a transaction chunk sent with its offset: the number of transaction bytes received so far, big endian.
+ *
+ * @param[in] sw
+ *   Status word of the response.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int tx_stream_send_received_length(uint16_t sw);
+
+/**
+ * Skip the part of a chunk sent with its offset which was already received, when the acknowledgement of a previous
+ * chunk was lost, and pass the rest to 'receive'. The offset may not go beyond the bytes received so far, the hash
+ * would miss a part of the transaction.
+ *
+ * @param[in,out] cdata
+ *   Command data with the offset of the chunk (4 bytes, big endian) followed by the chunk.
+ * @param[in]     more
+ *   Whether more chunks of the transaction are expected to be received or not.
+ * @param[in]     receive
+ *   Receiver of the new part of the chunk, called with 'with_offset' set.
+ *
+ * @return zero or positive integer if success, negative integer otherwise.
+ *
+ */
+int tx_stream_receive_at_offset(buffer_t *cdata, bool more, tx_chunk_receiver_t receive);
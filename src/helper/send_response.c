@@ -7,14 +7,36 @@
 #include "globals.h"
 #include "sw.h"
 #include "common/buffer.h"
+#include "ui/utils.h"
 
 int helper_send_response_pubkey() {
     uint8_t resp[1 + PUBKEY_LEN] = {0};
-    size_t offset = 1;
+    size_t offset = 0;
 
-    resp[0] = 0x04;
-    memcpy(resp + offset, G_context.raw_public_key, PUBKEY_LEN);
-    offset += PUBKEY_LEN;
+    switch (G_context.pk_format) {
+        case PUBKEY_FORMAT_COMPRESSED:
+            compress_public_key(G_context.raw_public_key, resp);
+            offset = COMPRESSED_PUBKEY_LEN;
+            break;
+        case PUBKEY_FORMAT_SCRIPT_HASH:
+            if (!script_hash_from_pubkey(G_context.raw_public_key, resp)) {
+                return io_send_sw(SW_CONVERT_TO_ADDRESS_FAIL);
+            }
+            offset = UINT160_LEN;
+            break;
+        case PUBKEY_FORMAT_ADDRESS:
+            // base58 check encoded, without null terminator
+            if (!address_from_pubkey(G_context.raw_public_key, (char *) resp, sizeof(resp))) {
+                return io_send_sw(SW_CONVERT_TO_ADDRESS_FAIL);
+            }
+            offset = ADDRESS_LEN;
+            break;
+        default:
+            resp[0] = 0x04;
+            memcpy(resp + 1, G_context.raw_public_key, PUBKEY_LEN);
+            offset = 1 + PUBKEY_LEN;
+            break;
+    }
 
     return io_send_response(&(const buffer_t){.ptr = resp, .size = offset, .offset = 0}, SW_OK);
 }
\ No newline at end of file
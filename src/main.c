@@ -29,6 +29,8 @@
 #include "ui/menu.h"
 #include "apdu/parser.h"
 #include "apdu/dispatcher.h"
+#include "sign_cache.h"
+#include "handler/sign_session.h"
 
 uint8_t G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 io_state_e G_io_state;
@@ -104,6 +106,9 @@ void app_main() {
  * Exit the application and go back to the dashboard.
  */
 void app_exit() {
+    sign_cache_clear();
+    sign_session_close();
+
     BEGIN_TRY_L(exit) {
         TRY_L(exit) {
             os_sched_exit(-1);
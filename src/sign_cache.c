@@ -0,0 +1,69 @@
+/*****************************************************************************
+ *   Ledger App Boilerplate.
+ *   (c) 2020 Ledger SAS.
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *****************************************************************************/
+
+#include <stdint.h>  // uint*_t
+#include <string.h>  // memcpy, memcmp, explicit_bzero
+
+#include "sign_cache.h"
+
+/**
+ * Kept out of G_context, which is reset by each command and when the transport is reset: a lost response is most
+ * likely followed by a reconnection.
+ */
+static sign_cache_entry_t entries[SIGN_CACHE_SIZE];
+static uint8_t next_entry;
+
+void sign_cache_add(uint32_t network_magic,
+                    const uint8_t tx_hash[static 32],
+                    const uint32_t *bip44_path,
+                    const uint8_t *signature,
+                    uint8_t signature_len) {
+    if (signature_len == 0 || signature_len > MAX_DER_SIG_LEN ||
+        sign_cache_find(network_magic, tx_hash, bip44_path) != NULL) {
+        return;
+    }
+
+    sign_cache_entry_t *entry = &entries[next_entry];
+    next_entry = (next_entry + 1) % SIGN_CACHE_SIZE;
+
+    explicit_bzero(entry, sizeof(*entry));
+    entry->network_magic = network_magic;
+    memcpy(entry->tx_hash, tx_hash, sizeof(entry->tx_hash));
+    memcpy(entry->bip44_path, bip44_path, sizeof(entry->bip44_path));
+    memcpy(entry->signature, signature, signature_len);
+    entry->signature_len = signature_len;
+}
+
+const sign_cache_entry_t *sign_cache_find(uint32_t network_magic,
+                                          const uint8_t tx_hash[static 32],
+                                          const uint32_t *bip44_path) {
+    for (uint8_t i = 0; i < SIGN_CACHE_SIZE; i++) {
+        const sign_cache_entry_t *entry = &entries[i];
+
+        if (entry->signature_len != 0 && entry->network_magic == network_magic &&
+            memcmp(entry->tx_hash, tx_hash, sizeof(entry->tx_hash)) == 0 &&
+            memcmp(entry->bip44_path, bip44_path, sizeof(entry->bip44_path)) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+void sign_cache_clear(void) {
+    explicit_bzero(entries, sizeof(entries));
+    next_entry = 0;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>  // uint*_t
+
+#include "constants.h"
+
+/**
+ * Number of signatures kept, the oldest one is replaced by a new one.
+ */
+#ifdef TARGET_NANOS
+#define SIGN_CACHE_SIZE 2
+#else
+#define SIGN_CACHE_SIZE 4
+#endif
+
+/**
+ * Signature of a transaction approved in this session.
+ */
+typedef struct {
+    uint32_t network_magic;
+    uint8_t tx_hash[32];                  /// Hash of the signed part of the transaction
+    uint32_t bip44_path[BIP44_PATH_LEN];  /// BIP44 path of the signing key
+    uint8_t signature[MAX_DER_SIG_LEN];   /// Signature encoded in ASN1.DER
+    uint8_t signature_len;                /// Length of the signature, 0 for an empty entry
+} sign_cache_entry_t;
+
+/**
+ * Keep the signature of an approved transaction, so that the same transaction sent again gets it without a second
+ * review, e.g. when the response was lost. Only the current session of the app keeps them.
+ *
+ * @param[in] network_magic
+ *   Network magic the transaction was signed for.
+ * @param[in] tx_hash
+ *   Hash of the signed part of the transaction.
+ * @param[in] bip44_path
+ *   BIP44 path of BIP44_PATH_LEN levels.
+ * @param[in] signature
+ *   Signature encoded in ASN1.DER.
+ * @param[in] signature_len
+ *   Length of the signature, at most MAX_DER_SIG_LEN.
+ *
+ */
+void sign_cache_add(uint32_t network_magic,
+                    const uint8_t tx_hash[static 32],
+                    const uint32_t *bip44_path,
+                    const uint8_t *signature,
+                    uint8_t signature_len);
+
+/**
+ * Signature of a transaction approved in this session.
+ *
+ * @param[in] network_magic
+ *   Network magic the transaction is signed for.
+ * @param[in] tx_hash
+ *   Hash of the signed part of the transaction.
+ * @param[in] bip44_path
+ *   BIP44 path of BIP44_PATH_LEN levels.
+ *
+ * @return the entry with the signature, NULL if there is none.
+ *
+ */
+const sign_cache_entry_t *sign_cache_find(uint32_t network_magic,
+                                          const uint8_t tx_hash[static 32],
+                                          const uint32_t *bip44_path);
+
+/**
+ * Forget all signatures, when the app exits.
+ */
+void sign_cache_clear(void);
@@ -48,6 +48,14 @@
  * Status word for signing failure.
  */
 #define SW_SIGN_FAIL 0xB005
+/**
+ * Status word for a transaction chunk starting beyond the bytes received so far.
+ */
+#define SW_WRONG_TX_OFFSET 0xB006
+/**
+ * Status word for a transaction of a batch which is not a plain NEP-17 transfer, or whose totals overflow.
+ */
+#define SW_BATCH_TX_UNSUPPORTED 0xB007
 /**
  * Status word for invalid BIP44 purpose field
  */
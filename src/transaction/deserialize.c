@@ -19,167 +19,347 @@
 #include "types.h"
 #include "constants.h"
 #include "common/buffer.h"
+#include "common/read.h"
+#include "common/varint.h"
 #include "tx_utils.h"
 
 #include <string.h>
 
-parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx) {
-    if (buf->size > MAX_TRANSACTION_LEN) {
-        return INVALID_LENGTH_ERROR;
+/**
+ * Copy bytes of the field being parsed from 'buf' into 'dst' until 'len' bytes have been collected.
+ * Progress is kept in parser->pending_len so a field can be split over any number of chunks.
+ *
+ * @return true if the field is complete, false if more data is needed.
+ */
+static bool collect(tx_parser_t *parser, buffer_t *buf, uint8_t *dst, size_t len) {
+    if (parser->pending_len >= len) {
+        return true;
     }
 
-    // This can actually never fail because 'buf' would contain the tx data send in the 3rd apdu.
-    // If the 3rd apdu has no data, it will fail in the dispatcher.
-    // Leaving it just in case code might change in the future. Better safe than sorrow
-    if (!buffer_read_u8(buf, &tx->version)) {
-        return VERSION_PARSING_ERROR;
-    }
+    size_t missing = len - parser->pending_len;
+    size_t available = buf->size - buf->offset;
+    size_t n = (available < missing) ? available : missing;
 
-    if (tx->version > 0) {
-        return VERSION_VALUE_ERROR;
-    }
+    memcpy(dst + parser->pending_len, buf->ptr + buf->offset, n);
+    buffer_seek_cur(buf, n);
+    parser->pending_len += n;
 
-    if (!buffer_read_u32(buf, &tx->nonce, LE)) {
-        return NONCE_PARSING_ERROR;
-    }
+    return parser->pending_len == len;
+}
 
-    if (!buffer_read_s64(buf, &tx->system_fee, LE)) {
-        return SYSTEM_FEE_PARSING_ERROR;
-    }
-    if (tx->system_fee < 0) {
-        return SYSTEM_FEE_VALUE_ERROR;
+/**
+ * Collect a Bitcoin-like varint, of which the length is only known after its prefix byte has been received.
+ */
+static bool collect_varint(tx_parser_t *parser, buffer_t *buf, uint64_t *value) {
+    if (!collect(parser, buf, parser->pending, 1)) {
+        return false;
     }
 
-    if (!buffer_read_s64(buf, &tx->network_fee, LE)) {
-        return NETWORK_FEE_PARSING_ERROR;
-    }
+    uint8_t prefix = parser->pending[0];
+    size_t len = (prefix == 0xFD) ? 3 : (prefix == 0xFE) ? 5 : (prefix == 0xFF) ? 9 : 1;
 
-    if (tx->network_fee < 0) {
-        return NETWORK_FEE_VALUE_ERROR;
+    if (!collect(parser, buf, parser->pending, len)) {
+        return false;
     }
 
-    if (!buffer_read_u32(buf, &tx->valid_until_block, LE)) {
-        return VALID_UNTIL_BLOCK_PARSING_ERROR;
-    }
+    varint_read(parser->pending, len, value);
+    return true;
+}
 
-    // Parse (Co)Signers
-    uint64_t signer_length;
-    if (!buffer_read_varint(buf, &signer_length)) {
-        return SIGNER_LENGTH_PARSING_ERROR;
+static void next_field(tx_parser_t *parser, tx_field_e field) {
+    parser->field = field;
+    parser->pending_len = 0;
+}
+
+static void next_signer(tx_parser_t *parser, const transaction_t *tx) {
+    parser->index++;
+    if (parser->index == tx->signers_size) {
+        parser->index = 0;
+        next_field(parser, TX_FIELD_ATTRIBUTES_LENGTH);
+    } else {
+        next_field(parser, TX_FIELD_SIGNER_ACCOUNT);
     }
-    if (signer_length < MIN_TX_SIGNERS || signer_length > MAX_TX_SIGNERS) {
-        return SIGNER_LENGTH_VALUE_ERROR;
+}
+
+static void after_allowed_contracts(tx_parser_t *parser, const transaction_t *tx) {
+    if ((tx->signers[parser->index].scope & CUSTOM_GROUPS) == CUSTOM_GROUPS) {
+        next_field(parser, TX_FIELD_SIGNER_GROUPS_LENGTH);
+    } else {
+        next_signer(parser, tx);
     }
+}
 
-    tx->signers_size = (uint8_t) signer_length;
-    for (int i = 0; i < tx->signers_size; i++) {
-        tx->signers[i].account = (uint8_t *) (buf->ptr + buf->offset);
-        if (!buffer_seek_cur(buf, UINT160_LEN)) {
-            return SIGNER_ACCOUNT_PARSING_ERROR;
-        }
+void transaction_parser_init(tx_parser_t *parser, transaction_t *tx) {
+    memset(parser, 0, sizeof(*parser));
+    memset(tx, 0, sizeof(*tx));
+    parser->field = TX_FIELD_VERSION;
+}
 
-        // Check that the signer is unique by comparing its account property vs existing accounts
-        // 'i' determines how many signers (and thus accounts) have been added so far.
-        for (int s = 0; s < i; s++) {
-            if (!memcmp(tx->signers[s].account, tx->signers[i].account, UINT160_LEN)) {
-                return SIGNER_ACCOUNT_DUPLICATE_ERROR;
-            }
-        }
+parser_status_e transaction_parse_chunk(tx_parser_t *parser, buffer_t *buf, transaction_t *tx) {
+    uint64_t value;
 
-        uint8_t value;
-        if (!buffer_read_u8(buf, &value)) {
-            return SIGNER_SCOPE_PARSING_ERROR;
-        }
-        tx->signers[i].scope = (witness_scope_e) value;
+    while (buf->offset < buf->size) {
+        signer_t *signer = (parser->index < MAX_TX_SIGNERS) ? &tx->signers[parser->index] : NULL;
 
-        // Scope GLOBAL is not allowed to have other flags
-        if ((((witness_scope_e) value & GLOBAL) == GLOBAL) && ((witness_scope_e) value != GLOBAL)) {
-            return SIGNER_SCOPE_VALUE_ERROR_GLOBAL_FLAG;
-        }
+        switch (parser->field) {
+            case TX_FIELD_VERSION:
+                if (!collect(parser, buf, &tx->version, 1)) break;
+                if (tx->version > 0) {
+                    return VERSION_VALUE_ERROR;
+                }
+                next_field(parser, TX_FIELD_NONCE);
+                break;
 
-        uint64_t var_int_length;
-        if (((witness_scope_e) value & CUSTOM_CONTRACTS) == CUSTOM_CONTRACTS) {
-            if (!buffer_read_varint(buf, &var_int_length)) {
-                return SIGNER_ALLOWED_CONTRACTS_LENGTH_PARSING_ERROR;
-            }
-            if (var_int_length > MAX_SIGNER_ALLOWED_CONTRACTS) {
-                return SIGNER_ALLOWED_CONTRACTS_LENGTH_VALUE_ERROR;
-            }
-            tx->signers[i].allowed_contracts_size = var_int_length;
-            for (size_t j = 0; j < var_int_length; j++) {
-                tx->signers[i].allowed_contracts[j] = (uint8_t *) (buf->ptr + buf->offset);
-                if (!buffer_seek_cur(buf, UINT160_LEN)) {
-                    return SIGNER_ALLOWED_CONTRACT_PARSING_ERROR;
+            case TX_FIELD_NONCE:
+                if (!collect(parser, buf, parser->pending, 4)) break;
+                tx->nonce = read_u32_le(parser->pending, 0);
+                next_field(parser, TX_FIELD_SYSTEM_FEE);
+                break;
+
+            case TX_FIELD_SYSTEM_FEE:
+                if (!collect(parser, buf, parser->pending, 8)) break;
+                tx->system_fee = read_s64_le(parser->pending, 0);
+                if (tx->system_fee < 0) {
+                    return SYSTEM_FEE_VALUE_ERROR;
                 }
-            }
-        }
+                next_field(parser, TX_FIELD_NETWORK_FEE);
+                break;
 
-        var_int_length = 0;
-        if (((witness_scope_e) value & CUSTOM_GROUPS) == CUSTOM_GROUPS) {
-            if (!buffer_read_varint(buf, &var_int_length)) {
-                return SIGNER_ALLOWED_GROUPS_LENGTH_PARSING_ERROR;
-            }
-            if (var_int_length > MAX_SIGNER_ALLOWED_GROUPS) {
-                return SIGNER_ALLOWED_GROUPS_LENGTH_VALUE_ERROR;
-            }
-            tx->signers[i].allowed_groups_size = var_int_length;
-            for (size_t j = 0; j < var_int_length; j++) {
-                tx->signers[i].allowed_groups[j] = (uint8_t *) (buf->ptr + buf->offset);
-                if (!buffer_seek_cur(buf, ECPOINT_LEN)) {
-                    return SIGNER_ALLOWED_CONTRACT_PARSING_ERROR;
+            case TX_FIELD_NETWORK_FEE:
+                if (!collect(parser, buf, parser->pending, 8)) break;
+                tx->network_fee = read_s64_le(parser->pending, 0);
+                if (tx->network_fee < 0) {
+                    return NETWORK_FEE_VALUE_ERROR;
                 }
-            }
-        }
-    }
+                next_field(parser, TX_FIELD_VALID_UNTIL_BLOCK);
+                break;
 
-    // Parse transaction attributes
-    uint64_t attributes_length;
-    if (!buffer_read_varint(buf, &attributes_length)) {
-        return ATTRIBUTES_LENGTH_PARSING_ERROR;
-    }
-    // The actual network does (MAX_TX_SIGNERS (16) - signer length) but due to memory constraints we lowered the
-    // MAX_ATTRIBUTES and hardcode the attributes limit to 2
-    if (attributes_length > MAX_ATTRIBUTES || attributes_length > 2) {
-        return ATTRIBUTES_LENGTH_VALUE_ERROR;
-    }
-    tx->attributes_size = (uint8_t) attributes_length;
+            case TX_FIELD_VALID_UNTIL_BLOCK:
+                if (!collect(parser, buf, parser->pending, 4)) break;
+                tx->valid_until_block = read_u32_le(parser->pending, 0);
+                next_field(parser, TX_FIELD_SIGNERS_LENGTH);
+                break;
 
-    if (tx->attributes_size > 0) {
-        for (int i = 0; i < tx->attributes_size; i++) {
-            uint8_t attribute_type;
-            if (!buffer_read_u8(buf, &attribute_type) || attribute_type != HIGH_PRIORITY) {
-                return ATTRIBUTES_UNSUPPORTED_TYPE;
-            }
-            // check for duplicates
-            for (int j = 0; j < tx->attributes_size; j++) {
-                if (tx->attributes[j].type == attribute_type) {
-                    return ATTRIBUTES_DUPLICATE_TYPE;
+            // Parse (Co)Signers
+            case TX_FIELD_SIGNERS_LENGTH:
+                if (!collect_varint(parser, buf, &value)) break;
+                if (value < MIN_TX_SIGNERS || value > MAX_TX_SIGNERS) {
+                    return SIGNER_LENGTH_VALUE_ERROR;
+                }
+                tx->signers_size = (uint8_t) value;
+                parser->index = 0;
+                next_field(parser, TX_FIELD_SIGNER_ACCOUNT);
+                break;
+
+            case TX_FIELD_SIGNER_ACCOUNT:
+                if (!collect(parser, buf, signer->account, UINT160_LEN)) break;
+                // Check that the signer is unique by comparing its account property vs existing accounts
+                // 'index' determines how many signers (and thus accounts) have been added so far.
+                for (int s = 0; s < parser->index; s++) {
+                    if (!memcmp(tx->signers[s].account, signer->account, UINT160_LEN)) {
+                        return SIGNER_ACCOUNT_DUPLICATE_ERROR;
+                    }
+                }
+                next_field(parser, TX_FIELD_SIGNER_SCOPE);
+                break;
+
+            case TX_FIELD_SIGNER_SCOPE:
+                if (!collect(parser, buf, parser->pending, 1)) break;
+                signer->scope = parser->pending[0];
+
+                // Scope GLOBAL is not allowed to have other flags
+                if (((signer->scope & GLOBAL) == GLOBAL) && (signer->scope != GLOBAL)) {
+                    return SIGNER_SCOPE_VALUE_ERROR_GLOBAL_FLAG;
+                }
+
+                if ((signer->scope & CUSTOM_CONTRACTS) == CUSTOM_CONTRACTS) {
+                    next_field(parser, TX_FIELD_SIGNER_CONTRACTS_LENGTH);
+                } else {
+                    after_allowed_contracts(parser, tx);
+                }
+                break;
+
+            case TX_FIELD_SIGNER_CONTRACTS_LENGTH:
+                if (!collect_varint(parser, buf, &value)) break;
+                if (value > MAX_SIGNER_ALLOWED_CONTRACTS ||
+                    value * UINT160_LEN > sizeof(tx->signer_data) - tx->signer_data_len) {
+                    return SIGNER_ALLOWED_CONTRACTS_LENGTH_VALUE_ERROR;
+                }
+                signer->allowed_contracts_size = (uint8_t) value;
+                signer->allowed_contracts_offset = tx->signer_data_len;
+                tx->signer_data_len += value * UINT160_LEN;
+                parser->item_index = 0;
+                if (value == 0) {
+                    after_allowed_contracts(parser, tx);
+                } else {
+                    next_field(parser, TX_FIELD_SIGNER_CONTRACT);
+                }
+                break;
+
+            case TX_FIELD_SIGNER_CONTRACT:
+                if (!collect(parser, buf, SIGNER_ALLOWED_CONTRACT(tx, signer, parser->item_index), UINT160_LEN)) break;
+                parser->pending_len = 0;
+                if (++parser->item_index == signer->allowed_contracts_size) {
+                    after_allowed_contracts(parser, tx);
+                }
+                break;
+
+            case TX_FIELD_SIGNER_GROUPS_LENGTH:
+                if (!collect_varint(parser, buf, &value)) break;
+                if (value > MAX_SIGNER_ALLOWED_GROUPS ||
+                    value * ECPOINT_LEN > sizeof(tx->signer_data) - tx->signer_data_len) {
+                    return SIGNER_ALLOWED_GROUPS_LENGTH_VALUE_ERROR;
+                }
+                signer->allowed_groups_size = (uint8_t) value;
+                signer->allowed_groups_offset = tx->signer_data_len;
+                tx->signer_data_len += value * ECPOINT_LEN;
+                parser->item_index = 0;
+                if (value == 0) {
+                    next_signer(parser, tx);
+                } else {
+                    next_field(parser, TX_FIELD_SIGNER_GROUP);
+                }
+                break;
+
+            case TX_FIELD_SIGNER_GROUP:
+                if (!collect(parser, buf, SIGNER_ALLOWED_GROUP(tx, signer, parser->item_index), ECPOINT_LEN)) break;
+                parser->pending_len = 0;
+                if (++parser->item_index == signer->allowed_groups_size) {
+                    next_signer(parser, tx);
+                }
+                break;
+
+            // Parse transaction attributes
+            case TX_FIELD_ATTRIBUTES_LENGTH:
+                if (!collect_varint(parser, buf, &value)) break;
+                // Like the network, signers and attributes together are limited to 16
+                if (value > MAX_ATTRIBUTES || value + tx->signers_size > MAX_ATTRIBUTES) {
+                    return ATTRIBUTES_LENGTH_VALUE_ERROR;
+                }
+                tx->attributes_size = (uint8_t) value;
+                parser->index = 0;
+                next_field(parser, (value == 0) ? TX_FIELD_SCRIPT_LENGTH : TX_FIELD_ATTRIBUTE);
+                break;
+
+            case TX_FIELD_ATTRIBUTE:
+                if (!collect(parser, buf, parser->pending, 1)) break;
+                if (parser->pending[0] != HIGH_PRIORITY) {
+                    return ATTRIBUTES_UNSUPPORTED_TYPE;
+                }
+                // check for duplicates
+                for (int j = 0; j < parser->index; j++) {
+                    if (tx->attributes[j].type == parser->pending[0]) {
+                        return ATTRIBUTES_DUPLICATE_TYPE;
+                    }
+                }
+                tx->attributes[parser->index] = (attribute_t){.type = parser->pending[0]};
+                parser->pending_len = 0;
+                if (++parser->index == tx->attributes_size) {
+                    next_field(parser, TX_FIELD_SCRIPT_LENGTH);
                 }
+                break;
+
+            // Parse out script
+            case TX_FIELD_SCRIPT_LENGTH:
+                if (!collect_varint(parser, buf, &value)) break;
+                if (value > MAX_SCRIPT_LEN || value == 0) {
+                    return SCRIPT_LENGTH_VALUE_ERROR;
+                }
+                tx->script_size = (uint16_t) value;
+                parser->script_read = 0;
+                script_matcher_init(&parser->matcher);
+                next_field(parser, TX_FIELD_SCRIPT);
+                break;
+
+            case TX_FIELD_SCRIPT: {
+                size_t available = buf->size - buf->offset;
+                size_t n = tx->script_size - parser->script_read;
+                if (available < n) {
+                    n = available;
+                }
+
+                // only the leading part of the script is kept for analysis, the rest is just skipped
+                if (parser->script_read < sizeof(tx->script)) {
+                    size_t keep = sizeof(tx->script) - parser->script_read;
+                    memcpy(tx->script + parser->script_read, buf->ptr + buf->offset, (keep < n) ? keep : n);
+                }
+                script_matcher_feed(&parser->matcher, buf->ptr + buf->offset, n, tx);
+                buffer_seek_cur(buf, n);
+                parser->script_read += n;
+
+                if (parser->script_read == tx->script_size) {
+                    script_matcher_finish(&parser->matcher, tx);
+                    next_field(parser, TX_FIELD_DONE);
+                }
+                break;
             }
-            tx->attributes[i] = (attribute_t){.type = attribute_type};
+
+            case TX_FIELD_DONE:
+                // data beyond the end of the transaction
+                return INVALID_LENGTH_ERROR;
         }
     }
 
-    // Parse out script
-    uint64_t script_length;
-    if (!buffer_read_varint(buf, &script_length)) {
-        return SCRIPT_LENGTH_PARSING_ERROR;
+    return PARSING_OK;
+}
+
+parser_status_e transaction_parse_finish(const tx_parser_t *parser) {
+    // Map the field that could not be completed to the error the non-streaming parser used to return
+    switch (parser->field) {
+        case TX_FIELD_VERSION:
+            return VERSION_PARSING_ERROR;
+        case TX_FIELD_NONCE:
+            return NONCE_PARSING_ERROR;
+        case TX_FIELD_SYSTEM_FEE:
+            return SYSTEM_FEE_PARSING_ERROR;
+        case TX_FIELD_NETWORK_FEE:
+            return NETWORK_FEE_PARSING_ERROR;
+        case TX_FIELD_VALID_UNTIL_BLOCK:
+            return VALID_UNTIL_BLOCK_PARSING_ERROR;
+        case TX_FIELD_SIGNERS_LENGTH:
+            return SIGNER_LENGTH_PARSING_ERROR;
+        case TX_FIELD_SIGNER_ACCOUNT:
+            return SIGNER_ACCOUNT_PARSING_ERROR;
+        case TX_FIELD_SIGNER_SCOPE:
+            return SIGNER_SCOPE_PARSING_ERROR;
+        case TX_FIELD_SIGNER_CONTRACTS_LENGTH:
+            return SIGNER_ALLOWED_CONTRACTS_LENGTH_PARSING_ERROR;
+        case TX_FIELD_SIGNER_CONTRACT:
+        case TX_FIELD_SIGNER_GROUP:  // reported as a contract error, hosts rely on it
+            return SIGNER_ALLOWED_CONTRACT_PARSING_ERROR;
+        case TX_FIELD_SIGNER_GROUPS_LENGTH:
+            return SIGNER_ALLOWED_GROUPS_LENGTH_PARSING_ERROR;
+        case TX_FIELD_ATTRIBUTES_LENGTH:
+            return ATTRIBUTES_LENGTH_PARSING_ERROR;
+        case TX_FIELD_ATTRIBUTE:
+            return ATTRIBUTES_UNSUPPORTED_TYPE;
+        case TX_FIELD_SCRIPT_LENGTH:
+            return SCRIPT_LENGTH_PARSING_ERROR;
+        case TX_FIELD_SCRIPT:
+            return SCRIPT_LENGTH_VALUE_ERROR;  // requesting more data than available
+        case TX_FIELD_DONE:
+            return PARSING_OK;
     }
 
-    tx->script = (uint8_t *) (buf->ptr + buf->offset);
-    if (script_length > 0xFFFF || script_length == 0 || !buffer_seek_cur(buf, script_length)) {
-        return SCRIPT_LENGTH_VALUE_ERROR;
+    return INVALID_LENGTH_ERROR;
+}
+
+uint16_t transaction_script_pending(const tx_parser_t *parser, const transaction_t *tx) {
+    if (parser->field != TX_FIELD_SCRIPT) {
+        return 0;
     }
-    tx->script_size = (uint16_t) script_length;
-
-    // test if script is NEO or GAS transfer
-    buffer_t scriptBuf = {.ptr = tx->script, .size = script_length, .offset = 0};
-    try_parse_transfer_script(&scriptBuf, tx);
-    if (!tx->is_system_asset_transfer) {
-        // reset offset to start script dissection from the start
-        scriptBuf.offset = 0;
-        try_parse_vote_script(&scriptBuf, tx);
+    return tx->script_size - parser->script_read;
+}
+
+parser_status_e transaction_deserialize(buffer_t *buf, transaction_t *tx) {
+    tx_parser_t parser;
+
+    transaction_parser_init(&parser, tx);
+
+    parser_status_e status = transaction_parse_chunk(&parser, buf, tx);
+    if (status != PARSING_OK) {
+        return status;
     }
 
-    return (buf->offset == buf->size) ? PARSING_OK : INVALID_LENGTH_ERROR;
+    return transaction_parse_finish(&parser);
 }
@@ -3,6 +3,58 @@
 #include "types.h"
 #include "common/buffer.h"
 
+/**
+ * Prepare the streaming parser for a new transaction.
+ *
+ * @param[out] parser
+ *   Pointer to parser state.
+ * @param[out] tx
+ *   Pointer to transaction structure, cleared.
+ *
+ */
+void transaction_parser_init(tx_parser_t *parser, transaction_t *tx);
+
+/**
+ * Feed the next part of a serialized transaction to the streaming parser.
+ * Fields may be split at any byte over consecutive chunks, only the fields needed for review are kept in 'tx'.
+ *
+ * @param[in, out] parser
+ *   Pointer to parser state.
+ * @param[in, out] buf
+ *   Pointer to buffer with the next chunk of the serialized transaction, fully consumed on success.
+ * @param[out]     tx
+ *   Pointer to transaction structure.
+ *
+ * @return PARSING_OK if the chunk was consumed, error status otherwise.
+ *
+ */
+parser_status_e transaction_parse_chunk(tx_parser_t *parser, buffer_t *buf, transaction_t *tx);
+
+/**
+ * Check that the transaction is complete once its last chunk has been fed.
+ *
+ * @param[in] parser
+ *   Pointer to parser state.
+ *
+ * @return PARSING_OK if the whole transaction was parsed, the parsing error of the incomplete field otherwise.
+ *
+ */
+parser_status_e transaction_parse_finish(const tx_parser_t *parser);
+
+/**
+ * Number of script bytes still to be received, once every field before the script has been parsed.
+ *
+ * @param[in] parser
+ *   Pointer to parser state.
+ * @param[in] tx
+ *   Pointer to transaction structure.
+ *
+ * @return number of script bytes expected in the next chunks, 0 if the script length has not been parsed yet or if
+ * the whole script has been received.
+ *
+ */
+uint16_t transaction_script_pending(const tx_parser_t *parser, const transaction_t *tx);
+
 /**
  * Deserialize raw transaction in structure.
  *
@@ -0,0 +1,130 @@
+#include <string.h>  // memcpy, memset
+
+#include "expander.h"
+
+/**
+ * Static dictionary, the entries one after the other.
+ * Entries are never removed nor reordered: hosts refer to them by index. tests/apps/tx_compression.py holds the
+ * same table.
+ */
+// clang-format off
+static const uint8_t DICTIONARY[] = {
+    // 0: NEO contract script hash
+    0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e, 0x05,
+    0xc4, 0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef,
+    // 1: GAS contract script hash
+    0xcf, 0x76, 0xe2, 0x8b, 0xd0, 0x06, 0x2c, 0x4a, 0x47, 0x8e,
+    0xe3, 0x55, 0x61, 0x01, 0x13, 0x19, 0xf3, 0xcf, 0xa4, 0xd2,
+    // 2: PUSH4 PACK PUSH15 PUSHDATA1 "transfer" PUSHDATA1 <20 bytes>, followed by the contract
+    0x14, 0xc0, 0x1f, 0x0c, 0x08, 't', 'r', 'a', 'n', 's', 'f', 'e', 'r', 0x0c, 0x14,
+    // 3: PUSH2 PACK PUSH15 PUSHDATA1 "vote" PUSHDATA1 <20 bytes>, followed by the contract
+    0x12, 0xc0, 0x1f, 0x0c, 0x04, 'v', 'o', 't', 'e', 0x0c, 0x14,
+    // 4: SYSCALL System.Contract.Call
+    0x41, 0x62, 0x7d, 0x5b, 0x52,
+};
+// clang-format on
+
+/**
+ * Offset of each entry in DICTIONARY, plus the end of the last one.
+ */
+static const uint8_t DICTIONARY_OFFSETS[] = {0, 20, 40, 55, 66, 71};
+
+#define DICTIONARY_SIZE (sizeof(DICTIONARY_OFFSETS) - 1)
+
+_Static_assert(DICTIONARY_SIZE <= EXPAND_TOKEN_BACK_REFERENCE - EXPAND_TOKEN_DICTIONARY,
+               "Too many dictionary entries for the token space!");
+_Static_assert(MAX_EXPAND_VALUES <= EXPAND_TOKEN_VALUE - EXPAND_TOKEN_BACK_REFERENCE,
+               "Too many back-references for the token space!");
+
+void tx_expander_init(tx_expander_t *expander) {
+    memset(expander, 0, sizeof(*expander));
+    expander->mode = EXPAND_MODE_TOKEN;
+}
+
+/**
+ * Expansion of a token which is not followed by data, NULL if the token is invalid.
+ */
+static const uint8_t *get_expansion(const tx_expander_t *expander, uint8_t token, size_t *len) {
+    if (token >= EXPAND_TOKEN_DICTIONARY && token < EXPAND_TOKEN_DICTIONARY + DICTIONARY_SIZE) {
+        const size_t index = token - EXPAND_TOKEN_DICTIONARY;
+
+        *len = DICTIONARY_OFFSETS[index + 1] - DICTIONARY_OFFSETS[index];
+        return &DICTIONARY[DICTIONARY_OFFSETS[index]];
+    }
+    if (token >= EXPAND_TOKEN_BACK_REFERENCE && token < EXPAND_TOKEN_BACK_REFERENCE + expander->values_size) {
+        *len = UINT160_LEN;
+        return expander->values[token - EXPAND_TOKEN_BACK_REFERENCE];
+    }
+    return NULL;
+}
+
+parser_status_e tx_expand(tx_expander_t *expander, buffer_t *in, uint8_t *out, size_t out_size, size_t *out_len) {
+    size_t len = 0;
+
+    while (in->offset < in->size) {
+        if (expander->mode == EXPAND_MODE_TOKEN) {
+            const uint8_t token = in->ptr[in->offset];
+
+            if (token <= EXPAND_TOKEN_LITERAL_LAST) {
+                expander->mode = EXPAND_MODE_LITERAL;
+                expander->remaining = token + 1;
+            } else if (token == EXPAND_TOKEN_VALUE) {
+                if (expander->values_size == MAX_EXPAND_VALUES) {
+                    return COMPRESSED_DATA_ERROR;
+                }
+                expander->mode = EXPAND_MODE_VALUE;
+                expander->remaining = UINT160_LEN;
+            } else {
+                size_t expansion_len = 0;
+                const uint8_t *expansion = get_expansion(expander, token, &expansion_len);
+
+                if (expansion == NULL) {
+                    return COMPRESSED_DATA_ERROR;
+                }
+                if (out_size - len < expansion_len) {
+                    break;  // expanded with the next call
+                }
+                memcpy(out + len, expansion, expansion_len);
+                len += expansion_len;
+            }
+            in->offset++;
+            continue;
+        }
+
+        // literal run or remembered value, copied as far as the input and the output allow
+        size_t n = expander->remaining;
+        if (n > in->size - in->offset) {
+            n = in->size - in->offset;
+        }
+        if (n > out_size - len) {
+            n = out_size - len;
+        }
+        if (n == 0) {
+            break;  // output full
+        }
+
+        memcpy(out + len, in->ptr + in->offset, n);
+        if (expander->mode == EXPAND_MODE_VALUE) {
+            memcpy(&expander->values[expander->values_size][UINT160_LEN - expander->remaining],
+                   in->ptr + in->offset,
+                   n);
+        }
+        in->offset += n;
+        len += n;
+        expander->remaining -= n;
+
+        if (expander->remaining == 0) {
+            if (expander->mode == EXPAND_MODE_VALUE) {
+                expander->values_size++;
+            }
+            expander->mode = EXPAND_MODE_TOKEN;
+        }
+    }
+
+    *out_len = len;
+    return PARSING_OK;
+}
+
+bool tx_expander_complete(const tx_expander_t *expander) {
+    return expander->mode == EXPAND_MODE_TOKEN;
+}
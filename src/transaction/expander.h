@@ -0,0 +1,62 @@
+#pragma once
+
+#include <stddef.h>   // size_t
+#include <stdbool.h>  // bool
+
+#include "transaction_types.h"
+#include "common/buffer.h"
+
+/**
+ * Tokens of the compressed transaction encoding, see doc/COMMANDS.md.
+ * The signed transaction is the expansion of the tokens, the encoding only changes what is sent over the wire.
+ */
+#define EXPAND_TOKEN_LITERAL_LAST    0x7F  // 0x00 to 0x7F: literal run of (token + 1) bytes
+#define EXPAND_TOKEN_DICTIONARY      0x80  // 0x80 to 0xBF: entry (token - 0x80) of the static dictionary
+#define EXPAND_TOKEN_BACK_REFERENCE  0xC0  // 0xC0 to 0xC7: value (token - 0xC0) remembered earlier
+#define EXPAND_TOKEN_VALUE           0xC8  // 20 bytes copied and remembered as the next value
+
+/**
+ * Longest expansion of a single token, the output of tx_expand() must hold at least that many bytes.
+ */
+#define EXPAND_MAX_TOKEN_LEN UINT160_LEN
+
+/**
+ * Prepare the expander for a new compressed transaction.
+ *
+ * @param[out] expander
+ *   Pointer to expander state.
+ *
+ */
+void tx_expander_init(tx_expander_t *expander);
+
+/**
+ * Expand the next part of a compressed transaction.
+ * Tokens may be split at any byte over consecutive chunks. Expansion stops when 'in' is consumed or 'out' is full,
+ * the caller feeds the output to the parser and calls again until 'in' is consumed.
+ *
+ * @param[in, out] expander
+ *   Pointer to expander state.
+ * @param[in, out] in
+ *   Pointer to buffer with the next chunk of the compressed transaction.
+ * @param[out]     out
+ *   Pointer to output buffer for the transaction bytes.
+ * @param[in]      out_size
+ *   Size of the output buffer, at least EXPAND_MAX_TOKEN_LEN.
+ * @param[out]     out_len
+ *   Number of transaction bytes written to 'out'.
+ *
+ * @return PARSING_OK if success, COMPRESSED_DATA_ERROR on an invalid token.
+ *
+ */
+parser_status_e tx_expand(tx_expander_t *expander, buffer_t *in, uint8_t *out, size_t out_size, size_t *out_len);
+
+/**
+ * Check that the compressed transaction doesn't end in the middle of a token.
+ *
+ * @param[in] expander
+ *   Pointer to expander state.
+ *
+ * @return true if the last token is complete, false otherwise.
+ *
+ */
+bool tx_expander_complete(const tx_expander_t *expander);
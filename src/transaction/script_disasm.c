@@ -0,0 +1,496 @@
+#include <stdio.h>   // snprintf
+#include <string.h>  // memset, memcpy
+
+#include "script_disasm.h"
+#include "common/format.h"
+#include "common/read.h"
+
+typedef enum {
+    OPERAND_NONE,
+    OPERAND_INTEGER,  /// little-endian signed integer of 'size' bytes: PUSHINT*, jump and call offsets
+    OPERAND_HEX,      /// 'size' raw bytes: slot indexes and counts, stack item types, method tokens
+    OPERAND_DATA,     /// PUSHDATA*, 'size' is the length of the little-endian data length
+    OPERAND_SYSCALL,  /// 4 bytes interop service id
+} operand_kind_e;
+
+/**
+ * Opcode, or range of opcodes named after the first one and their rank, e.g. PUSH0 to PUSH16.
+ */
+typedef struct {
+    uint8_t first;
+    uint8_t last;
+    uint8_t operand;  // operand_kind_e
+    uint8_t size;
+    char name[13];
+} opcode_info_t;
+
+typedef struct {
+    uint32_t id;     // first 4 bytes of the SHA256 of the full name, little-endian
+    char name[31];  // without the "System." prefix
+} syscall_info_t;
+
+#define OPCODE(op, name_)                      {(op), (op), OPERAND_NONE, 0, name_}
+#define OPCODE_OPERAND(op, name_, kind, size_) {(op), (op), (kind), (size_), name_}
+#define OPCODE_RANGE(first_, last_, name_)     {(first_), (last_), OPERAND_NONE, 0, name_}
+#define JUMP(op, name_)                        OPCODE_OPERAND(op, name_, OPERAND_INTEGER, 1), \
+                                               OPCODE_OPERAND((op) + 1, name_ "_L", OPERAND_INTEGER, 4)
+
+/**
+ * NeoVM instruction set, sorted by opcode for the binary search.
+ */
+static const opcode_info_t OPCODES[] = {
+    OPCODE_OPERAND(0x00, "PUSHINT8", OPERAND_INTEGER, 1),
+    OPCODE_OPERAND(0x01, "PUSHINT16", OPERAND_INTEGER, 2),
+    OPCODE_OPERAND(0x02, "PUSHINT32", OPERAND_INTEGER, 4),
+    OPCODE_OPERAND(0x03, "PUSHINT64", OPERAND_INTEGER, 8),
+    OPCODE_OPERAND(0x04, "PUSHINT128", OPERAND_INTEGER, 16),
+    OPCODE_OPERAND(0x05, "PUSHINT256", OPERAND_INTEGER, 32),
+    OPCODE(0x08, "PUSHT"),
+    OPCODE(0x09, "PUSHF"),
+    OPCODE_OPERAND(0x0A, "PUSHA", OPERAND_INTEGER, 4),
+    OPCODE(0x0B, "PUSHNULL"),
+    OPCODE_OPERAND(0x0C, "PUSHDATA1", OPERAND_DATA, 1),
+    OPCODE_OPERAND(0x0D, "PUSHDATA2", OPERAND_DATA, 2),
+    OPCODE_OPERAND(0x0E, "PUSHDATA4", OPERAND_DATA, 4),
+    OPCODE(0x0F, "PUSHM1"),
+    OPCODE_RANGE(0x10, 0x20, "PUSH"),
+    OPCODE(0x21, "NOP"),
+    JUMP(0x22, "JMP"),
+    JUMP(0x24, "JMPIF"),
+    JUMP(0x26, "JMPIFNOT"),
+    JUMP(0x28, "JMPEQ"),
+    JUMP(0x2A, "JMPNE"),
+    JUMP(0x2C, "JMPGT"),
+    JUMP(0x2E, "JMPGE"),
+    JUMP(0x30, "JMPLT"),
+    JUMP(0x32, "JMPLE"),
+    JUMP(0x34, "CALL"),
+    OPCODE(0x36, "CALLA"),
+    OPCODE_OPERAND(0x37, "CALLT", OPERAND_HEX, 2),
+    OPCODE(0x38, "ABORT"),
+    OPCODE(0x39, "ASSERT"),
+    OPCODE(0x3A, "THROW"),
+    OPCODE_OPERAND(0x3B, "TRY", OPERAND_HEX, 2),
+    OPCODE_OPERAND(0x3C, "TRY_L", OPERAND_HEX, 8),
+    JUMP(0x3D, "ENDTRY"),
+    OPCODE(0x3F, "ENDFINALLY"),
+    OPCODE(0x40, "RET"),
+    OPCODE_OPERAND(0x41, "SYSCALL", OPERAND_SYSCALL, 4),
+    OPCODE(0x43, "DEPTH"),
+    OPCODE(0x45, "DROP"),
+    OPCODE(0x46, "NIP"),
+    OPCODE(0x48, "XDROP"),
+    OPCODE(0x49, "CLEAR"),
+    OPCODE(0x4A, "DUP"),
+    OPCODE(0x4B, "OVER"),
+    OPCODE(0x4D, "PICK"),
+    OPCODE(0x4E, "TUCK"),
+    OPCODE(0x50, "SWAP"),
+    OPCODE(0x51, "ROT"),
+    OPCODE(0x52, "ROLL"),
+    OPCODE(0x53, "REVERSE3"),
+    OPCODE(0x54, "REVERSE4"),
+    OPCODE(0x55, "REVERSEN"),
+    OPCODE_OPERAND(0x56, "INITSSLOT", OPERAND_HEX, 1),
+    OPCODE_OPERAND(0x57, "INITSLOT", OPERAND_HEX, 2),
+    OPCODE_RANGE(0x58, 0x5E, "LDSFLD"),
+    OPCODE_OPERAND(0x5F, "LDSFLD", OPERAND_HEX, 1),
+    OPCODE_RANGE(0x60, 0x66, "STSFLD"),
+    OPCODE_OPERAND(0x67, "STSFLD", OPERAND_HEX, 1),
+    OPCODE_RANGE(0x68, 0x6E, "LDLOC"),
+    OPCODE_OPERAND(0x6F, "LDLOC", OPERAND_HEX, 1),
+    OPCODE_RANGE(0x70, 0x76, "STLOC"),
+    OPCODE_OPERAND(0x77, "STLOC", OPERAND_HEX, 1),
+    OPCODE_RANGE(0x78, 0x7E, "LDARG"),
+    OPCODE_OPERAND(0x7F, "LDARG", OPERAND_HEX, 1),
+    OPCODE_RANGE(0x80, 0x86, "STARG"),
+    OPCODE_OPERAND(0x87, "STARG", OPERAND_HEX, 1),
+    OPCODE(0x88, "NEWBUFFER"),
+    OPCODE(0x89, "MEMCPY"),
+    OPCODE(0x8B, "CAT"),
+    OPCODE(0x8C, "SUBSTR"),
+    OPCODE(0x8D, "LEFT"),
+    OPCODE(0x8E, "RIGHT"),
+    OPCODE(0x90, "INVERT"),
+    OPCODE(0x91, "AND"),
+    OPCODE(0x92, "OR"),
+    OPCODE(0x93, "XOR"),
+    OPCODE(0x97, "EQUAL"),
+    OPCODE(0x98, "NOTEQUAL"),
+    OPCODE(0x99, "SIGN"),
+    OPCODE(0x9A, "ABS"),
+    OPCODE(0x9B, "NEGATE"),
+    OPCODE(0x9C, "INC"),
+    OPCODE(0x9D, "DEC"),
+    OPCODE(0x9E, "ADD"),
+    OPCODE(0x9F, "SUB"),
+    OPCODE(0xA0, "MUL"),
+    OPCODE(0xA1, "DIV"),
+    OPCODE(0xA2, "MOD"),
+    OPCODE(0xA3, "POW"),
+    OPCODE(0xA4, "SQRT"),
+    OPCODE(0xA5, "MODMUL"),
+    OPCODE(0xA6, "MODPOW"),
+    OPCODE(0xA8, "SHL"),
+    OPCODE(0xA9, "SHR"),
+    OPCODE(0xAA, "NOT"),
+    OPCODE(0xAB, "BOOLAND"),
+    OPCODE(0xAC, "BOOLOR"),
+    OPCODE(0xB1, "NZ"),
+    OPCODE(0xB3, "NUMEQUAL"),
+    OPCODE(0xB4, "NUMNOTEQUAL"),
+    OPCODE(0xB5, "LT"),
+    OPCODE(0xB6, "LE"),
+    OPCODE(0xB7, "GT"),
+    OPCODE(0xB8, "GE"),
+    OPCODE(0xB9, "MIN"),
+    OPCODE(0xBA, "MAX"),
+    OPCODE(0xBB, "WITHIN"),
+    OPCODE(0xBE, "PACKMAP"),
+    OPCODE(0xBF, "PACKSTRUCT"),
+    OPCODE(0xC0, "PACK"),
+    OPCODE(0xC1, "UNPACK"),
+    OPCODE(0xC2, "NEWARRAY0"),
+    OPCODE(0xC3, "NEWARRAY"),
+    OPCODE_OPERAND(0xC4, "NEWARRAY_T", OPERAND_HEX, 1),
+    OPCODE(0xC5, "NEWSTRUCT0"),
+    OPCODE(0xC6, "NEWSTRUCT"),
+    OPCODE(0xC8, "NEWMAP"),
+    OPCODE(0xCA, "SIZE"),
+    OPCODE(0xCB, "HASKEY"),
+    OPCODE(0xCC, "KEYS"),
+    OPCODE(0xCD, "VALUES"),
+    OPCODE(0xCE, "PICKITEM"),
+    OPCODE(0xCF, "APPEND"),
+    OPCODE(0xD0, "SETITEM"),
+    OPCODE(0xD1, "REVERSEITEMS"),
+    OPCODE(0xD2, "REMOVE"),
+    OPCODE(0xD3, "CLEARITEMS"),
+    OPCODE(0xD4, "POPITEM"),
+    OPCODE(0xD8, "ISNULL"),
+    OPCODE_OPERAND(0xD9, "ISTYPE", OPERAND_HEX, 1),
+    OPCODE_OPERAND(0xDB, "CONVERT", OPERAND_HEX, 1),
+    OPCODE(0xE0, "ABORTMSG"),
+    OPCODE(0xE1, "ASSERTMSG"),
+};
+
+/**
+ * Interop services of the NeoVM, sorted by id for the binary search.
+ */
+static const syscall_info_t SYSCALLS[] = {
+    {0x028799CF, "Contract.CreateStandardAccount"},
+    {0x0388C3B7, "Runtime.GetTime"},
+    {0x09E9336A, "Contract.CreateMultisigAccount"},
+    {0x165DA144, "Contract.NativePostPersist"},
+    {0x1DBF54F3, "Iterator.Value"},
+    {0x27B3E756, "Crypto.CheckSig"},
+    {0x28A9DE6B, "Runtime.GetRandom"},
+    {0x3008512D, "Runtime.GetScriptContainer"},
+    {0x31E85D92, "Storage.Get"},
+    {0x38E2B4F9, "Runtime.GetEntryScriptHash"},
+    {0x3ADCD09E, "Crypto.CheckMultisig"},
+    {0x3C6E5339, "Runtime.GetCallingScriptHash"},
+    {0x43112784, "Runtime.GetInvocationCounter"},
+    {0x525B7D62, "Contract.Call"},
+    {0x616F0195, "Runtime.Notify"},
+    {0x677BF71A, "Contract.CallNative"},
+    {0x74A8FEDB, "Runtime.GetExecutingScriptHash"},
+    {0x813ADA95, "Contract.GetCallFlags"},
+    {0x84183FE6, "Storage.Put"},
+    {0x8B18F1AC, "Runtime.CurrentSigners"},
+    {0x8CEC27F8, "Runtime.CheckWitness"},
+    {0x8F800CB3, "Runtime.LoadScript"},
+    {0x93BCDB2E, "Contract.NativeOnPersist"},
+    {0x9647E7CF, "Runtime.Log"},
+    {0x9AB830DF, "Storage.Find"},
+    {0x9CED089C, "Iterator.Next"},
+    {0xA0387DE9, "Runtime.GetTrigger"},
+    {0xBC8C5AC3, "Runtime.BurnGas"},
+    {0xCE67F69B, "Storage.GetContext"},
+    {0xCED88814, "Runtime.GasLeft"},
+    {0xDC92494C, "Runtime.GetAddressVersion"},
+    {0xE0A0FBC5, "Runtime.GetNetwork"},
+    {0xE26BB4F6, "Storage.GetReadOnlyContext"},
+    {0xE9BF4C76, "Storage.AsReadOnly"},
+    {0xEDC5582F, "Storage.Delete"},
+    {0xF1354327, "Runtime.GetNotifications"},
+    {0xF6FC79B2, "Runtime.Platform"},
+};
+
+/**
+ * Instruction decoded from the raw script.
+ */
+typedef struct {
+    const opcode_info_t *info;
+    uint8_t opcode;
+    size_t operand_offset;
+    size_t operand_len;  // data length for PUSHDATA*, which may go beyond the retained prefix
+    size_t next;         // offset of the following instruction
+} instruction_t;
+
+static const opcode_info_t *find_opcode(uint8_t opcode) {
+    size_t low = 0;
+    size_t high = sizeof(OPCODES) / sizeof(OPCODES[0]);
+
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+
+        if (opcode < OPCODES[middle].first) {
+            high = middle;
+        } else if (opcode > OPCODES[middle].last) {
+            low = middle + 1;
+        } else {
+            return &OPCODES[middle];
+        }
+    }
+    return NULL;
+}
+
+static const syscall_info_t *find_syscall(uint32_t id) {
+    size_t low = 0;
+    size_t high = sizeof(SYSCALLS) / sizeof(SYSCALLS[0]);
+
+    while (low < high) {
+        const size_t middle = low + (high - low) / 2;
+
+        if (id < SYSCALLS[middle].id) {
+            high = middle;
+        } else if (id > SYSCALLS[middle].id) {
+            low = middle + 1;
+        } else {
+            return &SYSCALLS[middle];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Decode the instruction at 'offset'. Its opcode and operand must be retained, except the data of PUSHDATA* which
+ * only has to end within the script.
+ */
+static bool decode_instruction(const uint8_t *script,
+                               size_t len,
+                               size_t script_size,
+                               size_t offset,
+                               instruction_t *instruction) {
+    if (offset >= len) {
+        return false;
+    }
+
+    const opcode_info_t *info = find_opcode(script[offset]);
+    if (info == NULL) {
+        return false;
+    }
+
+    size_t operand_offset = offset + 1;
+    size_t operand_len = info->size;
+
+    if (info->operand == OPERAND_DATA) {
+        if (info->size > len - operand_offset) {
+            return false;
+        }
+        switch (info->size) {
+            case 1:
+                operand_len = script[operand_offset];
+                break;
+            case 2:
+                operand_len = read_u16_le(script, operand_offset);
+                break;
+            default:
+                operand_len = read_u32_le(script, operand_offset);
+                break;
+        }
+        operand_offset += info->size;
+        if (operand_len > script_size - operand_offset) {
+            return false;
+        }
+    } else if (operand_len > len - operand_offset) {
+        return false;
+    }
+
+    instruction->info = info;
+    instruction->opcode = script[offset];
+    instruction->operand_offset = operand_offset;
+    instruction->operand_len = operand_len;
+    instruction->next = operand_offset + operand_len;
+    return true;
+}
+
+/**
+ * Signed little-endian integer of 1 to 32 bytes in decimal.
+ */
+static bool format_integer(const uint8_t *operand, size_t size, char *out, size_t out_len) {
+    const bool negative = (operand[size - 1] & 0x80) != 0;
+    uint8_t bytes[UINT256_LIMBS * 4];
+    uint256_t value;
+
+    // sign extension to 256 bits, then the magnitude in two's complement
+    memset(bytes, negative ? 0xFF : 0x00, sizeof(bytes));
+    memcpy(bytes, operand, size);
+    uint32_t carry = negative ? 1 : 0;
+    for (size_t i = 0; i < UINT256_LIMBS; i++) {
+        uint32_t limb = read_u32_le(bytes, 4 * i);
+        if (negative) {
+            limb = ~limb + carry;
+            carry = (carry == 1 && limb == 0) ? 1 : 0;
+        }
+        value.limbs[i] = limb;
+    }
+
+    if (negative) {
+        if (out_len < 2) {
+            return false;
+        }
+        *out++ = '-';
+        out_len--;
+    }
+    return format_u256(out, out_len, &value);
+}
+
+/**
+ * Data in hex, truncated with its length if it doesn't fit or isn't entirely retained.
+ */
+static bool format_data(const uint8_t *data, size_t retained, size_t data_len, char *out, size_t out_len) {
+    char suffix[24];
+
+    if (retained == data_len && 2 * data_len < out_len) {
+        return format_hex(data, data_len, out, out_len) >= 0;
+    }
+
+    const int suffix_len = snprintf(suffix, sizeof(suffix), "... (%u bytes)", (unsigned) data_len);
+    if (suffix_len < 0 || (size_t) suffix_len >= out_len) {
+        return false;
+    }
+
+    size_t shown = (out_len - 1 - (size_t) suffix_len) / 2;
+    if (shown > retained) {
+        shown = retained;
+    }
+    format_hex(data, shown, out, out_len);
+    strncpy(out + 2 * shown, suffix, out_len - 2 * shown);
+    return true;
+}
+
+static bool format_instruction(const instruction_t *instruction,
+                               const uint8_t *script,
+                               size_t len,
+                               char *out,
+                               size_t out_len) {
+    const opcode_info_t *info = instruction->info;
+    const uint8_t *operand = script + instruction->operand_offset;
+    int written;
+
+    if (info->first != info->last) {
+        written = snprintf(out, out_len, "%s%d", info->name, instruction->opcode - info->first);
+    } else {
+        written = snprintf(out, out_len, "%s", info->name);
+    }
+    if (written < 0 || (size_t) written >= out_len) {
+        return false;
+    }
+    if (instruction->operand_len == 0) {
+        return true;
+    }
+    if ((size_t) written + 1 >= out_len) {
+        return false;
+    }
+
+    out[written++] = ' ';
+    out += written;
+    out_len -= written;
+
+    switch (info->operand) {
+        case OPERAND_INTEGER:
+            return format_integer(operand, instruction->operand_len, out, out_len);
+        case OPERAND_HEX:
+            return format_hex(operand, instruction->operand_len, out, out_len) >= 0;
+        case OPERAND_DATA: {
+            // the data may go beyond the retained prefix
+            size_t retained = len - instruction->operand_offset;
+            if (retained > instruction->operand_len) {
+                retained = instruction->operand_len;
+            }
+            return format_data(operand, retained, instruction->operand_len, out, out_len);
+        }
+        default: {  // OPERAND_SYSCALL
+            const syscall_info_t *syscall = find_syscall(read_u32_le(operand, 0));
+            if (syscall == NULL) {
+                return format_hex(operand, instruction->operand_len, out, out_len) >= 0;
+            }
+            written = snprintf(out, out_len, "System.%s", syscall->name);
+            return written >= 0 && (size_t) written < out_len;
+        }
+    }
+}
+
+void script_disasm_init(script_disasm_t *cursor) {
+    cursor->index = 0;
+    cursor->offset = 0;
+}
+
+/**
+ * Decode the instructions from the start of the script, as long as possible.
+ *
+ * @return offset of the first byte which was not decoded, 'script_size' if the whole script was.
+ */
+static size_t decode_all(const uint8_t *script, size_t len, size_t script_size, uint16_t *count) {
+    instruction_t instruction;
+    size_t offset = 0;
+
+    *count = 0;
+    while (decode_instruction(script, len, script_size, offset, &instruction)) {
+        offset = instruction.next;
+        (*count)++;
+    }
+    return offset;
+}
+
+uint16_t script_disasm_count(const uint8_t *script, size_t len, size_t script_size) {
+    uint16_t count;
+    const size_t offset = decode_all(script, len, script_size, &count);
+
+    // the bytes which were not decoded are summed up in a last item
+    return (offset < script_size) ? count + 1 : count;
+}
+
+size_t script_disasm_decoded_len(const uint8_t *script, size_t len, size_t script_size) {
+    uint16_t count;
+
+    return decode_all(script, len, script_size, &count);
+}
+
+bool script_disasm_format(script_disasm_t *cursor,
+                          const uint8_t *script,
+                          size_t len,
+                          size_t script_size,
+                          uint16_t index,
+                          char *out,
+                          size_t out_len) {
+    instruction_t instruction;
+
+    if (out_len == 0) {
+        return false;
+    }
+    memset(out, 0, out_len);
+
+    // instructions have variable lengths, going backward means decoding again from the start
+    if (index < cursor->index) {
+        script_disasm_init(cursor);
+    }
+    while (cursor->index < index) {
+        if (!decode_instruction(script, len, script_size, cursor->offset, &instruction)) {
+            return false;
+        }
+        cursor->offset = (uint16_t) instruction.next;
+        cursor->index++;
+    }
+
+    if (decode_instruction(script, len, script_size, cursor->offset, &instruction)) {
+        return format_instruction(&instruction, script, len, out, out_len);
+    }
+    if (cursor->offset >= script_size) {
+        return false;
+    }
+    const int written = snprintf(out, out_len, "%u more bytes not shown", (unsigned) (script_size - cursor->offset));
+    return written >= 0 && (size_t) written < out_len;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+
+/**
+ * Position in the disassembly of a script, the only state needed to page through it.
+ * The listing is never materialized: each item is decoded from the raw script when it is displayed.
+ */
+typedef struct {
+    uint16_t index;   // item the cursor is on
+    uint16_t offset;  // offset of its instruction in the script
+} script_disasm_t;
+
+/**
+ * Move the cursor to the first instruction.
+ *
+ * @param[out] cursor
+ *   Pointer to the cursor.
+ *
+ */
+void script_disasm_init(script_disasm_t *cursor);
+
+/**
+ * Number of items of the disassembly: one per decoded instruction, plus a last one for the bytes which were not
+ * decoded (beyond the retained prefix, after an unknown opcode or a truncated operand), if any.
+ *
+ * @param[in] script
+ *   Pointer to the retained prefix of the script.
+ * @param[in] len
+ *   Length of the retained prefix.
+ * @param[in] script_size
+ *   Full script size, 'len' or more.
+ *
+ * @return number of items.
+ *
+ */
+uint16_t script_disasm_count(const uint8_t *script, size_t len, size_t script_size);
+
+/**
+ * Number of bytes of the script decoded by the disassembly, from its start. The bytes after them are only summed up
+ * in the last item: they are signed without being shown.
+ *
+ * @param[in] script
+ *   Pointer to the retained prefix of the script.
+ * @param[in] len
+ *   Length of the retained prefix.
+ * @param[in] script_size
+ *   Full script size, 'len' or more.
+ *
+ * @return number of bytes, 'script_size' if the whole script is decoded.
+ *
+ */
+size_t script_disasm_decoded_len(const uint8_t *script, size_t len, size_t script_size);
+
+/**
+ * Format an item of the disassembly, e.g. "PUSHINT8 -5" or "SYSCALL System.Contract.Call".
+ *
+ * The cursor moves forward from its position, or restarts from the first instruction to go backward: the RAM cost
+ * doesn't depend on the script size.
+ *
+ * @param[in,out] cursor
+ *   Pointer to the cursor.
+ * @param[in] script
+ *   Pointer to the retained prefix of the script.
+ * @param[in] len
+ *   Length of the retained prefix.
+ * @param[in] script_size
+ *   Full script size, 'len' or more.
+ * @param[in] index
+ *   Item to format, below script_disasm_count().
+ * @param[out] out
+ *   Pointer to output string.
+ * @param[in] out_len
+ *   Length of output string.
+ *
+ * @return true if success, false otherwise.
+ *
+ */
+bool script_disasm_format(script_disasm_t *cursor,
+                          const uint8_t *script,
+                          size_t len,
+                          size_t script_size,
+                          uint16_t index,
+                          char *out,
+                          size_t out_len);
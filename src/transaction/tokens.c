@@ -0,0 +1,42 @@
+#include <stddef.h>  // size_t
+#include <string.h>  // memcmp
+
+#include "os.h"  // PIC
+
+#include "tokens.h"
+
+/**
+ * Known NEP-17 tokens, sorted by script hash for the binary search.
+ * Only add contracts of which the script hash has been checked on MainNet: the ticker is shown instead of the hash.
+ * Decimals are bounded by MAX_TOKEN_DECIMALS.
+ */
+// clang-format off
+static const token_info_t TOKENS[] = {
+    {{0xcf, 0x76, 0xe2, 0x8b, 0xd0, 0x06, 0x2c, 0x4a, 0x47, 0x8e,
+      0xe3, 0x55, 0x61, 0x01, 0x13, 0x19, 0xf3, 0xcf, 0xa4, 0xd2}, "GAS", 8},
+    {{0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e, 0x05,
+      0xc4, 0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef}, "NEO", 0},
+};
+// clang-format on
+
+const token_info_t *token_info_find(const uint8_t script_hash[static UINT160_LEN]) {
+    const token_info_t *tokens = (const token_info_t *) PIC(TOKENS);
+    size_t low = 0;
+    size_t high = sizeof(TOKENS) / sizeof(TOKENS[0]);
+
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        int cmp = memcmp(script_hash, tokens[middle].script_hash, UINT160_LEN);
+
+        if (cmp == 0) {
+            return &tokens[middle];
+        }
+        if (cmp < 0) {
+            high = middle;
+        } else {
+            low = middle + 1;
+        }
+    }
+
+    return NULL;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stdint.h>  // uint*_t
+
+#include "transaction_types.h"
+
+/**
+ * Maximum length of a token ticker, including the null terminator.
+ */
+#define MAX_TICKER_LEN 8
+
+/**
+ * Maximum number of decimals of a known token, sizes the amount formatting buffers.
+ */
+#define MAX_TOKEN_DECIMALS 18
+
+/**
+ * NEP-17 token with a known ticker and number of decimals.
+ */
+typedef struct {
+    uint8_t script_hash[UINT160_LEN];  // contract script hash, in the byte order of the scripts
+    char ticker[MAX_TICKER_LEN];
+    uint8_t decimals;
+} token_info_t;
+
+/**
+ * Look up a NEP-17 contract in the table of known tokens.
+ *
+ * @param[in] script_hash
+ *   Contract script hash, in the byte order of the scripts.
+ *
+ * @return pointer to the token information, NULL if the token is unknown.
+ *
+ */
+const token_info_t *token_info_find(const uint8_t script_hash[static UINT160_LEN]);
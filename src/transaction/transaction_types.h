@@ -4,40 +4,77 @@
 #include <stdint.h>   // uint*_t
 #include <stdbool.h>  // bool
 
+#include "common/format.h"  // uint256_t
+
 #define ADDRESS_LEN 34  // base58 encoded address size
 #define UINT160_LEN 20
 #define ECPOINT_LEN 33
 
 /**
- * Maximum signer_t count in a transaction.
- * Actual network value is 16, we limit it because we run out of SRAM
+ * Maximum signer_t count in a transaction, same as the network.
  * The individual signers must be unique as compared by the account field.
  */
-#define MAX_TX_SIGNERS 2
+#define MAX_TX_SIGNERS 16
 /**
  * The minimum number of signers. First signer is always the sender of the tx
  */
 #define MIN_TX_SIGNERS 1
 /**
- * Limits the maximum 'allowed_groups' of a signer_t
- * Actual network value is 16, we limit it because we run out of SRAM
+ * Limits the maximum 'allowed_groups' of a signer_t, same as the network. All signers share MAX_SIGNER_DATA_LEN
+ * though, which is the effective limit when several signers have groups.
  */
-#define MAX_SIGNER_ALLOWED_GROUPS 2
+#define MAX_SIGNER_ALLOWED_GROUPS 16
 
 /**
- * Limits the maximum 'allowed_contracts' of a signer_t
- *
+ * Limits the maximum 'allowed_contracts' of a signer_t, same as the network. All signers share MAX_SIGNER_DATA_LEN
+ * though, which is the effective limit when several signers have contracts.
  */
 #define MAX_SIGNER_ALLOWED_CONTRACTS 16
 
 /**
- * The NEO network actually limits the attributes to (16 - signers count).
- * However, there currently only exist 2 attribute types, both can only be attached once
- * thus we limit the size to 2.
- *
- * The 16 magic is also reduced to 8 (see @MAX_TX_SIGNERS) due to SRAM limitation being reached.
+ * The NEO network limits the signers and attributes together to 16, so the attributes to (16 - signers count).
+ */
+#define MAX_ATTRIBUTES 16
+
+/**
+ * Size of the pool holding the allowed contracts and groups of all signers.
+ * The network limits would need 16 * (16 * 20 + 16 * 33) bytes, which is way beyond the available SRAM. Instead the
+ * lists are packed one after the other and a transaction is refused once they don't fit anymore: 20 bytes per
+ * contract plus 33 bytes per group, over all signers, may not exceed 528 bytes.
+ * Any single signer can use the network limits (16 contracts, or 16 groups), but not both at once. With 16 signers
+ * of one contract each, 6 groups are left for all of them.
+ */
+#define MAX_SIGNER_DATA_LEN (MAX_SIGNER_ALLOWED_GROUPS * ECPOINT_LEN)
+
+/**
+ * Number of leading script bytes kept after parsing.
+ * The script is streamed through the parser and only this prefix is retained. Standard scripts are recognized while
+ * they stream in, this prefix is not needed for that.
+ */
+#define MAX_SCRIPT_PREFIX_LEN 128
+
+/**
+ * Maximum number of NEP-17 transfer calls in a batched transfer script.
+ */
+#define MAX_TRANSFERS 8
+
+/**
+ * Maximum number of distinct tokens in a batched transfer script.
+ */
+#define MAX_TRANSFER_TOKENS 4
+
+/**
+ * Size of the pool holding the amounts of all transfer calls.
+ * An amount is kept as its PUSHINT operand, without the high zero bytes: 8 bytes on average leave room for 8
+ * transfers of up to 2^63 - 1, or for fewer transfers of larger amounts. A script whose amounts don't fit is not
+ * recognized as a transfer.
+ */
+#define MAX_TRANSFER_AMOUNTS_LEN (MAX_TRANSFERS * 8)
+
+/**
+ * Maximum script size as encoded in the transaction.
  */
-#define MAX_ATTRIBUTES 2
+#define MAX_SCRIPT_LEN 0xFFFF
 
 /**
  * Transaction parsing codes
@@ -70,7 +107,8 @@ typedef enum {
     ATTRIBUTES_UNSUPPORTED_TYPE = -24,
     ATTRIBUTES_DUPLICATE_TYPE = -25,
     SCRIPT_LENGTH_PARSING_ERROR = -26,
-    SCRIPT_LENGTH_VALUE_ERROR = -27  // requesting more data than available
+    SCRIPT_LENGTH_VALUE_ERROR = -27,  // requesting more data than available
+    COMPRESSED_DATA_ERROR = -28       // invalid token or truncated compressed transaction, see expander.h
 } parser_status_e;
 
 typedef enum {
@@ -82,24 +120,51 @@ typedef enum {
 } witness_scope_e;
 
 typedef struct {
-    uint8_t *account;  // UInt160, 20 bytes
-    witness_scope_e scope;
-    uint8_t *allowed_contracts[MAX_SIGNER_ALLOWED_CONTRACTS];  // array of UInt160s
+    uint8_t account[UINT160_LEN];
+    uint8_t scope;  // witness_scope_e flags
     uint8_t allowed_contracts_size;
-    uint8_t *allowed_groups[MAX_SIGNER_ALLOWED_GROUPS];  // array of ECPoints in compressed format, 33 bytes
     uint8_t allowed_groups_size;
+    uint16_t allowed_contracts_offset;  // offset in transaction_t.signer_data of the UInt160s
+    uint16_t allowed_groups_offset;     // offset in transaction_t.signer_data of the ECPoints in compressed format
 } signer_t;
 
+/**
+ * Allowed contract 'index' of a signer, UINT160_LEN bytes.
+ */
+#define SIGNER_ALLOWED_CONTRACT(tx, signer, index) \
+    (&(tx)->signer_data[(signer)->allowed_contracts_offset + (index) * UINT160_LEN])
+
+/**
+ * Allowed group 'index' of a signer, ECPOINT_LEN bytes.
+ */
+#define SIGNER_ALLOWED_GROUP(tx, signer, index) \
+    (&(tx)->signer_data[(signer)->allowed_groups_offset + (index) * ECPOINT_LEN])
+
 typedef enum {
     HIGH_PRIORITY = 0x1,
     ORACLE_RESPONSE = 0x11  // do not support signing this
 } tx_attribute_type_e;
 
 typedef struct {
-    tx_attribute_type_e type;
+    uint8_t type;  // tx_attribute_type_e
     // might expand this later if new attributes are introduced to have data beyond a type
 } attribute_t;
 
+/**
+ * One NEP-17 transfer call of the script.
+ */
+typedef struct {
+    uint8_t dst_script_hash[UINT160_LEN];  // destination, shown as an address
+    uint8_t token_index;                   // contract called, index in transaction_t.transfer_tokens
+    uint8_t amount_offset;                 // offset in transaction_t.transfer_amounts of the amount
+    uint8_t amount_len;                    // little-endian amount bytes, in the smallest unit of the token
+} transfer_t;
+
+/**
+ * Amount of a transfer, 'amount_len' bytes, see transfer_get_amount().
+ */
+#define TRANSFER_AMOUNT(tx, transfer) (&(tx)->transfer_amounts[(transfer)->amount_offset])
+
 typedef struct {
     uint8_t version;
     uint32_t nonce;
@@ -107,16 +172,126 @@ typedef struct {
     int64_t network_fee;
     uint32_t valid_until_block;
     signer_t signers[MAX_TX_SIGNERS];
-    uint8_t signers_size;  // the actual signers count after parsing
+    uint8_t signers_size;                      // the actual signers count after parsing
+    uint8_t signer_data[MAX_SIGNER_DATA_LEN];  // allowed contracts and groups of the signers, see signer_t
+    uint16_t signer_data_len;
     attribute_t attributes[MAX_ATTRIBUTES];
     uint8_t attributes_size;  // the actual attributes count after parsing
-    uint8_t *script;          // VM opcodes
-    uint16_t script_size;
-    bool is_system_asset_transfer;  // indicates if the instructions in `script` match a standard GAS or NEO transfer
-    bool is_neo;                    // indicates if 'transfer' is called on the NEO contract. False means GAS contract
-    int64_t amount;                 // transfer amount
-    uint8_t dst_address[ADDRESS_LEN];
+    uint8_t script[MAX_SCRIPT_PREFIX_LEN];  // first VM opcodes of the script
+    uint16_t script_size;                   // full script size, may exceed the retained prefix
+    bool is_token_transfer;  // indicates if the script is made of standard NEP-17 transfers only
+    transfer_t transfers[MAX_TRANSFERS];
+    uint8_t transfers_size;                              // the actual transfer calls count after parsing
+    uint8_t transfer_amounts[MAX_TRANSFER_AMOUNTS_LEN];  // amounts of the transfers, see transfer_t
+    uint8_t transfer_amounts_len;
+    uint8_t transfer_tokens[MAX_TRANSFER_TOKENS][UINT160_LEN];  // distinct contracts called, see token_info_find()
+    uint256_t transfer_totals[MAX_TRANSFER_TOKENS];            // sum of the amounts of each token
+    uint8_t transfer_tokens_size;
     bool is_vote_script;
     bool is_remove_vote;
     uint8_t vote_to[ECPOINT_LEN];
 } transaction_t;
+
+/**
+ * Offsets of the fields of the transaction header, which is followed by the signers.
+ */
+#define TX_OFFSET_NONCE             1
+#define TX_OFFSET_SYSTEM_FEE        5
+#define TX_OFFSET_NETWORK_FEE       13
+#define TX_OFFSET_VALID_UNTIL_BLOCK 21
+#define TX_HEADER_LEN               25
+
+/**
+ * Field of the serialized transaction the streaming parser is currently reading.
+ */
+typedef enum {
+    TX_FIELD_VERSION,
+    TX_FIELD_NONCE,
+    TX_FIELD_SYSTEM_FEE,
+    TX_FIELD_NETWORK_FEE,
+    TX_FIELD_VALID_UNTIL_BLOCK,
+    TX_FIELD_SIGNERS_LENGTH,
+    TX_FIELD_SIGNER_ACCOUNT,
+    TX_FIELD_SIGNER_SCOPE,
+    TX_FIELD_SIGNER_CONTRACTS_LENGTH,
+    TX_FIELD_SIGNER_CONTRACT,
+    TX_FIELD_SIGNER_GROUPS_LENGTH,
+    TX_FIELD_SIGNER_GROUP,
+    TX_FIELD_ATTRIBUTES_LENGTH,
+    TX_FIELD_ATTRIBUTE,
+    TX_FIELD_SCRIPT_LENGTH,
+    TX_FIELD_SCRIPT,
+    TX_FIELD_DONE
+} tx_field_e;
+
+/**
+ * Number of entries in the script template table of tx_utils.c.
+ */
+#define SCRIPT_TEMPLATES_COUNT 3
+
+/**
+ * Marks a template that can no longer match the script.
+ */
+#define SCRIPT_TEMPLATE_MISMATCH 0xFF
+
+/**
+ * Part of a NeoVM instruction the script matcher expects next.
+ */
+typedef enum {
+    MATCH_PHASE_OPCODE,   // next byte is an opcode
+    MATCH_PHASE_LENGTH,   // next byte is the length prefix of a PUSHDATA1 operand
+    MATCH_PHASE_OPERAND,  // next bytes are the operand of 'opcode'
+    MATCH_PHASE_DONE      // no template can match anymore, the rest of the script is ignored
+} script_match_phase_e;
+
+/**
+ * Resumable state of the script matcher, which compares the script against all templates at once while it streams
+ * in. Only the operand of the current instruction is buffered, the longest a template step accepts.
+ */
+typedef struct {
+    uint8_t phase;                          // script_match_phase_e
+    uint8_t opcode;                         // opcode of the current instruction
+    uint8_t operand_len;                    // operand length of the current instruction
+    uint8_t operand_read;                   // operand bytes received so far
+    uint8_t operand[ECPOINT_LEN];           // operand of the current instruction
+    uint8_t steps[SCRIPT_TEMPLATES_COUNT];    // next step of each template, or SCRIPT_TEMPLATE_MISMATCH
+    uint8_t repeats[SCRIPT_TEMPLATES_COUNT];  // times each template has been fully matched
+} script_matcher_t;
+
+/**
+ * Resumable state of the streaming transaction parser.
+ * Fixed size fields and varints that are split over two chunks are assembled in 'pending'.
+ */
+typedef struct {
+    tx_field_e field;          // field being parsed
+    uint8_t pending[9];        // partial field data, large enough for the biggest varint
+    uint8_t pending_len;       // bytes of the current field received so far
+    uint8_t index;             // current signer or attribute index
+    uint8_t item_index;        // current allowed contract or group index of the signer
+    uint16_t script_read;      // script bytes consumed so far
+    script_matcher_t matcher;  // recognition of the script while it is received
+} tx_parser_t;
+
+/**
+ * Number of 20-byte values a compressed transaction can refer back to.
+ */
+#define MAX_EXPAND_VALUES 8
+
+/**
+ * Part of a compressed transaction the expander expects next.
+ */
+typedef enum {
+    EXPAND_MODE_TOKEN,    // next byte is a token
+    EXPAND_MODE_LITERAL,  // next bytes are copied as is
+    EXPAND_MODE_VALUE     // next bytes are copied and remembered for later back-references
+} expand_mode_e;
+
+/**
+ * Resumable state of the expander of compressed transactions, tokens may be split over consecutive chunks.
+ */
+typedef struct {
+    uint8_t mode;         // expand_mode_e
+    uint8_t remaining;    // bytes of the current literal run or value still to be copied
+    uint8_t values_size;  // values remembered so far
+    uint8_t values[MAX_EXPAND_VALUES][UINT160_LEN];
+} tx_expander_t;
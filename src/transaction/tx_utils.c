@@ -1,176 +1,478 @@
 #include "tx_utils.h"
-#include "ui/utils.h"
 
+#include "os.h"  // PIC
+
+#include <assert.h>  // _Static_assert
 #include <string.h>
 
-typedef union {
-    uint8_t u8;
-    int8_t s8;
-    uint16_t u16;
-    int16_t s16;
-    int32_t s32;
-    int64_t s64;
-} data;
-data s;
-
-void try_parse_transfer_script(buffer_t *script, transaction_t *tx) {
-    if (!buffer_read_u8(script, &s.u8)) return;
-
-    // first byte should be 0xb (OpCode.PUSHNULL), indicating no data for the Nep17.transfer() 'data' argument
-    if (s.u8 != 0xB) return;
-
-    if (!buffer_read_u8(script, &s.u8)) return;
-
-    // OpCode.PUSH0 - OpCode.PUSH16
-    if (s.u8 >= 0x10 && s.u8 <= 0x20) {
-        tx->amount = (int64_t) s.u8 - 0x10;
-    } else if (s.u8 == 0x00) {  // OpCode.PUSHINT8
-        if (!buffer_read_s8(script, &s.s8)) return;
-        tx->amount = (int64_t) s.u8;
-    } else if (s.u8 == 0x01) {  // OpCode.PUSHINT16
-        if (!buffer_read_s16(script, &s.s16, LE)) return;
-        tx->amount = (int64_t) s.s16;
-    } else if (s.u8 == 0x2) {  // OpCode.PUSHINT32
-        if (!buffer_read_s32(script, &s.s32, LE)) return;
-        tx->amount = (int64_t) s.s32;
-    } else if (s.u8 == 0x3) {  // OpCode.PUSHINT64
-        if (!buffer_read_s64(script, &s.s64, LE)) return;
-        tx->amount = s.s64;
-    } else {  // we do not support INT128 and INT256 values on Ledger
-        return;
+/**
+ * NeoVM opcodes used by the templates.
+ */
+#define OPCODE_PUSHINT8   0x00
+#define OPCODE_PUSHINT256 0x05
+#define OPCODE_PUSHNULL   0x0B
+#define OPCODE_PUSHDATA1  0x0C
+#define OPCODE_PUSH0      0x10
+#define OPCODE_PUSH2      0x12
+#define OPCODE_PUSH4      0x14
+#define OPCODE_PUSH15     0x1F  /// CallFlags.All
+#define OPCODE_PUSH16     0x20
+#define OPCODE_SYSCALL    0x41
+#define OPCODE_PACK       0xC0
+
+/**
+ * What a template step accepts.
+ */
+typedef enum {
+    STEP_INSTRUCTION,  /// 'opcode' with an operand equal to one of the 'alternatives' operands of 'len' bytes
+    STEP_INTEGER,      /// any of PUSH0 to PUSH16 and PUSHINT8 to PUSHINT256
+    STEP_DATA          /// PUSHDATA1 of 'len' bytes
+} script_step_kind_e;
+
+/**
+ * Operand of a template step kept in the transaction once the step is matched.
+ */
+typedef enum {
+    CAPTURE_NONE,
+    CAPTURE_AMOUNT,   /// integer, amount of the current transfer
+    CAPTURE_DST,      /// 20 bytes, destination script hash of the current transfer
+    CAPTURE_TOKEN,    /// 20 bytes, script hash of the NEP-17 contract of the current transfer
+    CAPTURE_VOTE_TO,  /// 33 bytes, compressed public key voted for
+} script_capture_e;
+
+/**
+ * Review a fully matched template leads to.
+ */
+typedef enum {
+    SCRIPT_KIND_TRANSFER,
+    SCRIPT_KIND_VOTE,
+    SCRIPT_KIND_REMOVE_VOTE
+} script_kind_e;
+
+/**
+ * One instruction of a template.
+ */
+typedef struct {
+    uint8_t kind;             /// script_step_kind_e
+    uint8_t opcode;           /// STEP_INSTRUCTION only
+    uint8_t len;              /// operand length
+    uint8_t alternatives;     /// number of operands in 'operands', STEP_INSTRUCTION only
+    uint8_t capture;          /// script_capture_e
+    const uint8_t *operands;  /// 'alternatives' operands of 'len' bytes, one after the other
+} script_step_t;
+
+/**
+ * Instructions of a call pattern, which may be repeated.
+ */
+typedef struct {
+    const script_step_t *steps;
+    uint8_t steps_count;
+    uint8_t max_repeats;  /// times the steps may follow each other, 1 for a single call
+    uint8_t kind;         /// script_kind_e
+} script_template_t;
+
+static const uint8_t NEO_SCRIPT_HASH[] = {0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e, 0x05,
+                                          0xc4, 0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef};
+
+static const uint8_t METHOD_TRANSFER[] = {'t', 'r', 'a', 'n', 's', 'f', 'e', 'r'};
+static const uint8_t METHOD_VOTE[] = {'v', 'o', 't', 'e'};
+static const uint8_t SYSCALL_CONTRACT_CALL[] = {0x62, 0x7d, 0x5b, 0x52};  /// 'System.Contract.Call'
+
+#define OP(op) {.kind = STEP_INSTRUCTION, .opcode = (op)}
+#define OP_OPERAND(op, operand) OP_OPERANDS(op, operand, sizeof(operand), 1, CAPTURE_NONE)
+#define OP_OPERANDS(op, operands_, len_, count, capture_)                                                       \
+    {.kind = STEP_INSTRUCTION, .opcode = (op), .len = (len_), .alternatives = (count), .capture = (capture_), \
+     .operands = (operands_)}
+#define INTEGER(capture_)      {.kind = STEP_INTEGER, .capture = (capture_)}
+#define DATA(length, capture_) {.kind = STEP_DATA, .len = (length), .capture = (capture_)}
+
+/**
+ * Call of 'method' with the arguments pushed before, on the contract pushed by 'contract_step'.
+ */
+#define CONTRACT_CALL(push_arguments_count, method, contract_step)                                          \
+    OP(push_arguments_count), OP(OPCODE_PACK), OP(OPCODE_PUSH15), OP_OPERAND(OPCODE_PUSHDATA1, method), \
+        contract_step, OP_OPERAND(OPCODE_SYSCALL, SYSCALL_CONTRACT_CALL)
+
+/**
+ * NEP-17 transfer(from, to, amount, data) with null data, on any contract.
+ */
+static const script_step_t TRANSFER_STEPS[] = {
+    OP(OPCODE_PUSHNULL),
+    INTEGER(CAPTURE_AMOUNT),
+    DATA(UINT160_LEN, CAPTURE_DST),
+    DATA(UINT160_LEN, CAPTURE_NONE),  // from
+    CONTRACT_CALL(OPCODE_PUSH4, METHOD_TRANSFER, DATA(UINT160_LEN, CAPTURE_TOKEN)),
+};
+
+/**
+ * NEO vote(account, vote_to).
+ */
+static const script_step_t VOTE_STEPS[] = {
+    DATA(ECPOINT_LEN, CAPTURE_VOTE_TO),
+    DATA(UINT160_LEN, CAPTURE_NONE),  // account
+    CONTRACT_CALL(OPCODE_PUSH2, METHOD_VOTE, OP_OPERAND(OPCODE_PUSHDATA1, NEO_SCRIPT_HASH)),
+};
+
+/**
+ * NEO vote(account, null).
+ */
+static const script_step_t REMOVE_VOTE_STEPS[] = {
+    OP(OPCODE_PUSHNULL),
+    DATA(UINT160_LEN, CAPTURE_NONE),  // account
+    CONTRACT_CALL(OPCODE_PUSH2, METHOD_VOTE, OP_OPERAND(OPCODE_PUSHDATA1, NEO_SCRIPT_HASH)),
+};
+
+#define TEMPLATE(steps, max_repeats, kind) {steps, sizeof(steps) / sizeof(steps[0]), max_repeats, kind}
+
+/**
+ * Scripts with a dedicated review, by order of precedence.
+ * A new call pattern only needs a new entry here, matching cost doesn't depend on the template lengths.
+ */
+static const script_template_t SCRIPT_TEMPLATES[] = {
+    TEMPLATE(TRANSFER_STEPS, MAX_TRANSFERS, SCRIPT_KIND_TRANSFER),  // batches of transfers are concatenated calls
+    TEMPLATE(VOTE_STEPS, 1, SCRIPT_KIND_VOTE),
+    TEMPLATE(REMOVE_VOTE_STEPS, 1, SCRIPT_KIND_REMOVE_VOTE),
+};
+
+_Static_assert(sizeof(SCRIPT_TEMPLATES) / sizeof(SCRIPT_TEMPLATES[0]) == SCRIPT_TEMPLATES_COUNT,
+               "SCRIPT_TEMPLATES_COUNT must match the template table!");
+
+static const script_template_t *get_template(size_t index) {
+    return (const script_template_t *) PIC(&SCRIPT_TEMPLATES[index]);
+}
+
+/**
+ * Next step of template 'index', NULL if it already failed or is complete.
+ */
+static const script_step_t *get_step(const script_matcher_t *matcher, size_t index) {
+    const script_template_t *script_template = get_template(index);
+
+    if (matcher->steps[index] >= script_template->steps_count) {
+        return NULL;
     }
+    return (const script_step_t *) PIC(&script_template->steps[matcher->steps[index]]);
+}
 
-    // check for destination script hash
-    if (!buffer_read_u16(script, &s.u16, BE)) return;
-    if (s.u16 != 0x0C14) return;  // PUSHDATA1 , 20 bytes length for destination script hash
-
-    uint8_t *script_hash;
-    script_hash = (uint8_t *) (script->ptr + script->offset);
-    if (!buffer_seek_cur(script, UINT160_LEN)) return;
-
-    // parse and store destination address
-    script_hash_to_address((char *) tx->dst_address, sizeof(tx->dst_address), script_hash);
-
-    // check for source script hash
-    if (!buffer_read_u16(script, &s.u16, BE)) return;
-    if (s.u16 != 0x0C14) return;  // PUSHDATA1 , 20 bytes length for destination script hash
-    if (!buffer_seek_cur(script, UINT160_LEN)) return;
-
-    // clang-format off
-    uint8_t sequence[] = {
-        0x14,  // OpCode.PUSH4
-        0xC0,  // OpCode.PACK - we pack the 4 arguments to the transfer() method
-        0x1F,  // OpCode.PUSH15 - CallFlags
-        0x0C, 0x08,  // OpCode.PUSHDATA1, length 8 - contract method name
-        0x74, 0x72, 0x61, 0x6e, 0x73, 0x66, 0x65, 0x72,  // 'transfer'
-        0x0C, 0x14,  // OpCode.PUSHDATA1, length 20 - contract script hash
-    };
-
-    // we expect the above fixed sequence next
-    if (!buffer_can_read(script, sizeof(sequence))) return;
-    if (memcmp(script->ptr + script->offset, sequence, sizeof(sequence))) return;
-    buffer_seek_cur(script, sizeof(sequence));
-
-    // read contract script hash
-    // script_hash = (uint8_t *) (script->ptr + script->offset);
-    uint8_t neo_script_hash[] = {0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e, 0x05,
-                                 0xc4, 0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef};
-    uint8_t gas_script_hash[] = {0xcf, 0x76, 0xe2, 0x8b, 0xd0, 0x06, 0x2c, 0x4a, 0x47, 0x8e,
-                                 0xe3, 0x55, 0x61, 0x01, 0x13, 0x19, 0xf3, 0xcf, 0xa4, 0xd2};
-
-    if (!buffer_can_read(script, UINT160_LEN)) return;
-    if (!memcmp(script->ptr + script->offset, neo_script_hash, UINT160_LEN)) {
-        tx->is_neo = true;
-    } else if (memcmp(script->ptr + script->offset, gas_script_hash, UINT160_LEN)) {
-        // neither NEO or GAS, abort
-        return;
+/**
+ * Stop matching once no template is left.
+ */
+static void check_alive(script_matcher_t *matcher) {
+    for (size_t i = 0; i < SCRIPT_TEMPLATES_COUNT; i++) {
+        if (matcher->steps[i] != SCRIPT_TEMPLATE_MISMATCH) {
+            return;
+        }
     }
-    buffer_seek_cur(script, UINT160_LEN);
+    matcher->phase = MATCH_PHASE_DONE;
+}
 
-    // finally make sure we end with a contract syscall
+static bool is_integer_opcode(uint8_t opcode) {
+    // PUSHINT8 to PUSHINT256, then PUSH0 to PUSH16
+    return (opcode <= OPCODE_PUSHINT256) || (opcode >= OPCODE_PUSH0 && opcode <= OPCODE_PUSH16);
+}
 
-    // clang-format off
-    uint8_t sequence2[] = {
-        0x41,  // OpCode.SYSCALL
-        0x62, 0x7d, 0x5b, 0x52  // id 'System.Contract.Call'
-    };
+/**
+ * Keep the amount of the current transfer, the value pushed by an integer instruction. False if it is negative, or
+ * if it doesn't fit in transaction_t.transfer_amounts.
+ */
+static bool capture_amount(uint8_t opcode, const uint8_t *operand, transaction_t *tx) {
+    transfer_t *transfer = &tx->transfers[tx->transfers_size];
+    uint8_t value;
+    size_t len;
+
+    if (opcode >= OPCODE_PUSH0) {  // PUSH0 to PUSH16
+        value = opcode - OPCODE_PUSH0;
+        operand = &value;
+        len = 1;
+    } else {
+        // PUSHINT8 to PUSHINT256: two's complement little-endian operand of 1 to 32 bytes
+        len = (size_t) 1 << (opcode - OPCODE_PUSHINT8);
+        if ((operand[len - 1] & 0x80) != 0) {
+            return false;
+        }
+    }
 
-    if (!buffer_can_read(script, sizeof(sequence2))) return;
-    if (memcmp(script->ptr + script->offset, sequence2, sizeof(sequence2)) != 0) return;
-    buffer_seek_cur(script, sizeof(sequence2));
+    // only the significant bytes are kept
+    while (len > 0 && operand[len - 1] == 0) {
+        len--;
+    }
+    if (len > sizeof(tx->transfer_amounts) - tx->transfer_amounts_len) {
+        return false;
+    }
+    transfer->amount_offset = tx->transfer_amounts_len;
+    transfer->amount_len = (uint8_t) len;
+    memcpy(TRANSFER_AMOUNT(tx, transfer), operand, len);
+    tx->transfer_amounts_len += len;
+    return true;
+}
 
-    // make sure there is no extra code after the transfer script
-    if (script->offset != tx->script_size) return;
+void uint256_read_le(const uint8_t *bytes, size_t len, uint256_t *value) {
+    memset(value, 0, sizeof(*value));
+    for (size_t i = 0; i < len && i < UINT256_LIMBS * 4; i++) {
+        value->limbs[i / 4] |= (uint32_t) bytes[i] << (8 * (i % 4));
+    }
+}
 
-    // everything looks like a standard contract transfer for NEO/GAS and we were able to parse the amount + dst address
-    tx->is_system_asset_transfer = true;
+void transfer_get_amount(const transaction_t *tx, const transfer_t *transfer, uint256_t *amount) {
+    uint256_read_le(TRANSFER_AMOUNT(tx, transfer), transfer->amount_len, amount);
 }
 
-void try_parse_vote_script(buffer_t *script, transaction_t *tx) {
-    if (!buffer_read_u8(script, &s.u8)) return;
+bool uint256_add(uint256_t *sum, const uint256_t *value) {
+    uint256_t result;
+    uint64_t carry = 0;
 
-    // first byte should be 0xb (OpCode.PUSHNULL) when removing a vote, or 0x0C (OpCode.PUSHDATA1) followed by 0x21 (Length 33)
-    // indicating a 'vote_to' public key
-    if (s.u8 != 0xB && s.u8 != 0x0C) return;
-    
-    if (s.u8 == 0x0B) { // remove vote
-        tx->is_remove_vote = true;
-    } else { // add vote
-        if (!buffer_read_u8(script, &s.u8)) return;
-        if (s.u8 != 0x21) return; // PUSHDATA1 must be followed by 33 bytes of data for the compressed public key
+    for (size_t i = 0; i < UINT256_LIMBS; i++) {
+        carry += (uint64_t) sum->limbs[i] + value->limbs[i];
+        result.limbs[i] = (uint32_t) carry;
+        carry >>= 32;
+    }
+    if (carry != 0) {
+        return false;
+    }
+    *sum = result;
+    return true;
+}
 
-        uint8_t *public_key;
-        public_key = (uint8_t *) (script->ptr + script->offset);
-        if (!buffer_seek_cur(script, ECPOINT_LEN)) return;
+/**
+ * Record the contract of the current transfer and add its amount to the total of the token, which must fit in 256
+ * bits.
+ */
+static bool capture_token(const uint8_t *script_hash, transaction_t *tx) {
+    transfer_t *transfer = &tx->transfers[tx->transfers_size];
+    uint8_t index = 0;
 
-        // compressed public keys must start with 0x02 or 0x03
-        if (public_key[0] != 0x02 && public_key[0] != 0x03) return;
-        memcpy(tx->vote_to, public_key, ECPOINT_LEN);
-        tx->is_remove_vote = false;
+    while (index < tx->transfer_tokens_size && memcmp(tx->transfer_tokens[index], script_hash, UINT160_LEN) != 0) {
+        index++;
+    }
+    if (index == tx->transfer_tokens_size) {
+        if (tx->transfer_tokens_size == MAX_TRANSFER_TOKENS) {
+            return false;
+        }
+        memcpy(tx->transfer_tokens[index], script_hash, UINT160_LEN);
+        memset(&tx->transfer_totals[index], 0, sizeof(tx->transfer_totals[index]));
+        tx->transfer_tokens_size++;
     }
 
-    // check for source script hash
-    if (!buffer_read_u16(script, &s.u16, BE)) return;
-    if (s.u16 != 0x0C14) return;  // PUSHDATA1 , 20 bytes length for destination script hash
-    if (!buffer_seek_cur(script, UINT160_LEN)) return;
+    uint256_t amount;
+    transfer_get_amount(tx, transfer, &amount);
+    if (!uint256_add(&tx->transfer_totals[index], &amount)) {
+        return false;
+    }
 
-    // clang-format off
-    uint8_t sequence[] = {
-        0x12,  // OpCode.PUSH2
-        0xC0,  // OpCode.PACK - we pack the 2 arguments to the vote() method
-        0x1F,  // OpCode.PUSH15 - CallFlags
-        0x0C, 0x04,  // OpCode.PUSHDATA1, length 4 - contract method name
-        0x76, 0x6f, 0x74, 0x65,  // 'vote'
-        0x0C, 0x14,  // OpCode.PUSHDATA1, length 20 - contract script hash
-    };
+    transfer->token_index = index;
+    return true;
+}
 
-    // we expect the above fixed sequence next
-    if (!buffer_can_read(script, sizeof(sequence))) return;
-    if (memcmp(script->ptr + script->offset, sequence, sizeof(sequence))) return;
-    buffer_seek_cur(script, sizeof(sequence));
+static bool capture(uint8_t capture, const script_matcher_t *matcher, transaction_t *tx) {
+    // the transfer template can't be matched again once the array is full, see TEMPLATE()
+    transfer_t *transfer = &tx->transfers[tx->transfers_size];
+
+    switch (capture) {
+        case CAPTURE_AMOUNT:
+            // a negative amount can't be transferred
+            return capture_amount(matcher->opcode, matcher->operand, tx);
+        case CAPTURE_DST:
+            memcpy(transfer->dst_script_hash, matcher->operand, UINT160_LEN);
+            break;
+        case CAPTURE_TOKEN:
+            return capture_token(matcher->operand, tx);
+        case CAPTURE_VOTE_TO:
+            // compressed public keys must start with 0x02 or 0x03
+            if (matcher->operand[0] != 0x02 && matcher->operand[0] != 0x03) {
+                return false;
+            }
+            memcpy(tx->vote_to, matcher->operand, ECPOINT_LEN);
+            break;
+        default:
+            break;
+    }
+    return true;
+}
 
-    // read contract script hash
-    uint8_t neo_script_hash[] = {0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e, 0x05,
-                                 0xc4, 0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef};
+/**
+ * Template 'index' has been fully matched once more.
+ */
+static void complete_template(script_matcher_t *matcher, size_t index, transaction_t *tx) {
+    matcher->repeats[index]++;
+    if (get_template(index)->kind == SCRIPT_KIND_TRANSFER) {
+        tx->transfers_size++;
+    }
+}
+
+/**
+ * Keep the templates of which the next step accepts the opcode, or the PUSHDATA1 length once it is known.
+ */
+static void filter_templates(script_matcher_t *matcher, bool length_known) {
+    for (size_t i = 0; i < SCRIPT_TEMPLATES_COUNT; i++) {
+        const script_template_t *script_template = get_template(i);
+        bool accepted;
+
+        if (!length_known && matcher->steps[i] == script_template->steps_count) {
+            // complete and followed by more code, which may be another call
+            matcher->steps[i] = (matcher->repeats[i] < script_template->max_repeats) ? 0 : SCRIPT_TEMPLATE_MISMATCH;
+        }
+
+        const script_step_t *step = get_step(matcher, i);
+        if (step == NULL) {
+            matcher->steps[i] = SCRIPT_TEMPLATE_MISMATCH;
+            continue;
+        }
+        switch (step->kind) {
+            case STEP_INSTRUCTION:
+                accepted = (matcher->opcode == step->opcode);
+                break;
+            case STEP_INTEGER:
+                accepted = is_integer_opcode(matcher->opcode);
+                break;
+            default:  // STEP_DATA
+                accepted = (matcher->opcode == OPCODE_PUSHDATA1);
+                break;
+        }
+        if (accepted && length_known && step->kind != STEP_INTEGER) {
+            accepted = (matcher->operand_len == step->len);
+        }
+        if (!accepted) {
+            matcher->steps[i] = SCRIPT_TEMPLATE_MISMATCH;
+        }
+    }
+    check_alive(matcher);
+}
 
-    if (!buffer_can_read(script, UINT160_LEN)) return;
-    if (memcmp(script->ptr + script->offset, neo_script_hash, UINT160_LEN)) return;
-    buffer_seek_cur(script, UINT160_LEN);
+/**
+ * Advance the templates accepting the complete current instruction.
+ */
+static void end_instruction(script_matcher_t *matcher, transaction_t *tx) {
+    for (size_t i = 0; i < SCRIPT_TEMPLATES_COUNT; i++) {
+        const script_step_t *step = get_step(matcher, i);
+
+        if (step == NULL) {
+            continue;
+        }
+        if (step->kind == STEP_INSTRUCTION && step->alternatives > 0) {
+            size_t alternative = 0;
+            const uint8_t *operands = (const uint8_t *) PIC(step->operands);
+            while (alternative < step->alternatives &&
+                   memcmp(operands + alternative * step->len, matcher->operand, step->len) != 0) {
+                alternative++;
+            }
+            if (alternative == step->alternatives) {
+                matcher->steps[i] = SCRIPT_TEMPLATE_MISMATCH;
+                continue;
+            }
+        }
+        if (!capture(step->capture, matcher, tx)) {
+            matcher->steps[i] = SCRIPT_TEMPLATE_MISMATCH;
+            continue;
+        }
+        if (++matcher->steps[i] == get_template(i)->steps_count) {
+            complete_template(matcher, i, tx);
+        }
+    }
+    matcher->phase = MATCH_PHASE_OPCODE;
+    check_alive(matcher);
+}
+
+/**
+ * Decode the operand layout of a new instruction, accepted by at least one template.
+ */
+static void begin_instruction(script_matcher_t *matcher, transaction_t *tx) {
+    matcher->operand_read = 0;
+
+    if (matcher->opcode == OPCODE_PUSHDATA1) {
+        matcher->phase = MATCH_PHASE_LENGTH;
+        return;
+    }
+    if (matcher->opcode <= OPCODE_PUSHINT256) {  // PUSHINT8 to PUSHINT256
+        matcher->operand_len = 1 << (matcher->opcode - OPCODE_PUSHINT8);
+    } else if (matcher->opcode == OPCODE_SYSCALL) {
+        matcher->operand_len = sizeof(SYSCALL_CONTRACT_CALL);
+    } else {
+        matcher->operand_len = 0;
+    }
 
-    // finally make sure we end with a contract syscall
+    if (matcher->operand_len == 0) {
+        end_instruction(matcher, tx);
+    } else {
+        matcher->phase = MATCH_PHASE_OPERAND;
+    }
+}
 
-    // clang-format off
-    uint8_t sequence2[] = {
-        0x41,  // OpCode.SYSCALL
-        0x62, 0x7d, 0x5b, 0x52  // id 'System.Contract.Call'
-    };
+void script_matcher_init(script_matcher_t *matcher) {
+    memset(matcher, 0, sizeof(*matcher));
+    matcher->phase = MATCH_PHASE_OPCODE;
+}
 
-    if (!buffer_can_read(script, sizeof(sequence2))) return;
-    if (memcmp(script->ptr + script->offset, sequence2, sizeof(sequence2)) != 0) return;
-    buffer_seek_cur(script, sizeof(sequence2));
+void script_matcher_feed(script_matcher_t *matcher, const uint8_t *data, size_t len, transaction_t *tx) {
+    size_t offset = 0;
+
+    while (offset < len) {
+        switch (matcher->phase) {
+            case MATCH_PHASE_OPCODE:
+                matcher->opcode = data[offset++];
+                filter_templates(matcher, false);
+                if (matcher->phase != MATCH_PHASE_DONE) {
+                    begin_instruction(matcher, tx);
+                }
+                break;
+
+            case MATCH_PHASE_LENGTH:
+                matcher->operand_len = data[offset++];
+                // the surviving steps bound the length to the operand buffer
+                filter_templates(matcher, true);
+                if (matcher->phase == MATCH_PHASE_DONE) {
+                    break;
+                }
+                if (matcher->operand_len == 0) {
+                    end_instruction(matcher, tx);
+                } else {
+                    matcher->phase = MATCH_PHASE_OPERAND;
+                }
+                break;
+
+            case MATCH_PHASE_OPERAND: {
+                size_t n = matcher->operand_len - matcher->operand_read;
+                if (len - offset < n) {
+                    n = len - offset;
+                }
+                memcpy(matcher->operand + matcher->operand_read, data + offset, n);
+                matcher->operand_read += n;
+                offset += n;
+                if (matcher->operand_read == matcher->operand_len) {
+                    end_instruction(matcher, tx);
+                }
+                break;
+            }
+
+            default:  // MATCH_PHASE_DONE
+                return;
+        }
+    }
+}
 
-    // make sure there is no extra code after the vote script
-    if (script->offset != tx->script_size) return;
+void script_matcher_finish(const script_matcher_t *matcher, transaction_t *tx) {
+    if (matcher->phase != MATCH_PHASE_OPCODE) {
+        // no template left, or the script ends in the middle of an instruction
+        return;
+    }
 
-    tx->is_vote_script = true;
-}
\ No newline at end of file
+    for (size_t i = 0; i < SCRIPT_TEMPLATES_COUNT; i++) {
+        const script_template_t *script_template = get_template(i);
+
+        if (matcher->steps[i] != script_template->steps_count) {
+            continue;
+        }
+        switch (script_template->kind) {
+            case SCRIPT_KIND_TRANSFER:
+                tx->is_token_transfer = true;
+                break;
+            case SCRIPT_KIND_VOTE:
+                tx->is_vote_script = true;
+                tx->is_remove_vote = false;
+                break;
+            case SCRIPT_KIND_REMOVE_VOTE:
+                tx->is_vote_script = true;
+                tx->is_remove_vote = true;
+                break;
+        }
+        return;
+    }
+}
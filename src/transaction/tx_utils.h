@@ -1,6 +1,83 @@
-#include "common/buffer.h"
+#pragma once
+
+#include <stddef.h>   // size_t
+#include <stdint.h>   // uint*_t
+#include <stdbool.h>  // bool
+
 #include "types.h"
 
-void try_parse_transfer_script(buffer_t *script, transaction_t *tx);
+/**
+ * Prepare the script matcher for a new script.
+ *
+ * @param[out] matcher
+ *   Pointer to matcher state.
+ *
+ */
+void script_matcher_init(script_matcher_t *matcher);
+
+/**
+ * Feed the next bytes of the script to the matcher.
+ * Instructions may be split at any byte over consecutive calls. Operands captured by the templates (amount,
+ * destination, vote) are stored in 'tx' as they are decoded.
+ *
+ * @param[in, out] matcher
+ *   Pointer to matcher state.
+ * @param[in]      data
+ *   Pointer to the next script bytes.
+ * @param[in]      len
+ *   Number of script bytes.
+ * @param[out]     tx
+ *   Pointer to transaction structure.
+ *
+ */
+void script_matcher_feed(script_matcher_t *matcher, const uint8_t *data, size_t len, transaction_t *tx);
+
+/**
+ * Flag the script in 'tx' as the first template it fully matches, once all of it has been fed.
+ *
+ * @param[in]  matcher
+ *   Pointer to matcher state.
+ * @param[out] tx
+ *   Pointer to transaction structure.
+ *
+ */
+void script_matcher_finish(const script_matcher_t *matcher, transaction_t *tx);
+
+/**
+ * Add an amount to a total of 256 bits.
+ *
+ * @param[in, out] sum
+ *   Pointer to the total, left unchanged on overflow.
+ * @param[in]      value
+ *   Pointer to the amount to add.
+ *
+ * @return true if success, false on overflow.
+ *
+ */
+bool uint256_add(uint256_t *sum, const uint256_t *value);
+
+/**
+ * Read an unsigned little-endian integer of up to 32 bytes, as the amounts of the transfers are kept.
+ *
+ * @param[in]  bytes
+ *   Pointer to the integer bytes, least significant first.
+ * @param[in]  len
+ *   Number of bytes, 32 at most.
+ * @param[out] value
+ *   Pointer to the integer.
+ *
+ */
+void uint256_read_le(const uint8_t *bytes, size_t len, uint256_t *value);
 
-void try_parse_vote_script(buffer_t *script, transaction_t *tx);
\ No newline at end of file
+/**
+ * Amount of a transfer call, as kept in the transaction by the script matcher.
+ *
+ * @param[in]  tx
+ *   Pointer to transaction structure.
+ * @param[in]  transfer
+ *   Pointer to one of the transfers of 'tx'.
+ * @param[out] amount
+ *   Pointer to the amount, in the smallest unit of the token.
+ *
+ */
+void transfer_get_amount(const transaction_t *tx, const transfer_t *transfer, uint256_t *amount);
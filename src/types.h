@@ -6,6 +6,8 @@
 #include "constants.h"
 #include "transaction/transaction_types.h"
 
+#include "cx.h"  // cx_sha256_t
+
 /**
  * Enumeration for the status of IO.
  */
@@ -19,12 +21,27 @@ typedef enum {
  * Enumeration with expected INS of APDU commands.
  */
 typedef enum {
-    GET_APP_NAME = 0x0,    /// name of the application
-    GET_VERSION = 0x01,    /// version of the application
-    SIGN_TX = 0x02,        /// sign transaction with BIP44 path and return signature
-    GET_PUBLIC_KEY = 0x04  /// public key of corresponding BIP44 path and return uncompressed public key
+    GET_APP_NAME = 0x0,       /// name of the application
+    GET_VERSION = 0x01,       /// version of the application
+    SIGN_TX = 0x02,           /// sign transaction with BIP44 path and return signature
+    GET_PUBLIC_KEY = 0x04,    /// public key of corresponding BIP44 path and return uncompressed public key
+    GET_PUBLIC_KEYS = 0x05,   /// public keys of a range of address indexes, without confirmation
+    GET_ACCOUNT_XPUB = 0x06,  /// compressed public key and chain code of a BIP44 account
+    SIGN_TX_BATCH = 0x07,     /// sign several transactions with one review, same BIP44 path and network magic
+    RESIGN_TX = 0x08,         /// sign the last signed transaction again with new fees, nonce and validity
+    SIGN_SESSION = 0x09       /// sign transactions with the BIP44 path and network magic of an open session
 } command_e;
 
+/**
+ * Enumeration with the formats a public key can be returned in.
+ */
+typedef enum {
+    PUBKEY_FORMAT_UNCOMPRESSED = 0x00,  /// 0x04 followed by the x and y-coordinates (65 bytes)
+    PUBKEY_FORMAT_COMPRESSED = 0x01,    /// 0x02 or 0x03 followed by the x-coordinate (33 bytes)
+    PUBKEY_FORMAT_SCRIPT_HASH = 0x02,   /// script hash of the verification script (20 bytes)
+    PUBKEY_FORMAT_ADDRESS = 0x03        /// base58check encoded address (34 ASCII characters)
+} pubkey_format_e;
+
 /**
  * Structure with fields of APDU command.
  */
@@ -48,21 +65,97 @@ typedef enum {
     STATE_APPROVED   /// Transaction data approved
 } state_e;
 
+/**
+ * Progress of a review started before the last chunk of the transaction was received.
+ */
+typedef enum {
+    REVIEW_STREAM_NONE,       /// No review, or review started once the transaction was complete
+    REVIEW_STREAM_REVIEWING,  /// Header and signers displayed while the rest of the transaction is received
+    REVIEW_STREAM_WAITING,    /// Header and signers reviewed, waiting for the rest of the transaction
+    REVIEW_STREAM_REJECTED    /// Review rejected, the next chunk of the transaction is denied
+} review_stream_e;
+
 /**
  * Enumeration with user request type.
  */
 typedef enum {
-    CONFIRM_ADDRESS,     /// Confirm address derived from public key
-    CONFIRM_TRANSACTION  /// Confirm transaction information
+    CONFIRM_ADDRESS,      /// Confirm address derived from public key
+    CONFIRM_TRANSACTION,  /// Confirm transaction information
+    CONFIRM_BATCH         /// Confirm the summary of a batch of transactions
 } request_type_e;
 
+#ifdef HAVE_RESIGN_TX
+/**
+ * Transaction bytes kept after the header, so that RESIGN_TX can hash the transaction again with a new header.
+ * Longer transactions are not kept and can't be signed again. The tail shares its memory with the summaries of a
+ * batch, which are smaller: it is the largest member of that union.
+ */
+#define MAX_RESIGN_TAIL_LEN 1024
+
+/**
+ * Header fields changed by RESIGN_TX, bits of transaction_ctx_t.resign_changes.
+ */
+typedef enum {
+    RESIGN_FIELD_NONCE = 0x01,
+    RESIGN_FIELD_SYSTEM_FEE = 0x02,
+    RESIGN_FIELD_NETWORK_FEE = 0x04,
+    RESIGN_FIELD_VALID_UNTIL_BLOCK = 0x08
+} resign_field_e;
+#endif
+
+/**
+ * Maximum number of transactions in a batch, each one keeps a summary in RAM: 72 bytes with its amount. Except on
+ * Nano S, the summaries fit in the MAX_RESIGN_TAIL_LEN bytes they share with the tail of RESIGN_TX.
+ */
+#ifdef TARGET_NANOS
+#define MAX_BATCH_TXS 4
+#else
+#define MAX_BATCH_TXS 12
+#endif
+
+/**
+ * Size of the pool holding the amounts of the transactions of a batch, kept as in transaction_t.transfer_amounts:
+ * 8 bytes per transaction on average. A batch whose amounts don't fit is refused.
+ */
+#define MAX_BATCH_AMOUNTS_LEN (MAX_BATCH_TXS * 8)
+
+/**
+ * What is kept of a transaction of a batch once it is parsed: a single NEP-17 transfer.
+ */
+typedef struct {
+    uint8_t hash[32];                      /// Hash of the signed part of the transaction
+    uint64_t fees;                         /// System fee + network fee
+    uint8_t dst_script_hash[UINT160_LEN];  /// Destination of the transfer
+    uint8_t token_index;                   /// Token transferred, index in batch_ctx_t.tokens
+    uint8_t amount_offset;                 /// Offset in batch_ctx_t.amounts of the amount transferred
+    uint8_t amount_len;                    /// Little-endian amount bytes, in the smallest unit of the token
+} batch_tx_t;
+
+/**
+ * Structure for the context of a batch of transactions.
+ */
+typedef struct {
+    batch_tx_t txs[MAX_BATCH_TXS];
+    uint8_t amounts[MAX_BATCH_AMOUNTS_LEN];            /// Amounts of the transactions, see batch_tx_t
+    uint8_t amounts_len;
+    uint8_t signer[UINT160_LEN];                       /// Account of the single signer of every transaction
+    uint8_t tokens[MAX_TRANSFER_TOKENS][UINT160_LEN];  /// Distinct tokens transferred, see get_batch_token_total()
+    uint64_t fees;                                     /// Sum of the fees of all transactions
+    uint8_t tokens_size;
+    uint8_t count;     /// Number of transactions announced
+    uint8_t received;  /// Number of transactions received so far
+} batch_ctx_t;
+
 /**
  * Structure for transaction information context.
  */
 typedef struct {
-    uint8_t raw_tx[MAX_TRANSACTION_LEN];  /// Raw transaction serialized
-    size_t raw_tx_len;                    /// Length of raw transaction
-    transaction_t transaction;            /// Structured transaction
+    tx_parser_t parser;         /// Streaming parser state
+    uint32_t received;          /// Transaction bytes hashed and parsed so far
+    bool compressed;            /// Transaction chunks are sent compressed and expanded by 'expander'
+    tx_expander_t expander;     /// Expander state of a compressed transaction
+    transaction_t transaction;  /// Structured transaction
+    cx_sha256_t hash_ctx;       /// Running hash of the signed part, updated with each chunk
 
     /// Transaction hash digest
     /// This is just the hash of the tx signed data portion
@@ -70,18 +163,33 @@ typedef struct {
     uint8_t hash[32];                    /// as that also includes the network magic
     uint8_t signature[MAX_DER_SIG_LEN];  /// Transaction signature encoded in ASN1.DER
     uint8_t signature_len;               /// Length of transaction signature
+    union {
+#ifdef HAVE_RESIGN_TX
+        uint8_t tail[MAX_RESIGN_TAIL_LEN];  /// SIGN_TX: bytes after the header, kept for RESIGN_TX if they fit
+#endif
+        batch_ctx_t batch;  /// SIGN_TX_BATCH: summaries of the transactions received so far
+    };
+#ifdef HAVE_RESIGN_TX
+    uint8_t resign_changes;  /// Header fields changed by RESIGN_TX, resign_field_e bits
+#endif
 } transaction_ctx_t;
 
 /**
  * Structure for global context.
  */
 typedef struct {
-    state_e state;  /// State of the context
+    state_e state;                  /// State of the context
+    review_stream_e review_stream;  /// Review started while the transaction is still received
     union {
         uint8_t raw_public_key[64];  /// x-coordinate (32), y-coodinate (32)
         transaction_ctx_t tx_info;   /// Transaction context
     };
     uint32_t network_magic;
     request_type_e req_type;              /// User request
+    bool in_session;                      /// Transaction started by SIGN_SESSION, only it can send the next chunks
     uint32_t bip44_path[BIP44_PATH_LEN];  /// BIP44 path
+    /// Paths after bip44_path when SIGN_TX is given a list of paths, each one signs the same transaction
+    uint32_t other_bip44_paths[MAX_SIGN_TX_PATHS - 1][BIP44_PATH_LEN];
+    uint8_t bip44_paths_size;   /// Number of paths of a SIGN_TX list of paths, 0 for a single path
+    pubkey_format_e pk_format;  /// Response format of GET_PUBLIC_KEY
 } global_ctx_t;
@@ -23,6 +23,7 @@
 #include "io.h"
 #include "crypto.h"
 #include "globals.h"
+#include "sign_cache.h"
 #include "helper/send_response.h"
 
 void ui_action_validate_pubkey(bool approved, bool go_back_to_menu) {
@@ -37,11 +38,69 @@ void ui_action_validate_pubkey(bool approved, bool go_back_to_menu) {
     }
 }
 
+/**
+ * Signatures of the transaction with each BIP44 path of the list, each one preceded by its length.
+ */
+static void send_signatures(void) {
+    uint8_t resp[MAX_SIGN_TX_PATHS * (1 + MAX_DER_SIG_LEN)];
+    size_t offset = 0;
+
+    for (uint8_t i = 0; i < G_context.bip44_paths_size; i++) {
+        const uint32_t *path = (i == 0) ? G_context.bip44_path : G_context.other_bip44_paths[i - 1];
+
+        if (crypto_sign_tx_hash(path, G_context.tx_info.hash, resp + offset + 1, resp + offset) < 0) {
+            G_context.state = STATE_NONE;
+            io_send_sw(SW_SIGN_FAIL);
+            return;
+        }
+        sign_cache_add(G_context.network_magic, G_context.tx_info.hash, path, resp + offset + 1, resp[offset]);
+        offset += 1 + resp[offset];
+    }
+
+    io_send_response(&(const buffer_t){.ptr = resp, .size = offset, .offset = 0}, SW_OK);
+}
+
 void ui_action_validate_transaction(bool approved, bool go_back_to_menu) {
+    G_context.review_stream = REVIEW_STREAM_NONE;
+
+    if (approved) {
+        G_context.state = STATE_APPROVED;
+
+        if (G_context.bip44_paths_size > 0) {
+            send_signatures();
+        } else if (crypto_sign_tx() < 0) {
+            G_context.state = STATE_NONE;
+            io_send_sw(SW_SIGN_FAIL);
+        } else {
+            sign_cache_add(G_context.network_magic,
+                           G_context.tx_info.hash,
+                           G_context.bip44_path,
+                           G_context.tx_info.signature,
+                           G_context.tx_info.signature_len);
+            io_send_response(&(const buffer_t){.ptr = G_context.tx_info.signature,
+                                               .size = G_context.tx_info.signature_len,
+                                               .offset = 0},
+                             SW_OK);
+        }
+    } else {
+        G_context.state = STATE_NONE;
+        io_send_sw(SW_DENY);
+    }
+
+    if (go_back_to_menu) {
+        ui_menu_main();
+    }
+}
+
+void ui_action_validate_batch(bool approved, bool go_back_to_menu) {
     if (approved) {
         G_context.state = STATE_APPROVED;
 
-        if (crypto_sign_tx() < 0) {
+        // the signatures of the other transactions are requested one by one
+        if (crypto_sign_tx_hash(G_context.bip44_path,
+                                G_context.tx_info.batch.txs[0].hash,
+                                G_context.tx_info.signature,
+                                &G_context.tx_info.signature_len) < 0) {
             G_context.state = STATE_NONE;
             io_send_sw(SW_SIGN_FAIL);
         } else {
@@ -23,3 +23,14 @@ void ui_action_validate_pubkey(bool approved, bool go_back_to_menu);
  *
  */
 void ui_action_validate_transaction(bool approved, bool go_back_to_menu);
+
+/**
+ * Action for the validation of a batch of transactions.
+ *
+ * @param[in] approved
+ *   User approved or rejected.
+ * @param[in] go_back_to_menu
+ *   If the function must explicitly go back to the menu
+ *
+ */
+void ui_action_validate_batch(bool approved, bool go_back_to_menu);
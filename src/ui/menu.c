@@ -24,11 +24,22 @@
 #include "shared_context.h"
 #include "menu.h"
 #include "utils.h"
+#include "sign_cache.h"
+#include "sign_session.h"
 
 #ifdef HAVE_NBGL
 #include "nbgl_use_case.h"
 #endif
 
+/**
+ * Leave the app, the signatures and the signing session of this run are forgotten.
+ */
+static void quit_app(void) {
+    sign_cache_clear();
+    sign_session_close();
+    os_sched_exit(-1);
+}
+
 #ifdef HAVE_BAGL
 
 static void ui_menu_about();
@@ -40,7 +51,7 @@ UX_STEP_NOCB(ux_menu_ready_step, pn, {&C_badge_neo, "Wake up NEO.."});
 UX_STEP_NOCB(ux_menu_version_step, bn, {"Version", APPVERSION});
 UX_STEP_CB(ux_menu_settings_step, pb, display_settings(NULL), {&C_icon_eye, "Settings"});
 UX_STEP_CB(ux_menu_about_step, pb, ui_menu_about(), {&C_icon_certificate, "About"});
-UX_STEP_VALID(ux_menu_exit_step, pb, os_sched_exit(-1), {&C_icon_dashboard_x, "Quit"});
+UX_STEP_VALID(ux_menu_exit_step, pb, quit_app(), {&C_icon_dashboard_x, "Quit"});
 // FLOW for the main menu:
 // #1 screen: ready
 // #2 screen: version of the app
@@ -128,7 +139,7 @@ static const nbgl_contentInfoList_t infoList = {
 };
 
 static void quit_app_callback(void) {
-    os_sched_exit(-1);
+    quit_app();
 }
 
 // Settings
@@ -11,6 +11,7 @@
 #include "sw.h"
 #include "action/validate.h"
 #include "transaction/transaction_types.h"
+#include "transaction/tokens.h"
 #include "common/format.h"
 #include "utils.h"
 #include "menu.h"
@@ -30,38 +31,50 @@ enum e_state {
 };
 
 /**
- * Hold state around displaying Signers and their properties
+ * Parts of the flow made of dynamic screens, each between an upper and a lower delimiter step.
+ */
+enum e_region {
+    REGION_TRANSFERS,  // transfers and token totals of a batched transfer
+    REGION_SCRIPT,     // disassembly of an arbitrary script
+    REGION_SIGNERS,
+    REGION_BATCH,      // summary of a batch of transactions
+    REGION_RESIGN,     // review of RESIGN_TX: summary, changed header fields and warning
+};
+
+/**
+ * Hold state around displaying Signers and their properties, and the screens of batched transfers and scripts
  */
 typedef struct display_ctx_s {
     enum e_state current_state;  // screen state
-    int8_t s_index;              // track which signer is to be displayed
-    uint8_t p_index;             // track which signer property is displayed (see also: e_signer_state)
-    int8_t c_index;              // track which signer.contract is to be displayed
-    int8_t g_index;              // track which signer.group is to be displayed
+    int16_t b_index;             // track which screen of a batched transfer is displayed
+    int16_t d_index;             // track which screen of the script disassembly is displayed
+    int16_t s_index;             // track which signer screen is displayed, see get_signer_items_count()
+    int16_t t_index;             // track which screen of a batch of transactions is displayed
+    int16_t r_index;             // track which screen of the review of RESIGN_TX is displayed
 } display_ctx_t;
 
 static display_ctx_t display_ctx;
+static uint8_t script_items_nb;
+static uint8_t signer_items_nb;
 
 static void reset_signer_display_state() {
     display_ctx.current_state = STATIC_SCREEN;
-    display_ctx.s_index = 0;
-    display_ctx.g_index = -1;
-    display_ctx.c_index = -1;
-    display_ctx.p_index = 0;
+    display_ctx.b_index = -1;
+    display_ctx.d_index = -1;
+    display_ctx.s_index = -1;
+    display_ctx.t_index = -1;
+    display_ctx.r_index = -1;
 }
 
 /**
- * Hold current dynamic content around displaying Signers and their properties
+ * Hold current dynamic content around displaying Signers and their properties.
+ * g_text is also the scratch buffer the other review fields are formatted into when their step is displayed.
  */
 static char g_title[64];
-static char g_text[64];
+static char g_text[REVIEW_VALUE_MAX_SIZE];
 
 enum e_direction { DIRECTION_FORWARD, DIRECTION_BACKWARD };
 
-enum e_signer_state { START = 0, INDEX = 1, ACCOUNT = 2, SCOPE = 3, CONTRACTS = 4, GROUPS = 5, END = 6 };
-
-static enum e_signer_state signer_property[7] = {START, INDEX, ACCOUNT, SCOPE, CONTRACTS, GROUPS, END};
-
 const ux_flow_step_t *ux_display_transaction_flow[MAX_NUM_STEPS + 1];
 
 // This is a special function you must call for bnnn_paging to work properly in an edgecase.
@@ -73,150 +86,92 @@ static void bnnn_paging_edgecase(void) {
     ux_flow_relayout();
 }
 
-static void next_prop(void) {
-    uint8_t *idx = &display_ctx.p_index;
-    signer_t signer = G_context.tx_info.transaction.signers[display_ctx.s_index];
-
-    if (*idx < (uint8_t) CONTRACTS) (*idx)++;
-
-    if (signer_property[*idx] == CONTRACTS) {
-        // we start at -1
-        if (display_ctx.c_index + 1 < signer.allowed_contracts_size) {
-            display_ctx.c_index++;
-            return;  // let it display the contract
-        }
-        display_ctx.c_index++;
-        (*idx)++;  // advance state to GROUPS
-    }
-    if (signer_property[*idx] == GROUPS) {
-        // we start at -1
-        if (display_ctx.g_index + 1 < signer.allowed_groups_size) {
-            display_ctx.g_index++;
-            return;  // let it display the group
+/**
+ * Move to the next screen of a region of 'count' screens formatted by index, -1 and 'count' standing for its
+ * delimiters.
+ */
+static bool next_index(int16_t *index, int16_t count, enum e_direction direction) {
+    if (direction == DIRECTION_FORWARD) {
+        if (*index + 1 >= count) {
+            *index = count;
+            return false;
         }
-        display_ctx.g_index++;
-        (*idx)++;  // advance state to END
-    }
-
-    // if we displayed all properties of the current signer
-    if (signer_property[*idx] == END) {
-        // are there more signers?
-        if (display_ctx.s_index + 1 == G_context.tx_info.transaction.signers_size) {
-            // no more signers
-            return;
-        } else {
-            // more signers, advance signer index and reset some properties
-            display_ctx.s_index++;
-            display_ctx.c_index = -1;
-            display_ctx.g_index = -1;
-            *idx = (uint8_t) START;
-            next_prop();
+        (*index)++;
+    } else {
+        if (*index <= 0) {
+            *index = -1;
+            return false;
         }
+        (*index)--;
     }
+    return true;
 }
 
-static void prev_prop(void) {
-    uint8_t *idx = &display_ctx.p_index;
-    signer_t signer;
-
-    // from first dynamic screen, go back to first static
-    if (display_ctx.s_index == 0 && signer_property[*idx] == INDEX) {
-        *idx = (uint8_t) START;
-        return;
-    }
-
-    // from static screen below lower_delimiter screen, go to last dynamic
-    if (signer_property[*idx] == END) {
-        (*idx)--;  // reverse to GROUPS
+static bool get_next_transfers_data(enum e_direction direction) {
+    if (!next_index(&display_ctx.b_index, get_transfer_batch_items_count(), direction)) {
+        return false;
     }
+    format_transfer_batch_item(display_ctx.b_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
+    return true;
+}
 
-    if (signer_property[*idx] == GROUPS) {
-        if (display_ctx.g_index > 0) {
-            display_ctx.g_index--;
-            return;  // let it display the group
-        }
-        display_ctx.g_index--;  // make sure we end up at -1 as that is what next_prop() expects
-                                // when going forward
-        (*idx)--;               // advance state to CONTRACTS
+static bool get_next_script_data(enum e_direction direction) {
+    if (!next_index(&display_ctx.d_index, script_items_nb, direction)) {
+        return false;
     }
+    format_script_item(display_ctx.d_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
+    return true;
+}
 
-    if (signer_property[*idx] == CONTRACTS) {
-        if (display_ctx.c_index > 0) {
-            display_ctx.c_index--;
-            return;  // let it display the contract
-        }
-        display_ctx.c_index--;  // make sure we end up at -1 as that is what next_prop() expects
-                                // when going forward
-        // no need to reverse state to SCOPE, will be done on the next line
-    }
-    (*idx)--;
-
-    // we've exhausted all properties, check if there are more signers
-    if (signer_property[*idx] == START) {
-        if (display_ctx.s_index > 0) {
-            display_ctx.s_index--;
-            signer = G_context.tx_info.transaction.signers[display_ctx.s_index];
-            *idx = (uint8_t) END;  // set property index to end
-            display_ctx.g_index = signer.allowed_groups_size;
-            display_ctx.c_index = signer.allowed_contracts_size;
-            prev_prop();
-        }
+static bool get_next_signers_data(enum e_direction direction) {
+    if (!next_index(&display_ctx.s_index, signer_items_nb, direction)) {
+        return false;
     }
+    format_signer_item(display_ctx.s_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
+    return true;
 }
 
-static bool get_next_data(enum e_direction direction) {
-    if (direction == DIRECTION_FORWARD) {
-        next_prop();
-    } else {
-        prev_prop();
+static bool get_next_batch_data(enum e_direction direction) {
+    if (!next_index(&display_ctx.t_index, get_batch_items_count(), direction)) {
+        return false;
     }
+    format_batch_item(display_ctx.t_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
+    return true;
+}
 
-    signer_t s = G_context.tx_info.transaction.signers[display_ctx.s_index];
-    enum e_signer_state display = signer_property[display_ctx.p_index];
-
-    if (display_ctx.s_index == G_context.tx_info.transaction.signers_size &&
-        signer_property[display_ctx.p_index] == END) {
+#ifdef HAVE_RESIGN_TX
+static bool get_next_resign_data(enum e_direction direction) {
+    if (!next_index(&display_ctx.r_index, get_resign_items_count(), direction)) {
         return false;
     }
+    format_resign_item(display_ctx.r_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
+    return true;
+}
+#endif
 
-    switch (display) {
-        case START: {
-            return false;
-        }
-        case INDEX: {
-            format_signer(display_ctx.s_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
-            return true;
-        }
-        case ACCOUNT: {
-            format_account(&s, g_title, sizeof(g_title), g_text, sizeof(g_text));
-            return true;
-        }
-        case SCOPE: {
-            format_scope(&s, g_title, sizeof(g_title), g_text, sizeof(g_text));
-            return true;
-        }
-        case CONTRACTS: {
-            s = G_context.tx_info.transaction.signers[display_ctx.s_index];
-            format_contract(&s, display_ctx.c_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
-            return true;
-        }
-        case GROUPS: {
-            s = G_context.tx_info.transaction.signers[display_ctx.s_index];
-            format_group(&s, display_ctx.g_index, g_title, sizeof(g_title), g_text, sizeof(g_text));
-            return true;
-        }
-        case END: {
-            return false;
-        }
+static bool get_next_data(enum e_region region, enum e_direction direction) {
+    switch (region) {
+        case REGION_TRANSFERS:
+            return get_next_transfers_data(direction);
+        case REGION_SCRIPT:
+            return get_next_script_data(direction);
+        case REGION_BATCH:
+            return get_next_batch_data(direction);
+#ifdef HAVE_RESIGN_TX
+        case REGION_RESIGN:
+            return get_next_resign_data(direction);
+#endif
+        default:
+            return get_next_signers_data(direction);
     }
 }
 
 // Taken from Ledger's advanced display management docs
-static void display_next_state(bool is_upper_delimiter) {
+static void display_next_state(enum e_region region, bool is_upper_delimiter) {
     if (is_upper_delimiter) {  // We're called from the upper delimiter.
         if (display_ctx.current_state == STATIC_SCREEN) {
             // Fetch new data.
-            bool dynamic_data = get_next_data(DIRECTION_FORWARD);
+            bool dynamic_data = get_next_data(region, DIRECTION_FORWARD);
             if (dynamic_data) {
                 // We found some data to display so we now enter in dynamic mode.
                 display_ctx.current_state = DYNAMIC_SCREEN;
@@ -228,7 +183,7 @@ static void display_next_state(bool is_upper_delimiter) {
             // The previous screen was NOT a static screen, so we were already in a dynamic screen.
 
             // Fetch new data.
-            bool dynamic_data = get_next_data(DIRECTION_BACKWARD);
+            bool dynamic_data = get_next_data(region, DIRECTION_BACKWARD);
             if (dynamic_data) {
                 // We found some data so simply display it.
                 ux_flow_next();
@@ -245,7 +200,7 @@ static void display_next_state(bool is_upper_delimiter) {
         // We're called from the lower delimiter.
         if (display_ctx.current_state == STATIC_SCREEN) {
             // Fetch new data.
-            bool dynamic_data = get_next_data(DIRECTION_BACKWARD);
+            bool dynamic_data = get_next_data(region, DIRECTION_BACKWARD);
             if (dynamic_data) {
                 // We found some data to display so enter in dynamic mode.
                 display_ctx.current_state = DYNAMIC_SCREEN;
@@ -257,7 +212,7 @@ static void display_next_state(bool is_upper_delimiter) {
             // We're being called from a dynamic screen, so the user was already browsing the array.
 
             // Fetch new data.
-            bool dynamic_data = get_next_data(DIRECTION_FORWARD);
+            bool dynamic_data = get_next_data(region, DIRECTION_FORWARD);
             if (dynamic_data) {
                 // We found some data, so display it.
                 // Similar to `ux_flow_prev()` but updates layout to account for `bnnn_paging`'s
@@ -282,54 +237,69 @@ UX_STEP_NOCB(ux_display_review_step,
                  "Transaction",
              });
 
-UX_STEP_NOCB(ux_display_dst_address_step,
-             bnnn_paging,
-             {
-                 .title = "Destination addr",
-                 .text = G_tx.dst_address,
-             });
-
-UX_STEP_NOCB(ux_display_token_amount_step,
-             bnnn_paging,
-             {
-                 .title = "Token amount",
-                 .text = G_tx.token_amount,
-             });
-
-UX_STEP_NOCB(ux_display_systemfee_step,
-             bnnn_paging,
-             {
-                 .title = "System fee",
-                 .text = G_tx.system_fee,
-             });
-
-UX_STEP_NOCB(ux_display_network_step,
-             bnnn_paging,
-             {
-                 .title = "Target network",
-                 .text = G_tx.network,
-             });
-
-UX_STEP_NOCB(ux_display_networkfee_step,
-             bnnn_paging,
-             {
-                 .title = "Network fee",
-                 .text = G_tx.network_fee,
-             });
-
-UX_STEP_NOCB(ux_display_total_fee,
-             bnnn_paging,
-             {
-                 .title = "Total fees",
-                 .text = G_tx.total_fees,
-             });
-
-UX_STEP_NOCB(ux_display_validuntilblock_step,
-             bnnn_paging,
-             {
-                 .title = "Valid until height",
-                 .text = G_tx.valid_until_block,
-             });
+UX_STEP_NOCB_INIT(ux_display_dst_address_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_DST_ADDRESS, g_text, sizeof(g_text)),
+                  {
+                      .title = "Destination addr",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_token_amount_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_TOKEN_AMOUNT, g_text, sizeof(g_text)),
+                  {
+                      .title = "Token amount",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_token_contract_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_TOKEN_CONTRACT, g_text, sizeof(g_text)),
+                  {
+                      .title = "Token contract",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_systemfee_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_SYSTEM_FEE, g_text, sizeof(g_text)),
+                  {
+                      .title = "System fee",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_network_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_NETWORK, g_text, sizeof(g_text)),
+                  {
+                      .title = "Target network",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_networkfee_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_NETWORK_FEE, g_text, sizeof(g_text)),
+                  {
+                      .title = "Network fee",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_total_fee,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_TOTAL_FEES, g_text, sizeof(g_text)),
+                  {
+                      .title = "Total fees",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB_INIT(ux_display_validuntilblock_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_VALID_UNTIL_BLOCK, g_text, sizeof(g_text)),
+                  {
+                      .title = "Valid until height",
+                      .text = g_text,
+                  });
 
 UX_STEP_NOCB(
     ux_display_no_arbitrary_script_step,
@@ -347,17 +317,50 @@ UX_STEP_CB(ux_display_abort_step,
                "Understood, abort..",
            });
 
-UX_STEP_NOCB(ux_display_vote_to_step,
+UX_STEP_NOCB_INIT(ux_display_vote_to_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_VOTE_TO, g_text, sizeof(g_text)),
+                  {
+                      .title = "Casting vote for",
+                      .text = g_text,
+                  });
+
+UX_STEP_NOCB(ux_display_vote_retract_step, nn, {"Retracting vote", ""});
+
+UX_STEP_NOCB_INIT(ux_display_script_not_shown_step,
+                  bnnn_paging,
+                  format_review_field(REVIEW_FIELD_SCRIPT_NOT_SHOWN, g_text, sizeof(g_text)),
+                  {
+                      .title = "Warning",
+                      .text = g_text,
+                  });
+
+// 3 special steps for runtime dynamic screen generation, used to display the transfers of a batch
+UX_STEP_INIT(ux_transfers_upper_delimiter, NULL, NULL, { display_next_state(REGION_TRANSFERS, true); });
+
+UX_STEP_NOCB(ux_display_transfers_generic,
              bnnn_paging,
              {
-                 .title = "Casting vote for",
-                 .text = G_tx.vote_to,
+                 .title = g_title,
+                 .text = g_text,
              });
 
-UX_STEP_NOCB(ux_display_vote_retract_step, nn, {"Retracting vote", ""});
+UX_STEP_INIT(ux_transfers_lower_delimiter, NULL, NULL, { display_next_state(REGION_TRANSFERS, false); });
+
+// 3 special steps for runtime dynamic screen generation, used to display the disassembly of arbitrary scripts
+UX_STEP_INIT(ux_script_upper_delimiter, NULL, NULL, { display_next_state(REGION_SCRIPT, true); });
+
+UX_STEP_NOCB(ux_display_script_generic,
+             bnnn_paging,
+             {
+                 .title = g_title,
+                 .text = g_text,
+             });
+
+UX_STEP_INIT(ux_script_lower_delimiter, NULL, NULL, { display_next_state(REGION_SCRIPT, false); });
 
 // 3 special steps for runtime dynamic screen generation, used to display attached signers and their properties
-UX_STEP_INIT(ux_upper_delimiter, NULL, NULL, { display_next_state(true); });
+UX_STEP_INIT(ux_upper_delimiter, NULL, NULL, { display_next_state(REGION_SIGNERS, true); });
 
 UX_STEP_NOCB(ux_display_generic,
              bnnn_paging,
@@ -366,7 +369,7 @@ UX_STEP_NOCB(ux_display_generic,
                  .text = g_text,
              });
 
-UX_STEP_INIT(ux_lower_delimiter, NULL, NULL, { display_next_state(false); });
+UX_STEP_INIT(ux_lower_delimiter, NULL, NULL, { display_next_state(REGION_SIGNERS, false); });
 
 // Step with approve button
 UX_STEP_CB(ux_display_approve_step,
@@ -386,50 +389,162 @@ UX_STEP_CB(ux_display_reject_step,
                "Reject",
            });
 
-static void create_transaction_flow(void) {
-    uint8_t index = 0;
+UX_STEP_NOCB(ux_display_batch_review_step,
+             pnn,
+             {
+                 &C_icon_eye,
+                 "Review",
+                 "Batch",
+             });
 
-    reset_signer_display_state();
+// 3 special steps for runtime dynamic screen generation, used to display the summary of a batch
+UX_STEP_INIT(ux_batch_upper_delimiter, NULL, NULL, { display_next_state(REGION_BATCH, true); });
 
-    if (!G_context.tx_info.transaction.is_system_asset_transfer && !G_context.tx_info.transaction.is_vote_script &&
-        !N_storage.scriptsAllowed) {
-        ux_display_transaction_flow[index++] = &ux_display_no_arbitrary_script_step;
-        ux_display_transaction_flow[index++] = &ux_display_abort_step;
-        ux_display_transaction_flow[index++] = FLOW_END_STEP;
-        return;
-    }
+UX_STEP_NOCB(ux_display_batch_generic,
+             bnnn_paging,
+             {
+                 .title = g_title,
+                 .text = g_text,
+             });
 
-    ux_display_transaction_flow[index++] = &ux_display_review_step;
+UX_STEP_INIT(ux_batch_lower_delimiter, NULL, NULL, { display_next_state(REGION_BATCH, false); });
+
+UX_STEP_CB(ux_display_batch_approve_step,
+           pb,
+           ui_action_validate_batch(true, true),
+           {
+               &C_icon_validate_14,
+               "Approve",
+           });
+
+UX_STEP_CB(ux_display_batch_reject_step,
+           pb,
+           ui_action_validate_batch(false, true),
+           {
+               &C_icon_crossmark,
+               "Reject",
+           });
+
+#ifdef HAVE_RESIGN_TX
+UX_STEP_NOCB(ux_display_resign_review_step,
+             pnn,
+             {
+                 &C_icon_eye,
+                 "Review",
+                 "changes",
+             });
+
+// 3 special steps for runtime dynamic screen generation, used to display the review of RESIGN_TX
+UX_STEP_INIT(ux_resign_upper_delimiter, NULL, NULL, { display_next_state(REGION_RESIGN, true); });
+
+UX_STEP_NOCB(ux_display_resign_generic,
+             bnnn_paging,
+             {
+                 .title = g_title,
+                 .text = g_text,
+             });
+
+UX_STEP_INIT(ux_resign_lower_delimiter, NULL, NULL, { display_next_state(REGION_RESIGN, false); });
+#endif
+
+static void ui_action_reject_stream(void) {
+    reject_sign_tx_stream();
+    ui_menu_main();
+}
+
+// Step shown at the end of a streamed review until the script is received, see continue_sign_tx_stream_ui()
+UX_STEP_NOCB(ux_display_stream_wait_step,
+             pnn,
+             {
+                 &C_icon_processing,
+                 "Receiving",
+                 "transaction...",
+             });
+
+// Reject step of a streamed review, whose transaction may not be fully received yet
+UX_STEP_CB(ux_display_stream_reject_step,
+           pb,
+           ui_action_reject_stream(),
+           {
+               &C_icon_crossmark,
+               "Reject",
+           });
+
+// index of the first step depending on the script in a streamed review
+static uint8_t stream_script_index;
+
+static void add_refusal_steps(uint8_t *index) {
+    ux_display_transaction_flow[(*index)++] = &ux_display_no_arbitrary_script_step;
+    ux_display_transaction_flow[(*index)++] = &ux_display_abort_step;
+    ux_display_transaction_flow[(*index)++] = FLOW_END_STEP;
+}
 
+static void add_script_steps(uint8_t *index) {
     if (G_context.tx_info.transaction.is_vote_script) {
         if (G_context.tx_info.transaction.is_remove_vote) {
-            ux_display_transaction_flow[index++] = &ux_display_vote_retract_step;
+            ux_display_transaction_flow[(*index)++] = &ux_display_vote_retract_step;
         } else {
-            ux_display_transaction_flow[index++] = &ux_display_vote_to_step;
+            ux_display_transaction_flow[(*index)++] = &ux_display_vote_to_step;
         }
-    } else if (G_context.tx_info.transaction.is_system_asset_transfer) {
-        ux_display_transaction_flow[index++] = &ux_display_dst_address_step;
-        ux_display_transaction_flow[index++] = &ux_display_token_amount_step;
+    } else if (get_transfer_batch_items_count() > 0) {
+        ux_display_transaction_flow[(*index)++] = &ux_transfers_upper_delimiter;
+        ux_display_transaction_flow[(*index)++] = &ux_display_transfers_generic;
+        ux_display_transaction_flow[(*index)++] = &ux_transfers_lower_delimiter;
+    } else if (G_context.tx_info.transaction.is_token_transfer) {
+        ux_display_transaction_flow[(*index)++] = &ux_display_dst_address_step;
+        if (token_info_find(G_context.tx_info.transaction.transfer_tokens[0]) == NULL) {
+            ux_display_transaction_flow[(*index)++] = &ux_display_token_contract_step;
+        }
+        ux_display_transaction_flow[(*index)++] = &ux_display_token_amount_step;
+    } else if (script_items_nb > 0) {
+        ux_display_transaction_flow[(*index)++] = &ux_script_upper_delimiter;
+        ux_display_transaction_flow[(*index)++] = &ux_display_script_generic;
+        ux_display_transaction_flow[(*index)++] = &ux_script_lower_delimiter;
     }
+}
 
-    ux_display_transaction_flow[index++] = &ux_display_network_step;
-    ux_display_transaction_flow[index++] = &ux_display_systemfee_step;
-    ux_display_transaction_flow[index++] = &ux_display_networkfee_step;
-    ux_display_transaction_flow[index++] = &ux_display_total_fee;
-    ux_display_transaction_flow[index++] = &ux_display_validuntilblock_step;
+static void add_header_steps(uint8_t *index) {
+    ux_display_transaction_flow[(*index)++] = &ux_display_network_step;
+    ux_display_transaction_flow[(*index)++] = &ux_display_systemfee_step;
+    ux_display_transaction_flow[(*index)++] = &ux_display_networkfee_step;
+    ux_display_transaction_flow[(*index)++] = &ux_display_total_fee;
+    ux_display_transaction_flow[(*index)++] = &ux_display_validuntilblock_step;
 
     // special step that won't be shown, but used for runtime displaying
     // dynamics screens when applicable
-    ux_display_transaction_flow[index++] = &ux_upper_delimiter;
+    ux_display_transaction_flow[(*index)++] = &ux_upper_delimiter;
     // will be used to dynamically display Signers
-    ux_display_transaction_flow[index++] = &ux_display_generic;
+    ux_display_transaction_flow[(*index)++] = &ux_display_generic;
     // special step that won't be shown, but used for runtime displaying
     // dynamics screens when applicable
-    ux_display_transaction_flow[index++] = &ux_lower_delimiter;
+    ux_display_transaction_flow[(*index)++] = &ux_lower_delimiter;
+}
 
-    ux_display_transaction_flow[index++] = &ux_display_approve_step;
-    ux_display_transaction_flow[index++] = &ux_display_reject_step;
-    ux_display_transaction_flow[index++] = FLOW_END_STEP;
+static void add_validation_steps(uint8_t *index) {
+    if (script_items_nb > 0 && is_script_partly_shown()) {
+        ux_display_transaction_flow[(*index)++] = &ux_display_script_not_shown_step;
+    }
+    ux_display_transaction_flow[(*index)++] = &ux_display_approve_step;
+    ux_display_transaction_flow[(*index)++] = &ux_display_reject_step;
+    ux_display_transaction_flow[(*index)++] = FLOW_END_STEP;
+}
+
+static void create_transaction_flow(void) {
+    uint8_t index = 0;
+
+    reset_signer_display_state();
+    script_items_nb = get_script_items_count();
+    signer_items_nb = get_signer_items_count();
+
+    if (!is_script_allowed()) {
+        add_refusal_steps(&index);
+        return;
+    }
+
+    ux_display_transaction_flow[index++] = &ux_display_review_step;
+    add_script_steps(&index);
+    add_header_steps(&index);
+    add_validation_steps(&index);
 }
 
 void start_sign_tx_ui(void) {
@@ -439,4 +554,77 @@ void start_sign_tx_ui(void) {
     ux_flow_init(0, ux_display_transaction_flow, NULL);
 }
 
+void start_sign_tx_batch_ui(void) {
+    uint8_t index = 0;
+
+    reset_signer_display_state();
+
+    ux_display_transaction_flow[index++] = &ux_display_batch_review_step;
+    ux_display_transaction_flow[index++] = &ux_batch_upper_delimiter;
+    ux_display_transaction_flow[index++] = &ux_display_batch_generic;
+    ux_display_transaction_flow[index++] = &ux_batch_lower_delimiter;
+    ux_display_transaction_flow[index++] = &ux_display_batch_approve_step;
+    ux_display_transaction_flow[index++] = &ux_display_batch_reject_step;
+    ux_display_transaction_flow[index++] = FLOW_END_STEP;
+
+    ux_flow_init(0, ux_display_transaction_flow, NULL);
+}
+
+#ifdef HAVE_RESIGN_TX
+void start_resign_tx_ui(void) {
+    uint8_t index = 0;
+
+    reset_signer_display_state();
+
+    ux_display_transaction_flow[index++] = &ux_display_resign_review_step;
+    ux_display_transaction_flow[index++] = &ux_resign_upper_delimiter;
+    ux_display_transaction_flow[index++] = &ux_display_resign_generic;
+    ux_display_transaction_flow[index++] = &ux_resign_lower_delimiter;
+    ux_display_transaction_flow[index++] = &ux_display_approve_step;
+    ux_display_transaction_flow[index++] = &ux_display_reject_step;
+    ux_display_transaction_flow[index++] = FLOW_END_STEP;
+
+    ux_flow_init(0, ux_display_transaction_flow, NULL);
+}
+#endif
+
+void start_sign_tx_stream_ui(void) {
+    uint8_t index = 0;
+
+    reset_signer_display_state();
+    signer_items_nb = get_signer_items_count();
+
+    // the steps depending on the script replace the last two once it is received
+    ux_display_transaction_flow[index++] = &ux_display_review_step;
+    add_header_steps(&index);
+    stream_script_index = index;
+    ux_display_transaction_flow[index++] = &ux_display_stream_wait_step;
+    ux_display_transaction_flow[index++] = &ux_display_stream_reject_step;
+    ux_display_transaction_flow[index++] = FLOW_END_STEP;
+
+    ux_flow_init(0, ux_display_transaction_flow, NULL);
+}
+
+void continue_sign_tx_stream_ui(void) {
+    uint8_t index = stream_script_index;
+
+    // the steps already reviewed are kept as they are, the user can still go back to them
+    script_items_nb = get_script_items_count();
+    if (!is_script_allowed()) {
+        add_refusal_steps(&index);
+    } else {
+        add_script_steps(&index);
+        add_validation_steps(&index);
+    }
+
+    // move away from the replaced steps, the others read the updated flow when the user moves to the next step
+    if (G_ux.flow_stack[G_ux.stack_count - 1].index >= stream_script_index) {
+        ux_flow_init(0, ux_display_transaction_flow, ux_display_transaction_flow[stream_script_index]);
+    }
+}
+
+void abort_sign_tx_stream_ui(void) {
+    ui_menu_main();
+}
+
 #endif
@@ -1,5 +1,6 @@
 #include <stdbool.h>  // bool
 #include <string.h>   // memset
+#include <assert.h>   // _Static_assert
 
 #include "os.h"
 #include "ux.h"
@@ -11,28 +12,29 @@
 #include "sw.h"
 #include "action/validate.h"
 #include "transaction/transaction_types.h"
+#include "transaction/tokens.h"
+#include "transaction/tx_utils.h"
+#include "transaction/script_disasm.h"
 #include "common/format.h"
 #include "utils.h"
 #include "menu.h"
 #include "shared_context.h"
 #include "sign_tx_common.h"
 
-global_item_storage_t G_tx;
-
-void format_signer(uint8_t signer_idx,
-                   char *dest_title,
-                   size_t dest_title_size,
-                   char *dest_text,
-                   size_t dest_text_size) {
+static void format_signer(uint8_t signer_idx,
+                          char *dest_title,
+                          size_t dest_title_size,
+                          char *dest_text,
+                          size_t dest_text_size) {
     strlcpy(dest_title, "Signer", dest_title_size);
     snprintf(dest_text, dest_text_size, "%d of %d", signer_idx + 1, G_context.tx_info.transaction.signers_size);
 }
 
-void format_account(const signer_t *s,
-                    char *dest_title,
-                    size_t dest_title_size,
-                    char *dest_text,
-                    size_t dest_text_size) {
+static void format_account(const signer_t *s,
+                           char *dest_title,
+                           size_t dest_title_size,
+                           char *dest_text,
+                           size_t dest_text_size) {
     strlcpy(dest_title, "Account", dest_title_size);
     format_hex(s->account, 20, dest_text, dest_text_size);
 }
@@ -45,7 +47,11 @@ static void strlcat_with_comma(char *dest, const char *text, size_t dest_size, b
     *is_first = false;
 }
 
-void format_scope(const signer_t *s, char *dest_title, size_t dest_title_size, char *dest_text, size_t dest_text_size) {
+static void format_scope(const signer_t *s,
+                         char *dest_title,
+                         size_t dest_title_size,
+                         char *dest_text,
+                         size_t dest_text_size) {
     strlcpy(dest_title, "Scope", dest_title_size);
     if (s->scope == NONE) {
         strlcpy(dest_text, "None", dest_text_size);
@@ -66,101 +72,614 @@ void format_scope(const signer_t *s, char *dest_title, size_t dest_title_size, c
     }
 }
 
-void format_contract(const signer_t *s,
-                     uint8_t contract_index,
-                     char *dest_title,
-                     size_t dest_title_size,
-                     char *dest_text,
-                     size_t dest_text_size) {
+static void format_contract(const signer_t *s,
+                            uint8_t contract_index,
+                            char *dest_title,
+                            size_t dest_title_size,
+                            char *dest_text,
+                            size_t dest_text_size) {
     snprintf(dest_title, dest_title_size, "Contract %d of %d", contract_index + 1, s->allowed_contracts_size);
-    format_hex(s->allowed_contracts[contract_index], UINT160_LEN, dest_text, dest_text_size);
+    format_hex(SIGNER_ALLOWED_CONTRACT(&G_context.tx_info.transaction, s, contract_index),
+               UINT160_LEN,
+               dest_text,
+               dest_text_size);
 }
 
-void format_group(const signer_t *s,
-                  uint8_t group_index,
-                  char *dest_title,
-                  size_t dest_title_size,
-                  char *dest_text,
-                  size_t dest_text_size) {
+static void format_group(const signer_t *s,
+                         uint8_t group_index,
+                         char *dest_title,
+                         size_t dest_title_size,
+                         char *dest_text,
+                         size_t dest_text_size) {
     snprintf(dest_title, dest_title_size, "Group %d of %d", group_index + 1, s->allowed_groups_size);
-    format_hex(s->allowed_groups[group_index], ECPOINT_LEN, dest_text, dest_text_size);
+    format_hex(SIGNER_ALLOWED_GROUP(&G_context.tx_info.transaction, s, group_index),
+               ECPOINT_LEN,
+               dest_text,
+               dest_text_size);
 }
 
-int start_sign_tx(void) {
-    if (G_context.tx_info.transaction.is_system_asset_transfer) {
-        memset(G_tx.dst_address, 0, sizeof(G_tx.dst_address));
-        snprintf(G_tx.dst_address, sizeof(G_tx.dst_address), "%s", G_context.tx_info.transaction.dst_address);
-        PRINTF("Destination address: %s\n", G_tx.dst_address);
-
-        memset(G_tx.token_amount, 0, sizeof(G_tx.token_amount));
-        char token_amount[sizeof(G_tx.token_amount)] = {0};
-        if (!format_fpu64(token_amount,
-                          sizeof(token_amount),
-                          (uint64_t) G_context.tx_info.transaction.amount,
-                          G_context.tx_info.transaction.is_neo ? 0 : 8)) {
-            return io_send_sw(SW_DISPLAY_TOKEN_TRANSFER_AMOUNT_FAIL);
+typedef enum {
+    SIGNER_ITEM_INDEX,
+    SIGNER_ITEM_ACCOUNT,
+    SIGNER_ITEM_SCOPE,
+    SIGNER_ITEM_CONTRACTS,  // then one screen per allowed contract, followed by the allowed groups
+} signer_item_e;
+
+// Cumulative screen count: the screens of signer i are [signer_items_start[i], signer_items_start[i + 1]). The
+// transaction is refused before it holds more than MAX_SIGNER_DATA_LEN / UINT160_LEN contracts and groups, so there
+// are at most 74 screens.
+static uint8_t signer_items_start[MAX_TX_SIGNERS + 1];
+
+uint8_t get_signer_items_count(void) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    _Static_assert(MAX_TX_SIGNERS * 3 + MAX_SIGNER_DATA_LEN / UINT160_LEN <= UINT8_MAX,
+                   "signer screens must be indexed by an uint8_t!");
+    signer_items_start[0] = 0;
+    for (uint8_t i = 0; i < tx->signers_size; i++) {
+        const signer_t *signer = &tx->signers[i];
+        signer_items_start[i + 1] =
+            signer_items_start[i] + SIGNER_ITEM_CONTRACTS + signer->allowed_contracts_size + signer->allowed_groups_size;
+    }
+    return signer_items_start[tx->signers_size];
+}
+
+void format_signer_item(uint8_t index,
+                        char *dest_title,
+                        size_t dest_title_size,
+                        char *dest_text,
+                        size_t dest_text_size) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+    uint8_t low = 0;
+    uint8_t high = tx->signers_size;
+
+    // last signer starting at or before 'index', in log2(MAX_TX_SIGNERS) + 1 steps at most
+    while (high - low > 1) {
+        const uint8_t middle = (low + high) / 2;
+        if (signer_items_start[middle] <= index) {
+            low = middle;
+        } else {
+            high = middle;
         }
-        snprintf(G_tx.token_amount,
-                 sizeof(G_tx.token_amount),
-                 "%s %.*s",
-                 G_context.tx_info.transaction.is_neo ? "NEO" : "GAS",
-                 sizeof(token_amount),
-                 token_amount);
     }
 
-    if (G_context.tx_info.transaction.is_vote_script && !G_context.tx_info.transaction.is_remove_vote) {
-        memset(G_tx.vote_to, 0, sizeof(G_tx.vote_to));
-        format_hex(G_context.tx_info.transaction.vote_to, ECPOINT_LEN, G_tx.vote_to, sizeof(G_tx.vote_to));
+    const signer_t *signer = &tx->signers[low];
+    const uint8_t item = index - signer_items_start[low];
+
+    memset(dest_text, 0, dest_text_size);
+    switch (item) {
+        case SIGNER_ITEM_INDEX:
+            format_signer(low, dest_title, dest_title_size, dest_text, dest_text_size);
+            break;
+        case SIGNER_ITEM_ACCOUNT:
+            format_account(signer, dest_title, dest_title_size, dest_text, dest_text_size);
+            break;
+        case SIGNER_ITEM_SCOPE:
+            format_scope(signer, dest_title, dest_title_size, dest_text, dest_text_size);
+            break;
+        default:
+            if (item - SIGNER_ITEM_CONTRACTS < signer->allowed_contracts_size) {
+                format_contract(signer,
+                                item - SIGNER_ITEM_CONTRACTS,
+                                dest_title,
+                                dest_title_size,
+                                dest_text,
+                                dest_text_size);
+            } else {
+                format_group(signer,
+                             item - SIGNER_ITEM_CONTRACTS - signer->allowed_contracts_size,
+                             dest_title,
+                             dest_title_size,
+                             dest_text,
+                             dest_text_size);
+            }
+            break;
     }
+}
+
+static void format_gas(uint64_t value, char *dest_text, size_t dest_text_size) {
+    char amount[REVIEW_VALUE_MAX_SIZE] = {0};
+
+    // Fees are values multiplied by 100_000_000 to create 8 decimals stored in an int
+    if (!format_fpu64(amount, sizeof(amount), value, 8)) {
+        amount[0] = '\0';
+    }
+    snprintf(dest_text, dest_text_size, "GAS %s", amount);
+}
+
+static void format_address(const uint8_t *script_hash, char *dest_text, size_t dest_text_size) {
+    memset(dest_text, 0, dest_text_size);
+    if (dest_text_size > ADDRESS_LEN) {
+        // not null terminated, dest_text was cleared above
+        script_hash_to_address(dest_text, ADDRESS_LEN, script_hash);
+    }
+}
+
+/**
+ * Amount with the ticker and decimals of known tokens, raw amount otherwise.
+ * The raw amount is followed by the number of the token screen showing the contract, unless 'token_number' is 0.
+ */
+static void format_amount(const uint8_t *token_script_hash,
+                          uint8_t token_number,
+                          const uint256_t *amount,
+                          char *dest_text,
+                          size_t dest_text_size) {
+    const token_info_t *token = token_info_find(token_script_hash);
+    // format_fpu256() wants room for 'decimals' more digits than it writes
+    char value[UINT256_MAX_DIGITS + MAX_TOKEN_DECIMALS + 2] = {0};
 
-    // We'll try to give more user friendly names for known networks
-    if (G_context.network_magic == NETWORK_MAINNET) {
-        strcpy(G_tx.network, "MainNet");
-    } else if (G_context.network_magic == NETWORK_TESTNET) {
-        strcpy(G_tx.network, "TestNet");
+    if (token == NULL) {
+        format_u256(value, sizeof(value), amount);
+        if (token_number > 0) {
+            snprintf(dest_text, dest_text_size, "%s (token %d)", value, token_number);
+        } else {
+            strlcpy(dest_text, value, dest_text_size);
+        }
+        return;
+    }
+    if (!format_fpu256(value, sizeof(value), amount, token->decimals)) {
+        value[0] = '\0';
+    }
+    snprintf(dest_text, dest_text_size, "%s %s", token->ticker, value);
+}
+
+/**
+ * Amount of a transfer of the transaction. In batches, unknown tokens are referred to by their token screen.
+ */
+static void format_token_amount(uint8_t token_index,
+                                const uint256_t *amount,
+                                char *dest_text,
+                                size_t dest_text_size) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    format_amount(tx->transfer_tokens[token_index],
+                  (tx->transfers_size > 1) ? token_index + 1 : 0,
+                  amount,
+                  dest_text,
+                  dest_text_size);
+}
+
+/**
+ * Amount of a transfer of the transaction, see format_token_amount().
+ */
+static void format_transfer_amount(const transfer_t *transfer, char *dest_text, size_t dest_text_size) {
+    uint256_t amount;
+
+    transfer_get_amount(&G_context.tx_info.transaction, transfer, &amount);
+    format_token_amount(transfer->token_index, &amount, dest_text, dest_text_size);
+}
+
+/**
+ * Contract of a token, its ticker if it is known.
+ */
+static void format_token(const uint8_t *token_script_hash, char *dest_text, size_t dest_text_size) {
+    const token_info_t *token = token_info_find(token_script_hash);
+
+    if (token != NULL) {
+        strlcpy(dest_text, token->ticker, dest_text_size);
     } else {
-        snprintf(G_tx.network, sizeof(G_tx.network), "%d", G_context.network_magic);
-    }
-    PRINTF("Target network: %s\n", G_tx.network);
-
-    // System fee is a value multiplied by 100_000_000 to create 8 decimals stored in an int.
-    // It is not allowed to be negative so we can safely cast it to uint64_t
-    memset(G_tx.system_fee, 0, sizeof(G_tx.system_fee));
-    char system_fee[sizeof(G_tx.system_fee)] = {0};
-    if (!format_fpu64(system_fee, sizeof(system_fee), (uint64_t) G_context.tx_info.transaction.system_fee, 8)) {
-        return io_send_sw(SW_DISPLAY_SYSTEM_FEE_FAIL);
-    }
-    snprintf(G_tx.system_fee, sizeof(G_tx.system_fee), "GAS %.*s", sizeof(system_fee), system_fee);
-    PRINTF("System fee: %s GAS\n", system_fee);
-
-    // Network fee is stored in a similar fashion as system fee above
-    memset(G_tx.network_fee, 0, sizeof(G_tx.network_fee));
-    char network_fee[sizeof(G_tx.network_fee)] = {0};
-    if (!format_fpu64(network_fee, sizeof(network_fee), (uint64_t) G_context.tx_info.transaction.network_fee, 8)) {
-        return io_send_sw(SW_DISPLAY_NETWORK_FEE_FAIL);
-    }
-    snprintf(G_tx.network_fee, sizeof(G_tx.network_fee), "GAS %.*s", sizeof(network_fee), network_fee);
-    PRINTF("Network fee: %s GAS\n", network_fee);
-
-    memset(G_tx.total_fees, 0, sizeof(G_tx.total_fees));
-    char total_fee[sizeof(G_tx.total_fees)] = {0};
-    // Note that network_fee and system_fee are actually int64 and can't be less than 0 (as guarded by
-    // transaction_deserialize())
-    if (!format_fpu64(total_fee,
-                      sizeof(total_fee),
-                      (uint64_t) G_context.tx_info.transaction.network_fee + G_context.tx_info.transaction.system_fee,
-                      8)) {
-        return io_send_sw(SW_DISPLAY_TOTAL_FEE_FAIL);
-    }
-    snprintf(G_tx.total_fees, sizeof(G_tx.total_fees), "GAS %.*s", sizeof(total_fee), total_fee);
-
-    snprintf(G_tx.valid_until_block,
-             sizeof(G_tx.valid_until_block),
-             "%d",
-             G_context.tx_info.transaction.valid_until_block);
-    PRINTF("Valid until: %s\n", G_tx.valid_until_block);
+        format_hex(token_script_hash, UINT160_LEN, dest_text, dest_text_size);
+    }
+}
+
+uint8_t get_transfer_batch_items_count(void) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    if (!tx->is_token_transfer || tx->transfers_size < 2) {
+        return 0;
+    }
+    return 2 * (tx->transfers_size + tx->transfer_tokens_size);
+}
 
+void format_transfer_batch_item(uint8_t index,
+                                char *dest_title,
+                                size_t dest_title_size,
+                                char *dest_text,
+                                size_t dest_text_size) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    memset(dest_text, 0, dest_text_size);
+
+    if (index < 2 * tx->transfers_size) {
+        const transfer_t *transfer = &tx->transfers[index / 2];
+
+        if (index % 2 == 0) {
+            snprintf(dest_title, dest_title_size, "Transfer %d of %d", index / 2 + 1, tx->transfers_size);
+            format_transfer_amount(transfer, dest_text, dest_text_size);
+        } else {
+            strlcpy(dest_title, "To", dest_title_size);
+            format_address(transfer->dst_script_hash, dest_text, dest_text_size);
+        }
+        return;
+    }
+
+    const uint8_t token_index = (index - 2 * tx->transfers_size) / 2;
+
+    if (index % 2 == 0) {
+        snprintf(dest_title, dest_title_size, "Token %d of %d", token_index + 1, tx->transfer_tokens_size);
+        format_token(tx->transfer_tokens[token_index], dest_text, dest_text_size);
+    } else {
+        strlcpy(dest_title, "Total", dest_title_size);
+        format_token_amount(token_index, &tx->transfer_totals[token_index], dest_text, dest_text_size);
+    }
+}
+
+typedef enum {
+    BATCH_ITEM_COUNT,
+    BATCH_ITEM_NETWORK,
+    BATCH_ITEM_SIGNER,
+    BATCH_ITEM_TOTAL_FEES,
+    BATCH_ITEM_TOKENS,  // then the token and total of each token, followed by the transactions
+} batch_item_e;
+
+typedef enum {
+    BATCH_TX_ITEM_AMOUNT,
+    BATCH_TX_ITEM_DST,
+    BATCH_TX_ITEM_FEES,
+    BATCH_TX_ITEMS_NB
+} batch_tx_item_e;
+
+void get_batch_token_total(uint8_t token_index, uint256_t *total) {
+    const batch_ctx_t *batch = &G_context.tx_info.batch;
+    uint256_t amount;
+
+    memset(total, 0, sizeof(*total));
+    for (uint8_t i = 0; i < batch->received; i++) {
+        if (batch->txs[i].token_index == token_index) {
+            uint256_read_le(batch->amounts + batch->txs[i].amount_offset, batch->txs[i].amount_len, &amount);
+            // can't overflow, see add_batch_tx()
+            (void) uint256_add(total, &amount);
+        }
+    }
+}
+
+uint8_t get_batch_items_count(void) {
+    const batch_ctx_t *batch = &G_context.tx_info.batch;
+
+    _Static_assert(BATCH_ITEM_TOKENS + 2 * MAX_TRANSFER_TOKENS + BATCH_TX_ITEMS_NB * MAX_BATCH_TXS <= UINT8_MAX,
+                   "batch screens must be indexed by an uint8_t!");
+    return BATCH_ITEM_TOKENS + 2 * batch->tokens_size + BATCH_TX_ITEMS_NB * batch->count;
+}
+
+void format_batch_item(uint8_t index, char *dest_title, size_t dest_title_size, char *dest_text, size_t dest_text_size) {
+    const batch_ctx_t *batch = &G_context.tx_info.batch;
+
+    memset(dest_text, 0, dest_text_size);
+
+    switch (index) {
+        case BATCH_ITEM_COUNT:
+            strlcpy(dest_title, "Transactions", dest_title_size);
+            snprintf(dest_text, dest_text_size, "%d", batch->count);
+            return;
+        case BATCH_ITEM_NETWORK:
+            strlcpy(dest_title, "Target network", dest_title_size);
+            format_review_field(REVIEW_FIELD_NETWORK, dest_text, dest_text_size);
+            return;
+        case BATCH_ITEM_SIGNER:
+            // the single signer of every transaction, limited to the entry script
+            strlcpy(dest_title, "Signer", dest_title_size);
+            format_address(batch->signer, dest_text, dest_text_size);
+            return;
+        case BATCH_ITEM_TOTAL_FEES:
+            strlcpy(dest_title, "Total fees", dest_title_size);
+            format_gas(batch->fees, dest_text, dest_text_size);
+            return;
+        default:
+            break;
+    }
+
+    index -= BATCH_ITEM_TOKENS;
+    if (index < 2 * batch->tokens_size) {
+        const uint8_t token_index = index / 2;
+
+        if (index % 2 == 0) {
+            snprintf(dest_title, dest_title_size, "Token %d of %d", token_index + 1, batch->tokens_size);
+            format_token(batch->tokens[token_index], dest_text, dest_text_size);
+        } else {
+            strlcpy(dest_title, "Total", dest_title_size);
+            uint256_t total;
+
+            get_batch_token_total(token_index, &total);
+            format_amount(batch->tokens[token_index], token_index + 1, &total, dest_text, dest_text_size);
+        }
+        return;
+    }
+
+    index -= 2 * batch->tokens_size;
+    const batch_tx_t *summary = &batch->txs[index / BATCH_TX_ITEMS_NB];
+    uint256_t amount;
+
+    switch (index % BATCH_TX_ITEMS_NB) {
+        case BATCH_TX_ITEM_AMOUNT:
+            snprintf(dest_title, dest_title_size, "Tx %d of %d", index / BATCH_TX_ITEMS_NB + 1, batch->count);
+            uint256_read_le(batch->amounts + summary->amount_offset, summary->amount_len, &amount);
+            format_amount(batch->tokens[summary->token_index],
+                          summary->token_index + 1,
+                          &amount,
+                          dest_text,
+                          dest_text_size);
+            break;
+        case BATCH_TX_ITEM_DST:
+            strlcpy(dest_title, "To", dest_title_size);
+            format_address(summary->dst_script_hash, dest_text, dest_text_size);
+            break;
+        default:
+            strlcpy(dest_title, "Fees", dest_title_size);
+            format_gas(summary->fees, dest_text, dest_text_size);
+            break;
+    }
+}
+
+#ifdef HAVE_RESIGN_TX
+// screens of the review of RESIGN_TX which sum up the unchanged transaction: its vote or its transfers
+static uint8_t get_resign_summary_items_count(void) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    if (tx->is_vote_script) {
+        return 1;
+    }
+    if (get_transfer_batch_items_count() > 0) {
+        return get_transfer_batch_items_count();
+    }
+    if (tx->is_token_transfer) {
+        return (token_info_find(tx->transfer_tokens[0]) == NULL) ? 3 : 2;
+    }
+    return 0;
+}
+
+static void format_resign_summary_item(uint8_t index,
+                                       char *dest_title,
+                                       size_t dest_title_size,
+                                       char *dest_text,
+                                       size_t dest_text_size) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    if (tx->is_vote_script) {
+        if (tx->is_remove_vote) {
+            strlcpy(dest_title, "Vote", dest_title_size);
+            strlcpy(dest_text, "Retracting vote", dest_text_size);
+        } else {
+            strlcpy(dest_title, "Casting vote for", dest_title_size);
+            format_review_field(REVIEW_FIELD_VOTE_TO, dest_text, dest_text_size);
+        }
+    } else if (get_transfer_batch_items_count() > 0) {
+        format_transfer_batch_item(index, dest_title, dest_title_size, dest_text, dest_text_size);
+    } else if (index == 0) {
+        strlcpy(dest_title, "To", dest_title_size);
+        format_review_field(REVIEW_FIELD_DST_ADDRESS, dest_text, dest_text_size);
+    } else if (index == get_resign_summary_items_count() - 1) {
+        strlcpy(dest_title, "Token amount", dest_title_size);
+        format_review_field(REVIEW_FIELD_TOKEN_AMOUNT, dest_text, dest_text_size);
+    } else {
+        strlcpy(dest_title, "Token contract", dest_title_size);
+        format_review_field(REVIEW_FIELD_TOKEN_CONTRACT, dest_text, dest_text_size);
+    }
+}
+
+static uint8_t get_resign_changes_count(void) {
+    uint8_t count = 0;
+
+    for (uint8_t changes = G_context.tx_info.resign_changes; changes != 0; changes &= changes - 1) {
+        count++;
+    }
+    return count;
+}
+
+uint8_t get_resign_items_count(void) {
+    // the warning about the transaction signed before comes last
+    return get_resign_summary_items_count() + get_resign_changes_count() + 1;
+}
+
+void format_resign_item(uint8_t index,
+                        char *dest_title,
+                        size_t dest_title_size,
+                        char *dest_text,
+                        size_t dest_text_size) {
+    uint8_t field = 0;
+
+    memset(dest_text, 0, dest_text_size);
+    if (index < get_resign_summary_items_count()) {
+        format_resign_summary_item(index, dest_title, dest_title_size, dest_text, dest_text_size);
+        return;
+    }
+    index -= get_resign_summary_items_count();
+    if (index == get_resign_changes_count()) {
+        strlcpy(dest_title, "Warning", dest_title_size);
+        strlcpy(dest_text,
+                "The transaction signed before is not cancelled: either one can still be included in a block",
+                dest_text_size);
+        return;
+    }
+
+    // the field of the index-th changed one, in the order of the header
+    for (uint8_t changes = G_context.tx_info.resign_changes; changes != 0; changes &= changes - 1) {
+        field = changes & -changes;
+        if (index-- == 0) {
+            break;
+        }
+    }
+
+    switch (field) {
+        case RESIGN_FIELD_NONCE:
+            strlcpy(dest_title, "New nonce", dest_title_size);
+            snprintf(dest_text, dest_text_size, "%u", G_context.tx_info.transaction.nonce);
+            break;
+        case RESIGN_FIELD_SYSTEM_FEE:
+            strlcpy(dest_title, "New system fee", dest_title_size);
+            format_review_field(REVIEW_FIELD_SYSTEM_FEE, dest_text, dest_text_size);
+            break;
+        case RESIGN_FIELD_NETWORK_FEE:
+            strlcpy(dest_title, "New network fee", dest_title_size);
+            format_review_field(REVIEW_FIELD_NETWORK_FEE, dest_text, dest_text_size);
+            break;
+        default:
+            strlcpy(dest_title, "New valid until", dest_title_size);
+            format_review_field(REVIEW_FIELD_VALID_UNTIL_BLOCK, dest_text, dest_text_size);
+            break;
+    }
+}
+#endif
+
+// position in the disassembly, which is decoded from the script when a screen is displayed
+static script_disasm_t script_cursor;
+static uint8_t script_items_nb;
+// bytes at the end of the script which are signed without being disassembled
+static uint16_t script_hidden_len;
+
+static size_t get_script_retained_len(const transaction_t *tx) {
+    return (tx->script_size < MAX_SCRIPT_PREFIX_LEN) ? tx->script_size : MAX_SCRIPT_PREFIX_LEN;
+}
+
+uint8_t get_script_items_count(void) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    script_disasm_init(&script_cursor);
+    script_items_nb = 0;
+    script_hidden_len = 0;
+    if (!tx->is_token_transfer && !tx->is_vote_script) {
+        // an instruction takes one byte at least, plus the summary of the rest
+        _Static_assert(MAX_SCRIPT_PREFIX_LEN + 1 <= UINT8_MAX, "script screens must be indexed by an uint8_t!");
+        script_items_nb = (uint8_t) script_disasm_count(tx->script, get_script_retained_len(tx), tx->script_size);
+        script_hidden_len = tx->script_size - (uint16_t) script_disasm_decoded_len(tx->script,
+                                                                                    get_script_retained_len(tx),
+                                                                                    tx->script_size);
+    }
+    return script_items_nb;
+}
+
+bool is_script_partly_shown(void) {
+    return script_hidden_len > 0;
+}
+
+void format_script_item(uint8_t index,
+                        char *dest_title,
+                        size_t dest_title_size,
+                        char *dest_text,
+                        size_t dest_text_size) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    snprintf(dest_title, dest_title_size, "Script %d of %d", index + 1, script_items_nb);
+    if (!script_disasm_format(&script_cursor,
+                              tx->script,
+                              get_script_retained_len(tx),
+                              tx->script_size,
+                              index,
+                              dest_text,
+                              dest_text_size)) {
+        memset(dest_text, 0, dest_text_size);
+    }
+}
+
+void format_review_field(review_field_e field, char *dest_text, size_t dest_text_size) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    memset(dest_text, 0, dest_text_size);
+
+    switch (field) {
+        case REVIEW_FIELD_DST_ADDRESS:
+            format_address(tx->transfers[0].dst_script_hash, dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_TOKEN_AMOUNT:
+            format_transfer_amount(&tx->transfers[0], dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_TOKEN_CONTRACT:
+            format_hex(tx->transfer_tokens[0], UINT160_LEN, dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_VOTE_TO:
+            format_hex(tx->vote_to, ECPOINT_LEN, dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_NETWORK:
+            // We'll try to give more user friendly names for known networks
+            if (G_context.network_magic == NETWORK_MAINNET) {
+                strlcpy(dest_text, "MainNet", dest_text_size);
+            } else if (G_context.network_magic == NETWORK_TESTNET) {
+                strlcpy(dest_text, "TestNet", dest_text_size);
+            } else {
+                snprintf(dest_text, dest_text_size, "%d", G_context.network_magic);
+            }
+            break;
+        case REVIEW_FIELD_SYSTEM_FEE:
+            // It is not allowed to be negative so we can safely cast it to uint64_t
+            format_gas((uint64_t) tx->system_fee, dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_NETWORK_FEE:
+            format_gas((uint64_t) tx->network_fee, dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_TOTAL_FEES:
+            // Note that network_fee and system_fee are actually int64 and can't be less than 0 (as guarded by
+            // transaction_deserialize()), so their sum fits in an uint64_t
+            format_gas((uint64_t) tx->network_fee + (uint64_t) tx->system_fee, dest_text, dest_text_size);
+            break;
+        case REVIEW_FIELD_VALID_UNTIL_BLOCK:
+            snprintf(dest_text, dest_text_size, "%d", tx->valid_until_block);
+            break;
+        case REVIEW_FIELD_SCRIPT_NOT_SHOWN:
+            snprintf(dest_text,
+                     dest_text_size,
+                     "The last %d of the %d script bytes are signed without being shown",
+                     script_hidden_len,
+                     tx->script_size);
+            break;
+    }
+}
+
+bool is_script_allowed(void) {
+    const transaction_t *tx = &G_context.tx_info.transaction;
+
+    return tx->is_token_transfer || tx->is_vote_script || N_storage.scriptsAllowed;
+}
+
+int start_sign_tx(void) {
+    // Review fields are formatted when their screen is displayed, nothing to prepare here
     start_sign_tx_ui();
 
     return 0;
 }
+
+int start_sign_tx_batch(void) {
+    // the response is sent once the user approves or rejects the batch
+    start_sign_tx_batch_ui();
+
+    return 0;
+}
+
+#ifdef HAVE_RESIGN_TX
+int start_resign_tx(void) {
+    // the response is sent once the user approves or rejects the new header fields
+    start_resign_tx_ui();
+
+    return 0;
+}
+#endif
+
+int start_sign_tx_stream(void) {
+    G_context.review_stream = REVIEW_STREAM_REVIEWING;
+    start_sign_tx_stream_ui();
+
+    return 0;
+}
+
+int finish_sign_tx_stream(void) {
+    // the response is sent once the user approves or rejects the transaction
+    continue_sign_tx_stream_ui();
+
+    return 0;
+}
+
+bool sign_tx_stream_header_reviewed(void) {
+    if (G_context.state == STATE_PARSED) {
+        return true;
+    }
+    G_context.review_stream = REVIEW_STREAM_WAITING;
+    return false;
+}
+
+void reject_sign_tx_stream(void) {
+    if (G_context.state == STATE_PARSED) {
+        // the last chunk is waiting for its response
+        ui_action_validate_transaction(false, false);
+    } else {
+        // the current chunk has been answered already, the next one will be denied
+        G_context.review_stream = REVIEW_STREAM_REJECTED;
+    }
+}
@@ -3,61 +3,164 @@
 #include "types.h"
 
 // number of steps in create_transaction_flow() for BAGL
-#define MAX_NUM_STEPS 13
-
-// uint32 (=max 10 chars) + \0
-#define UINT32_STRING_SIZE 11
-
-// Target network the tx in tended for ("MainNet", "TestNet" or uint32 network number for private nets)
-#define NETWORK_NAME_MAX_SIZE 11
-
-// ticker + uint64 (=max 20 chars) + \0
-#define AMOUNTS_MAX_SIZE 30
-
-// 33 bytes public key as hex + \0
-#define VOTE_TO_SIZE (ECPOINT_LEN * 2 + 1)
-
-typedef struct global_item_storage_s {
-    char dst_address[ADDRESS_LEN + 1];
-    char system_fee[AMOUNTS_MAX_SIZE];
-    char network_fee[AMOUNTS_MAX_SIZE];
-    char total_fees[AMOUNTS_MAX_SIZE];
-    char token_amount[AMOUNTS_MAX_SIZE];
-    char vote_to[VOTE_TO_SIZE];
-    char network[NETWORK_NAME_MAX_SIZE];
-    char valid_until_block[UINT32_STRING_SIZE];
-} global_item_storage_t;
-
-extern global_item_storage_t G_tx;
-
-void format_signer(uint8_t signer_idx,
-                   char *dest_title,
-                   size_t dest_title_size,
-                   char *dest_text,
-                   size_t dest_text_size);
-
-void format_account(const signer_t *s,
-                    char *dest_title,
-                    size_t dest_title_size,
-                    char *dest_text,
-                    size_t dest_text_size);
-
-void format_scope(const signer_t *s, char *dest_title, size_t dest_title_size, char *dest_text, size_t dest_text_size);
-
-void format_contract(const signer_t *s,
-                     uint8_t contract_index,
-                     char *dest_title,
-                     size_t dest_title_size,
-                     char *dest_text,
-                     size_t dest_text_size);
-
-void format_group(const signer_t *s,
-                  uint8_t group_index,
-                  char *dest_title,
-                  size_t dest_title_size,
-                  char *dest_text,
-                  size_t dest_text_size);
+#define MAX_NUM_STEPS 15
+
+// Largest formatted review value: "PUSHINT256 " and a negative 256-bit integer in the disassembly of a script + \0,
+// which is longer than a raw 256-bit token amount + " (token n)", a ticker followed by a 256-bit amount with its
+// decimal point, or a 33 bytes public key as hex
+#define REVIEW_VALUE_MAX_SIZE 96
+
+/**
+ * Transaction fields shown in the review before the signers.
+ * They are only formatted by format_review_field() when their screen is displayed.
+ */
+typedef enum {
+    REVIEW_FIELD_DST_ADDRESS,       /// destination address of a single NEP-17 transfer
+    REVIEW_FIELD_TOKEN_AMOUNT,      /// amount of a single NEP-17 transfer, with its ticker if the token is known
+    REVIEW_FIELD_TOKEN_CONTRACT,    /// contract of a single NEP-17 transfer, only shown for unknown tokens
+    REVIEW_FIELD_VOTE_TO,           /// public key voted for
+    REVIEW_FIELD_NETWORK,           /// "MainNet", "TestNet" or the network magic of private nets
+    REVIEW_FIELD_SYSTEM_FEE,        /// system fee in GAS
+    REVIEW_FIELD_NETWORK_FEE,       /// network fee in GAS
+    REVIEW_FIELD_TOTAL_FEES,        /// system fee + network fee in GAS
+    REVIEW_FIELD_VALID_UNTIL_BLOCK, /// block height until which the transaction is valid
+    REVIEW_FIELD_SCRIPT_NOT_SHOWN   /// warning about the end of a script which is not disassembled
+} review_field_e;
+
+void format_review_field(review_field_e field, char *dest_text, size_t dest_text_size);
+
+/**
+ * Number of screens of a batched transfer: amount and destination of every transfer, then each distinct token
+ * with its total. 0 unless the script is made of several transfers.
+ */
+uint8_t get_transfer_batch_items_count(void);
+
+/**
+ * Format screen 'index' of a batched transfer, see get_transfer_batch_items_count().
+ */
+void format_transfer_batch_item(uint8_t index,
+                                char *dest_title,
+                                size_t dest_title_size,
+                                char *dest_text,
+                                size_t dest_text_size);
+
+/**
+ * Sum of the amounts of the token 'token_index' over the transactions of the batch received so far. The transactions
+ * whose amount would make it overflow are refused, so it is recomputed instead of being kept.
+ */
+void get_batch_token_total(uint8_t token_index, uint256_t *total);
+
+/**
+ * Number of screens of the review of a batch of transactions: their count, the network, their signer and the total
+ * fees, each distinct token with its total, then the amount, destination and fees of every transaction.
+ */
+uint8_t get_batch_items_count(void);
+
+/**
+ * Format screen 'index' of the review of a batch, see get_batch_items_count().
+ */
+void format_batch_item(uint8_t index, char *dest_title, size_t dest_title_size, char *dest_text, size_t dest_text_size);
+
+#ifdef HAVE_RESIGN_TX
+/**
+ * Number of screens of the review of RESIGN_TX: the vote or the transfers of the transaction as in its first review,
+ * one per changed header field with its new value, then a warning that the transaction signed before stays valid.
+ */
+uint8_t get_resign_items_count(void);
+
+/**
+ * Format screen 'index' of the review of RESIGN_TX, see get_resign_items_count().
+ */
+void format_resign_item(uint8_t index,
+                        char *dest_title,
+                        size_t dest_title_size,
+                        char *dest_text,
+                        size_t dest_text_size);
+#endif
+
+/**
+ * Number of screens of the disassembly of an arbitrary script, at most MAX_SCRIPT_PREFIX_LEN + 1: one per instruction
+ * of the retained prefix, then the bytes which were not decoded. 0 for the scripts with a dedicated review.
+ * Only the first MAX_SCRIPT_PREFIX_LEN (128) bytes of the script are kept, so the instructions after them, as well as
+ * those after an unknown opcode, are never shown: is_script_partly_shown() then requires a warning before approval.
+ * Also rewinds the disassembly, to be called when the review starts.
+ */
+uint8_t get_script_items_count(void);
+
+/**
+ * Whether the end of the script is signed without being disassembled, see get_script_items_count(). The review must
+ * then show the REVIEW_FIELD_SCRIPT_NOT_SHOWN warning before the approval.
+ */
+bool is_script_partly_shown(void);
+
+/**
+ * Format screen 'index' of the disassembly, see get_script_items_count().
+ */
+void format_script_item(uint8_t index, char *dest_title, size_t dest_title_size, char *dest_text, size_t dest_text_size);
+
+/**
+ * Number of signer screens: for each signer its index, account and scope, then its allowed contracts and groups.
+ * Also indexes the screens of each signer, to be called when the review starts.
+ */
+uint8_t get_signer_items_count(void);
+
+/**
+ * Format signer screen 'index', see get_signer_items_count().
+ */
+void format_signer_item(uint8_t index, char *dest_title, size_t dest_title_size, char *dest_text, size_t dest_text_size);
+
+/**
+ * Whether the script of the transaction can be signed: recognized scripts always are, arbitrary ones only when
+ * allowed in the settings.
+ */
+bool is_script_allowed(void);
 
 int start_sign_tx(void);
 
 void start_sign_tx_ui(void);
+
+/**
+ * Start the review of a batch of transactions, once all of them have been received.
+ */
+int start_sign_tx_batch(void);
+
+void start_sign_tx_batch_ui(void);
+
+#ifdef HAVE_RESIGN_TX
+/**
+ * Start the review of the header fields changed by RESIGN_TX, the rest of the transaction was already approved.
+ */
+int start_resign_tx(void);
+
+void start_resign_tx_ui(void);
+#endif
+
+/**
+ * Start the review with the header and signers of the transaction, while its script is still being received.
+ * The review of the script, then the signature, follow once finish_sign_tx_stream() is called.
+ */
+int start_sign_tx_stream(void);
+
+/**
+ * The last chunk of a transaction which review was started by start_sign_tx_stream() has been parsed and hashed.
+ */
+int finish_sign_tx_stream(void);
+
+/**
+ * To be called by the UI once the user reviewed the header and signers of a streamed transaction.
+ *
+ * @return true if the rest of the transaction can be reviewed, false if it is still being received:
+ * continue_sign_tx_stream_ui() is then called once it is.
+ */
+bool sign_tx_stream_header_reviewed(void);
+
+/**
+ * To be called by the UI when the user rejects a streamed transaction, whether it has been fully received or not.
+ */
+void reject_sign_tx_stream(void);
+
+void start_sign_tx_stream_ui(void);
+
+void continue_sign_tx_stream_ui(void);
+
+void abort_sign_tx_stream_ui(void);
@@ -13,6 +13,7 @@
 #include "sw.h"
 #include "action/validate.h"
 #include "transaction/transaction_types.h"
+#include "transaction/tokens.h"
 #include "common/format.h"
 #include "utils.h"
 #include "menu.h"
@@ -21,67 +22,46 @@
 
 #include "nbgl_use_case.h"
 
-typedef enum item_kind_e {
-    SIGNER,
-    ACCOUNT,
-    SCOPE,
-    CONTRACT,
-    GROUP,
-} item_kind_t;
-
-typedef struct item_signer_s {
-    uint8_t signer_index;
-} item_signer_t;
-
-typedef struct item_account_s {
-    uint8_t signer_index;
-} item_account_t;
-
-typedef struct item_scope_s {
-    uint8_t signer_index;
-} item_scope_t;
-
-typedef struct item_contract_s {
-    uint8_t signer_index;
-    uint8_t contract_index;
-} item_contract_t;
-
-typedef struct item_group_s {
-    uint8_t signer_index;
-    uint8_t group_index;
-} item_group_t;
-
-typedef struct dynamic_item_s {
-    item_kind_t kind;
-    union {
-        item_signer_t as_item_signer;
-        item_account_t as_item_account;
-        item_scope_t as_item_scope;
-        item_contract_t as_item_contract;
-        item_group_t as_item_group;
-    } content;
-} dynamic_item_t;
+typedef struct static_item_s {
+    const char *title;
+    review_field_e field;
+} static_item_t;
 
 typedef struct dynamic_slot_s {
     char title[64];
-    char text[64];
+    char text[REVIEW_VALUE_MAX_SIZE];
 } dynamic_slot_t;
 
 static nbgl_contentTagValueList_t content;
 static const char *review_final_long_press_text;
 static nbgl_contentTagValue_t current_pair;
-static nbgl_contentTagValue_t static_items[MAX_NUM_STEPS + 1];
+static static_item_t static_items[MAX_NUM_STEPS + 1];
 static dynamic_slot_t dyn_slots[NB_MAX_DISPLAYED_PAIRS_IN_REVIEW];
 static uint8_t static_items_nb;
-// Reserve space for preparing the dynamic items (signer) display. At the moment 42 elements max
-static dynamic_item_t
-    dyn_items[MAX_TX_SIGNERS * (3 + MAX_SIGNER_ALLOWED_CONTRACTS * 1 + MAX_SIGNER_ALLOWED_GROUPS * 1)];
-static uint8_t dyn_items_nb;
+static uint8_t batch_items_nb;
+static uint8_t script_items_nb;
+static uint8_t signer_items_nb;
+// 1 when the end of the script is signed without being disassembled, to warn about it after the other pages
+static uint8_t warning_items_nb;
 static const char *review_title;
+static char review_title_text[48];
+static char review_final_long_press_text_buf[48];
 
-static void create_transaction_flow(void) {
-    static_items_nb = 0;
-    dyn_items_nb = 0;
+static void add_static_item(const char *title, review_field_e field) {
+    static_items[static_items_nb].title = title;
+    static_items[static_items_nb].field = field;
+    ++static_items_nb;
+}
+
+/**
+ * Pages depending on the script, and the texts of the review which describe it.
+ * In a streamed review, whose title is only known once the script is received, the vote is also shown as a page.
+ */
+static void add_script_items(bool streamed) {
+    // the screens of batched transfers or of the script disassembly come first, they are formatted by index
+    batch_items_nb = get_transfer_batch_items_count();
+    script_items_nb = get_script_items_count();
+    warning_items_nb = (script_items_nb > 0 && is_script_partly_shown()) ? 1 : 0;
 
     if (G_context.tx_info.transaction.is_vote_script) {
         if (G_context.tx_info.transaction.is_remove_vote) {
@@ -90,76 +70,64 @@ static void create_transaction_flow(void) {
         } else {
             review_final_long_press_text = "Sign transaction to\ncast vote?";
             review_title = "Review transaction to\ncast vote";
+            if (streamed) {
+                add_static_item("Casting vote for", REVIEW_FIELD_VOTE_TO);
+            }
         }
-    } else if (G_context.tx_info.transaction.is_system_asset_transfer) {
-        static_items[static_items_nb].item = "To";
-        static_items[static_items_nb].value = G_tx.dst_address;
-        ++static_items_nb;
-        static_items[static_items_nb].item = "Token amount";
-        static_items[static_items_nb].value = G_tx.token_amount;
-        ++static_items_nb;
-
-        if (G_context.tx_info.transaction.is_neo) {
-            review_final_long_press_text = "Sign transaction to\nsend NEO?";
-            review_title = "Review transaction to\nsend NEO";
-        } else {
-            review_final_long_press_text = "Sign transaction to\nsend GAS?";
-            review_title = "Review transaction to\nsend GAS";
+    } else if (batch_items_nb > 0) {
+        snprintf(review_final_long_press_text_buf,
+                 sizeof(review_final_long_press_text_buf),
+                 "Sign transaction to\nsend %d transfers?",
+                 G_context.tx_info.transaction.transfers_size);
+        snprintf(review_title_text,
+                 sizeof(review_title_text),
+                 "Review transaction to\nsend %d transfers",
+                 G_context.tx_info.transaction.transfers_size);
+        review_final_long_press_text = review_final_long_press_text_buf;
+        review_title = review_title_text;
+    } else if (G_context.tx_info.transaction.is_token_transfer) {
+        const token_info_t *token = token_info_find(G_context.tx_info.transaction.transfer_tokens[0]);
+
+        add_static_item("To", REVIEW_FIELD_DST_ADDRESS);
+        if (token == NULL) {
+            add_static_item("Token contract", REVIEW_FIELD_TOKEN_CONTRACT);
         }
+        add_static_item("Token amount", REVIEW_FIELD_TOKEN_AMOUNT);
+
+        snprintf(review_final_long_press_text_buf,
+                 sizeof(review_final_long_press_text_buf),
+                 "Sign transaction to\nsend %s?",
+                 (token != NULL) ? token->ticker : "tokens");
+        snprintf(review_title_text,
+                 sizeof(review_title_text),
+                 "Review transaction to\nsend %s",
+                 (token != NULL) ? token->ticker : "tokens");
+        review_final_long_press_text = review_final_long_press_text_buf;
+        review_title = review_title_text;
     } else {
         review_final_long_press_text = "Sign script?";
         review_title = "Review transaction\nto sign script";
     }
+}
 
-    static_items[static_items_nb].item = "Target network";
-    static_items[static_items_nb].value = G_tx.network;
-    ++static_items_nb;
-
-    static_items[static_items_nb].item = "System fee";
-    static_items[static_items_nb].value = G_tx.system_fee;
-    ++static_items_nb;
-
-    static_items[static_items_nb].item = "Network fee";
-    static_items[static_items_nb].value = G_tx.network_fee;
-    ++static_items_nb;
-
-    static_items[static_items_nb].item = "Total fees";
-    static_items[static_items_nb].value = G_tx.total_fees;
-    ++static_items_nb;
-
-    static_items[static_items_nb].item = "Valid until height";
-    static_items[static_items_nb].value = G_tx.valid_until_block;
-    ++static_items_nb;
-
-    // dyn_items size is tailored to fit the worst case scenario
-    // if the number of element is too big for the array it would have triggered a parsing error
-    for (int i = 0; i < G_context.tx_info.transaction.signers_size; ++i) {
-        dyn_items[dyn_items_nb].kind = SIGNER;
-        dyn_items[dyn_items_nb].content.as_item_signer.signer_index = i;
-        ++dyn_items_nb;
-        dyn_items[dyn_items_nb].kind = ACCOUNT;
-        dyn_items[dyn_items_nb].content.as_item_account.signer_index = i;
-        ++dyn_items_nb;
-        dyn_items[dyn_items_nb].kind = SCOPE;
-        dyn_items[dyn_items_nb].content.as_item_scope.signer_index = i;
-        ++dyn_items_nb;
-
-        signer_t signer = G_context.tx_info.transaction.signers[i];
-        for (int j = 0; j < signer.allowed_contracts_size; ++j) {
-            dyn_items[dyn_items_nb].kind = CONTRACT;
-            dyn_items[dyn_items_nb].content.as_item_contract.signer_index = i;
-            dyn_items[dyn_items_nb].content.as_item_contract.contract_index = j;
-            ++dyn_items_nb;
-        }
-        for (int j = 0; j < signer.allowed_groups_size; ++j) {
-            dyn_items[dyn_items_nb].kind = GROUP;
-            dyn_items[dyn_items_nb].content.as_item_group.signer_index = i;
-            dyn_items[dyn_items_nb].content.as_item_group.group_index = j;
-            ++dyn_items_nb;
-        }
-    }
+/**
+ * Pages of the header and of the signers, which come before the script in the transaction.
+ */
+static void add_header_items(void) {
+    add_static_item("Target network", REVIEW_FIELD_NETWORK);
+    add_static_item("System fee", REVIEW_FIELD_SYSTEM_FEE);
+    add_static_item("Network fee", REVIEW_FIELD_NETWORK_FEE);
+    add_static_item("Total fees", REVIEW_FIELD_TOTAL_FEES);
+    add_static_item("Valid until height", REVIEW_FIELD_VALID_UNTIL_BLOCK);
+
+    signer_items_nb = get_signer_items_count();
 }
 
+static void create_transaction_flow(void) {
+    static_items_nb = 0;
+    add_script_items(false);
+    add_header_items();
+}
 
 static void review_final_callback(bool confirmed) {
     if (confirmed) {
@@ -172,70 +140,58 @@ static void review_final_callback(bool confirmed) {
 }
 
 
-static void format_tag_value(dynamic_slot_t *slot, const dynamic_item_t *item) {
-    signer_t s = G_context.tx_info.transaction.signers[item->content.as_item_scope.signer_index];
-    switch (item->kind) {
-        case SIGNER:
-            format_signer(item->content.as_item_signer.signer_index,
-                          slot->title,
-                          sizeof(slot->title),
-                          slot->text,
-                          sizeof(slot->text));
-            break;
-
-        case ACCOUNT:
-            format_account(&s, slot->title, sizeof(slot->title), slot->text, sizeof(slot->text));
-            break;
-
-        case SCOPE:
-            format_scope(&s, slot->title, sizeof(slot->title), slot->text, sizeof(slot->text));
-            break;
-
-        case CONTRACT:
-            format_contract(&s,
-                            item->content.as_item_contract.contract_index,
-                            slot->title,
-                            sizeof(slot->title),
-                            slot->text,
-                            sizeof(slot->text));
-            break;
-
-        case GROUP:
-            format_group(&s,
-                         item->content.as_item_group.group_index,
-                         slot->title,
-                         sizeof(slot->title),
-                         slot->text,
-                         sizeof(slot->text));
-            break;
-    }
-}
-
 // function called by NBGL to get the current_pair indexed by "index"
 static nbgl_contentTagValue_t *get_single_action_review_pair(uint8_t index) {
     current_pair.valueIcon = NULL;
-    if (index < static_items_nb) {
-        // No need to copy to dyn_slots as item and value are pointers to static values
-        current_pair.item = static_items[index].item;
-        current_pair.value = static_items[index].value;
-    } else {
-        dynamic_item_t *item = &dyn_items[index - static_items_nb];
-        dynamic_slot_t *slot = &dyn_slots[index % ARRAY_COUNT(dyn_slots)];
-        format_tag_value(slot, item);
+    // values are only formatted when requested, in a slot that stays valid while the page is displayed
+    dynamic_slot_t *slot = &dyn_slots[index % ARRAY_COUNT(dyn_slots)];
+    if (index < batch_items_nb) {
+        format_transfer_batch_item(index, slot->title, sizeof(slot->title), slot->text, sizeof(slot->text));
+        current_pair.item = slot->title;
+    } else if (index < batch_items_nb + script_items_nb) {
+        format_script_item(index - batch_items_nb, slot->title, sizeof(slot->title), slot->text, sizeof(slot->text));
         current_pair.item = slot->title;
-        current_pair.value = slot->text;
+    } else if (index < batch_items_nb + script_items_nb + static_items_nb) {
+        index -= batch_items_nb + script_items_nb;
+        // No need to copy the title to the slot as it is a pointer to a static string
+        format_review_field(static_items[index].field, slot->text, sizeof(slot->text));
+        current_pair.item = static_items[index].title;
+    } else if (index < batch_items_nb + script_items_nb + static_items_nb + signer_items_nb) {
+        format_signer_item(index - batch_items_nb - script_items_nb - static_items_nb,
+                           slot->title,
+                           sizeof(slot->title),
+                           slot->text,
+                           sizeof(slot->text));
+        current_pair.item = slot->title;
+    } else {
+        format_review_field(REVIEW_FIELD_SCRIPT_NOT_SHOWN, slot->text, sizeof(slot->text));
+        current_pair.item = "Warning";
     }
+    current_pair.value = slot->text;
     return &current_pair;
 }
 
+/**
+ * Pages are requested by index in [batched transfers, script disassembly, static items, signers, warning], the parts
+ * which are not displayed are left empty.
+ */
+static void init_review_content(void) {
+    content.nbMaxLinesForValue = 0;
+    content.smallCaseForValue = false;
+    content.wrapping = true;
+    content.pairs = NULL;  // to indicate that callback should be used
+    content.callback = get_single_action_review_pair;
+    content.startIndex = 0;
+    content.nbPairs = batch_items_nb + script_items_nb + static_items_nb + signer_items_nb + warning_items_nb;
+}
+
 static void arbitrary_script_rejection_callback(bool confirmed) {
     ui_action_validate_transaction(false, false);
     ui_menu_settings(confirmed);
 }
 
 void start_sign_tx_ui(void) {
-    if (!G_context.tx_info.transaction.is_system_asset_transfer && !G_context.tx_info.transaction.is_vote_script &&
-        !N_storage.scriptsAllowed) {
+    if (!is_script_allowed()) {
         // TODO: maybe add a mechanism to resume the transaction if the user allows the setting
         nbgl_useCaseChoice(&C_Warning_64px,
                            "Arbitrary contract\nscripts are not allowed.",
@@ -248,13 +204,7 @@ void start_sign_tx_ui(void) {
         // Prepare steps
         create_transaction_flow();
         // start display
-        content.nbMaxLinesForValue = 0;
-        content.smallCaseForValue = false;
-        content.wrapping = true;
-        content.pairs = NULL;  // to indicate that callback should be used
-        content.callback = get_single_action_review_pair;
-        content.startIndex = 0;
-        content.nbPairs = static_items_nb + dyn_items_nb;
+        init_review_content();
 
         nbgl_useCaseReview(
             TYPE_TRANSACTION,
@@ -267,4 +217,161 @@ void start_sign_tx_ui(void) {
     }
 }
 
+static void batch_review_callback(bool confirmed) {
+    if (confirmed) {
+        ui_action_validate_batch(true, false);
+        nbgl_useCaseReviewStatus(STATUS_TYPE_TRANSACTION_SIGNED, ui_menu_main);
+    } else {
+        ui_action_validate_batch(false, false);
+        nbgl_useCaseReviewStatus(STATUS_TYPE_TRANSACTION_REJECTED, ui_menu_main);
+    }
+}
+
+static nbgl_contentTagValue_t *get_batch_review_pair(uint8_t index) {
+    dynamic_slot_t *slot = &dyn_slots[index % ARRAY_COUNT(dyn_slots)];
+
+    format_batch_item(index, slot->title, sizeof(slot->title), slot->text, sizeof(slot->text));
+    current_pair.valueIcon = NULL;
+    current_pair.item = slot->title;
+    current_pair.value = slot->text;
+    return &current_pair;
+}
+
+void start_sign_tx_batch_ui(void) {
+    content.nbMaxLinesForValue = 0;
+    content.smallCaseForValue = false;
+    content.wrapping = true;
+    content.pairs = NULL;  // to indicate that callback should be used
+    content.callback = get_batch_review_pair;
+    content.startIndex = 0;
+    content.nbPairs = get_batch_items_count();
+
+    snprintf(review_title_text,
+             sizeof(review_title_text),
+             "Review batch of\n%d transactions",
+             G_context.tx_info.batch.count);
+    snprintf(review_final_long_press_text_buf,
+             sizeof(review_final_long_press_text_buf),
+             "Sign %d\ntransactions?",
+             G_context.tx_info.batch.count);
+
+    nbgl_useCaseReview(TYPE_TRANSACTION,
+                       &content,
+                       &C_icon_neo_n3_64x64,
+                       review_title_text,
+                       NULL,
+                       review_final_long_press_text_buf,
+                       batch_review_callback);
+}
+
+#ifdef HAVE_RESIGN_TX
+static nbgl_contentTagValue_t *get_resign_review_pair(uint8_t index) {
+    dynamic_slot_t *slot = &dyn_slots[index % ARRAY_COUNT(dyn_slots)];
+
+    format_resign_item(index, slot->title, sizeof(slot->title), slot->text, sizeof(slot->text));
+    current_pair.valueIcon = NULL;
+    current_pair.item = slot->title;
+    current_pair.value = slot->text;
+    return &current_pair;
+}
+
+void start_resign_tx_ui(void) {
+    content.nbMaxLinesForValue = 0;
+    content.smallCaseForValue = false;
+    content.wrapping = true;
+    content.pairs = NULL;  // to indicate that callback should be used
+    content.callback = get_resign_review_pair;
+    content.startIndex = 0;
+    content.nbPairs = get_resign_items_count();
+
+    nbgl_useCaseReview(TYPE_TRANSACTION,
+                       &content,
+                       &C_icon_neo_n3_64x64,
+                       "Review changes to\nthe last transaction",
+                       NULL,
+                       "Sign updated\ntransaction?",
+                       review_final_callback);
+}
+#endif
+
+static void stream_rejection_callback(void) {
+    reject_sign_tx_stream();
+    nbgl_useCaseReviewStatus(STATUS_TYPE_TRANSACTION_REJECTED, ui_menu_main);
+}
+
+static void stream_script_callback(bool confirmed) {
+    if (confirmed) {
+        nbgl_useCaseReviewStreamingFinish(review_final_long_press_text, review_final_callback);
+    } else {
+        stream_rejection_callback();
+    }
+}
+
+/**
+ * Pages depending on the script, once the whole transaction has been received.
+ */
+static void review_stream_script(void) {
+    if (!is_script_allowed()) {
+        // the setting can't change during the review, only a defensive check
+        stream_rejection_callback();
+        return;
+    }
+
+    static_items_nb = 0;
+    signer_items_nb = 0;
+    add_script_items(true);
+    init_review_content();
+    if (content.nbPairs == 0) {
+        stream_script_callback(true);
+    } else {
+        nbgl_useCaseReviewStreamingContinue(&content, stream_script_callback);
+    }
+}
+
+static void stream_header_callback(bool confirmed) {
+    if (!confirmed) {
+        stream_rejection_callback();
+    } else if (sign_tx_stream_header_reviewed()) {
+        review_stream_script();
+    } else {
+        // continue_sign_tx_stream_ui() is called once the last chunk is received
+        nbgl_useCaseSpinner("Receiving transaction");
+    }
+}
+
+static void stream_start_callback(bool confirmed) {
+    if (confirmed) {
+        nbgl_useCaseReviewStreamingContinue(&content, stream_header_callback);
+    } else {
+        stream_rejection_callback();
+    }
+}
+
+void start_sign_tx_stream_ui(void) {
+    // only the header and the signers can be shown until the script is received
+    static_items_nb = 0;
+    batch_items_nb = 0;
+    script_items_nb = 0;
+    warning_items_nb = 0;
+    add_header_items();
+    init_review_content();
+
+    nbgl_useCaseReviewStreamingStart(TYPE_TRANSACTION,
+                                     &C_icon_neo_n3_64x64,
+                                     "Review transaction",
+                                     NULL,
+                                     stream_start_callback);
+}
+
+void continue_sign_tx_stream_ui(void) {
+    // otherwise the script is reviewed once the user is done with the header and signers
+    if (G_context.review_stream == REVIEW_STREAM_WAITING) {
+        review_stream_script();
+    }
+}
+
+void abort_sign_tx_stream_ui(void) {
+    nbgl_useCaseReviewStatus(STATUS_TYPE_TRANSACTION_REJECTED, ui_menu_main);
+}
+
 #endif
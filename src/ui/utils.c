@@ -4,6 +4,7 @@
 #include "types.h"
 #include "common/base58.h"
 
+#include <assert.h>  // _Static_assert
 #include <string.h>
 
 /** the length of a SHA256 hash */
@@ -30,15 +31,19 @@
  */
 #define VERIFICATION_SCRIPT_LENGTH 40
 
+void compress_public_key(const uint8_t public_key[static 64], uint8_t out[static COMPRESSED_PUBKEY_LEN]) {
+    out[0] = ((public_key[63] & 1) ? 0x03 : 0x02);
+    memcpy(&out[1], public_key, 32);
+}
+
 bool create_signature_redeem_script(const uint8_t* public_key, uint8_t* out, size_t out_len) {
     if (out_len != VERIFICATION_SCRIPT_LENGTH) {
         return false;
     }
 
     // we first have to compress the public key
-    uint8_t compressed_key[33];
-    compressed_key[0] = ((public_key[63] & 1) ? 0x03 : 0x02);
-    memcpy(&compressed_key[1], public_key, 32);
+    uint8_t compressed_key[COMPRESSED_PUBKEY_LEN];
+    compress_public_key(public_key, compressed_key);
 
     out[0] = 0xc;   // OpCode.PUSHDATA1;
     out[1] = 0x21;  // data size, 33 bytes for compressed public key
@@ -84,25 +89,34 @@ void script_hash_to_address(char* out, size_t out_len, const unsigned char* scri
     // append to the end of the data
     memcpy(&address[1 + UINT160_LEN], data_hash_2, SCRIPT_HASH_CHECKSUM_LEN);
 
-    base58_encode(address, sizeof(address), out, out_len);
+    _Static_assert(ADDRESS_LEN_PRE == BASE58_ADDRESS_INPUT_SIZE, "address payload must be 25 bytes!");
+    base58_encode_address(address, out, out_len);
 
 }
 
-bool address_from_pubkey(const uint8_t public_key[static 64], char* out, size_t out_len) {
-    // we need to go through 3 steps
+bool script_hash_from_pubkey(const uint8_t public_key[static 64], uint8_t out[static UINT160_LEN]) {
     // 1. create a verification script with the public key
     // 2. create a script hash of the verification script (using sha256 + ripemd160)
-    // 3. base58check encode the NEO account version + script hash to get the address
     unsigned char verification_script[VERIFICATION_SCRIPT_LENGTH];
+
+    if (!create_signature_redeem_script(public_key, verification_script, sizeof(verification_script))) {
+        return false;
+    }
+    public_key_hash160(verification_script, sizeof(verification_script), out);
+    return true;
+}
+
+bool address_from_pubkey(const uint8_t public_key[static 64], char* out, size_t out_len) {
+    // we need to go through 2 steps
+    // 1. create the script hash of the verification script of the public key
+    // 2. base58check encode the NEO account version + script hash to get the address
     unsigned char script_hash[UINT160_LEN];
 
     // step 1
-    if (!create_signature_redeem_script(public_key, verification_script, sizeof(verification_script))) {
+    if (!script_hash_from_pubkey(public_key, script_hash)) {
         return false;
     }
     // step 2
-    public_key_hash160(verification_script, sizeof(verification_script), script_hash);
-    // step 3
     script_hash_to_address(out, out_len, script_hash);
     return true;
 }
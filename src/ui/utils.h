@@ -8,6 +8,19 @@
 
 #define ARRAY_COUNT(array) (sizeof(array) / sizeof(array[0]))
 
+/** length of a compressed public key, 0x02 or 0x03 prefix followed by the x-coordinate */
+#define COMPRESSED_PUBKEY_LEN 33
+
+/**
+ * Compress a raw public key, x-coordinate (32) and y-coordinate (32).
+ */
+void compress_public_key(const uint8_t public_key[static 64], uint8_t out[static COMPRESSED_PUBKEY_LEN]);
+
+/**
+ * Script hash of the single signature verification script of a raw public key.
+ */
+bool script_hash_from_pubkey(const uint8_t public_key[static 64], uint8_t out[static 20]);
+
 bool address_from_pubkey(const uint8_t public_key[static 64], char* out, size_t out_len);
 
 void script_hash_to_address(char* out, size_t out_len, const unsigned char* script_hash);
@@ -0,0 +1,89 @@
+"""Host-side reference for the public (non-hardened) BIP32 derivation on NIST P-256.
+
+The device exports the compressed public key and chain code of a BIP44 account (m/44'/888'/account'), every
+change/address key below it can then be derived here without any device I/O. Ledger devices follow SLIP-10 on
+this curve, which only differs from BIP32 in the unlikely case of an invalid child key.
+"""
+import hashlib
+import hmac
+from typing import Optional, Sequence, Tuple
+
+# NIST P-256 domain parameters
+P = 0xffffffff00000001000000000000000000000000ffffffffffffffffffffffff
+A = P - 3
+B = 0x5ac635d8aa3a93e7b3ebbd55769886bc651d06b0cc53b0f63bce3c3e27d2604b
+N = 0xffffffff00000000ffffffffffffffffbce6faada7179e84f3b9cac2fc632551
+G = (0x6b17d1f2e12c4247f8bce6e563a440f277037d812deb33a0f4a13945d898c296,
+     0x4fe342e2fe1a7f9b8ee7eb4a7c0f9e162bce33576b315ececbb6406837bf51f5)
+
+Point = Optional[Tuple[int, int]]  # None is the point at infinity
+
+
+def point_add(p: Point, q: Point) -> Point:
+    if p is None:
+        return q
+    if q is None:
+        return p
+    if p[0] == q[0] and (p[1] + q[1]) % P == 0:
+        return None
+    if p == q:
+        slope = (3 * p[0] * p[0] + A) * pow(2 * p[1], -1, P) % P
+    else:
+        slope = (q[1] - p[1]) * pow(q[0] - p[0], -1, P) % P
+    x = (slope * slope - p[0] - q[0]) % P
+    return x, (slope * (p[0] - x) - p[1]) % P
+
+
+def point_mul(k: int, p: Point) -> Point:
+    result: Point = None
+    while k:
+        if k & 1:
+            result = point_add(result, p)
+        p = point_add(p, p)
+        k >>= 1
+    return result
+
+
+def compress(p: Tuple[int, int]) -> bytes:
+    return (b"\x03" if p[1] & 1 else b"\x02") + p[0].to_bytes(32, "big")
+
+
+def decompress(data: bytes) -> Tuple[int, int]:
+    assert len(data) == 33 and data[0] in (2, 3)
+    x = int.from_bytes(data[1:], "big")
+    y = pow((x * x * x + A * x + B) % P, (P + 1) // 4, P)
+    if (y & 1) != (data[0] & 1):
+        y = P - y
+    return x, y
+
+
+def uncompressed(p: Tuple[int, int]) -> bytes:
+    return b"\x04" + p[0].to_bytes(32, "big") + p[1].to_bytes(32, "big")
+
+
+def derive_child(public_key: bytes, chain_code: bytes, index: int) -> Tuple[bytes, bytes]:
+    """CKDpub: compressed public key and chain code of the non-hardened child 'index'."""
+    assert 0 <= index < 0x80000000, "hardened children can't be derived from a public key"
+
+    data = public_key + index.to_bytes(4, "big")
+    while True:
+        i = hmac.new(chain_code, data, hashlib.sha512).digest()
+        il, ir = int.from_bytes(i[:32], "big"), i[32:]
+        if il < N:
+            child = point_add(point_mul(il, G), decompress(public_key))
+            if child is not None:
+                return compress(child), ir
+        # SLIP-10: retry with the right half of the digest
+        data = b"\x01" + ir + index.to_bytes(4, "big")
+
+
+def derive_path(public_key: bytes, chain_code: bytes, path: Sequence[int]) -> Tuple[bytes, bytes]:
+    for index in path:
+        public_key, chain_code = derive_child(public_key, chain_code, index)
+    return public_key, chain_code
+
+
+def derive_uncompressed(public_key: bytes, chain_code: bytes, path: Sequence[int]) -> bytes:
+    """Same format as GET_PUBLIC_KEY: 0x04 followed by the x and y coordinates."""
+    child, _ = derive_path(public_key, chain_code, path)
+    return uncompressed(decompress(child))
@@ -18,6 +18,8 @@ class DeviceException(Exception):  # pylint: disable=too-few-public-methods
         0xB003: TxRejectSignError,
         0xB004: BadStateError,
         0xB005: SignatureFailError,
+        0xB006: WrongTxOffsetError,
+        0xB007: BatchTxUnsupportedError,
         0xB100: BIP44BadPurposeError,
         0xB101: BIP44BadCoinTypeError,
         0xB102: BIP44BadAccountNotHardenedError,
@@ -54,6 +54,14 @@ class SignatureFailError(Exception):
     pass
 
 
+class WrongTxOffsetError(Exception):
+    pass
+
+
+class BatchTxUnsupportedError(Exception):
+    pass
+
+
 class TxRejectSignError(Exception):
     pass
 
@@ -1,10 +1,10 @@
 import struct
-from typing import Tuple, Generator
+from typing import List, Tuple, Generator, Union
 from contextlib import contextmanager
 
 from ragger.backend.interface import BackendInterface, RAPDU
 
-from .neo_n3_cmd_builder import Neo_n3_CommandBuilder, InsType
+from .neo_n3_cmd_builder import Neo_n3_CommandBuilder, InsType, PubkeyFormat
 
 from .transaction import Transaction
 from neo3.network import payloads
@@ -72,6 +72,38 @@ class Neo_n3_Command:
 
         return response
 
+    def get_public_key_formatted(self, bip44_path: str, fmt: PubkeyFormat) -> bytes:
+        response = self.backend.exchange_raw(
+            self.builder.get_public_key(bip44_path=bip44_path, display=False, fmt=fmt)
+        ).data
+
+        expected_len = {PubkeyFormat.UNCOMPRESSED: 65,
+                        PubkeyFormat.COMPRESSED: 33,
+                        PubkeyFormat.SCRIPT_HASH: 20,
+                        PubkeyFormat.ADDRESS: 34}[fmt]
+        assert len(response) == expected_len
+
+        return response
+
+    def get_public_keys(self, bip44_path: str, count: int, fmt: PubkeyFormat) -> List[bytes]:
+        response = self.backend.exchange_raw(
+            self.builder.get_public_keys(bip44_path=bip44_path, count=count, fmt=fmt)
+        ).data
+
+        item_len = 33 if fmt == PubkeyFormat.COMPRESSED else 20
+        assert len(response) == count * item_len
+
+        return [response[i:i + item_len] for i in range(0, len(response), item_len)]
+
+    def get_account_xpub(self, bip44_path: str) -> Tuple[bytes, bytes]:
+        response = self.backend.exchange_raw(
+            self.builder.get_account_xpub(bip44_path=bip44_path)
+        ).data
+
+        assert len(response) == 33 + 32 # compressed public key + chain code
+
+        return response[:33], response[33:]
+
     @contextmanager
     def get_public_key_async(self, bip44_path: str) -> Generator[RAPDU, None, None]:
         payload = self.builder.get_public_key(bip44_path=bip44_path, display=True)
@@ -79,21 +111,86 @@ class Neo_n3_Command:
             yield response
 
     @contextmanager
-    def sign_tx(self, bip44_path: str, transaction: payloads.transaction.Transaction, network_magic: int) -> Generator[RAPDU, None, None]:
+    def sign_tx(self, bip44_path: Union[str, List[str]], transaction: payloads.transaction.Transaction,
+                network_magic: int, compressed: bool = False) -> Generator[RAPDU, None, None]:
         for is_last, chunk in self.builder.sign_tx(bip44_path=bip44_path,
                                                    transaction=transaction,
-                                                   network_magic=network_magic):
+                                                   network_magic=network_magic,
+                                                   compressed=compressed):
             if not is_last:
                 self.backend.exchange_raw(chunk)
             else:
                 with self.backend.exchange_async_raw(chunk) as response:
                     yield response
 
+    def sign_session_open(self, bip44_path: str, network_magic: int) -> None:
+        self.backend.exchange_raw(self.builder.sign_session_open(bip44_path=bip44_path, network_magic=network_magic))
+
+    def sign_session_close(self) -> None:
+        self.backend.exchange_raw(self.builder.sign_session_close())
+
+    @contextmanager
+    def sign_session_tx(self, transaction: payloads.transaction.Transaction,
+                        compressed: bool = False) -> Generator[RAPDU, None, None]:
+        for is_last, chunk in self.builder.sign_session_tx(transaction=transaction, compressed=compressed):
+            if not is_last:
+                self.backend.exchange_raw(chunk)
+            else:
+                with self.backend.exchange_async_raw(chunk) as response:
+                    yield response
+
+    @contextmanager
+    def resign_tx(self, nonce: int, system_fee: int, network_fee: int,
+                  valid_until_block: int) -> Generator[RAPDU, None, None]:
+        with self.backend.exchange_async_raw(self.builder.resign_tx(nonce=nonce,
+                                                                    system_fee=system_fee,
+                                                                    network_fee=network_fee,
+                                                                    valid_until_block=valid_until_block)
+                                             ) as response:
+            yield response
+
+    @staticmethod
+    def split_signatures(data: bytes) -> List[bytes]:
+        # response to a list of paths: len(signature) (1) || signature, for each path
+        signatures = []
+        offset = 0
+        while offset < len(data):
+            signatures.append(data[offset + 1:offset + 1 + data[offset]])
+            offset += 1 + data[offset]
+        return signatures
+
+    @contextmanager
+    def sign_tx_compact(self, bip44_path: str, transaction: payloads.transaction.Transaction, network_magic: int) -> Generator[RAPDU, None, None]:
+        payload = self.builder.sign_tx_compact(bip44_path=bip44_path,
+                                               transaction=transaction,
+                                               network_magic=network_magic)
+        with self.backend.exchange_async_raw(payload) as response:
+            yield response
+
+    @contextmanager
+    def sign_tx_batch(self, bip44_path: str, transactions: List[payloads.transaction.Transaction],
+                      network_magic: int, compressed: bool = False) -> Generator[RAPDU, None, None]:
+        for is_last, chunk in self.builder.sign_tx_batch(bip44_path=bip44_path,
+                                                         transactions=transactions,
+                                                         network_magic=network_magic,
+                                                         compressed=compressed):
+            if not is_last:
+                self.backend.exchange_raw(chunk)
+            else:
+                with self.backend.exchange_async_raw(chunk) as response:
+                    yield response
+
+    def get_batch_signatures(self, count: int) -> List[bytes]:
+        # the first signature is the response to the approval
+        return [self.backend.exchange_raw(self.builder.get_batch_signature(index)).data for index in range(1, count)]
+
     @contextmanager
-    def sign_vote_tx(self, bip44_path: str, transaction: Transaction, network_magic: int) -> Generator[RAPDU, None, None]:
+    def sign_vote_tx(self, bip44_path: str, transaction: Transaction, network_magic: int,
+                     compressed: bool = False) -> Generator[RAPDU, None, None]:
         for is_last, chunk in self.builder.sign_tx(bip44_path=bip44_path,
                                                    transaction=transaction,
-                                                   network_magic=network_magic):
+                                                   network_magic=network_magic,
+                                                   compressed=compressed):
             if not is_last:
                 self.backend.exchange_raw(chunk)
             else:
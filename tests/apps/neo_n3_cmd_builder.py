@@ -7,7 +7,16 @@ from ragger.bip import pack_derivation_path
 from neo3.network import node, payloads
 from neo3.core import serialization
 
+from .tx_compression import compress
+
 MAX_APDU_LEN: int = 255
+# Transaction chunks use P1 = 2, 3, ... saturating at P1_MAX
+P1_MAX: int = 0x7F
+# P2 flags of the transaction chunks
+P2_MORE: int = 0x80
+P2_OFFSET: int = 0x40
+P2_COMPRESSED: int = 0x20
+P2_PATHS: int = 0x10
 
 
 def chunkify(data: bytes, chunk_len: int) -> Iterator[Tuple[bool, bytes]]:
@@ -34,6 +43,18 @@ class InsType(enum.IntEnum):
     INS_GET_VERSION = 0x01
     INS_SIGN_TX = 0x02
     INS_GET_PUBLIC_KEY = 0x04
+    INS_GET_PUBLIC_KEYS = 0x05
+    INS_GET_ACCOUNT_XPUB = 0x06
+    INS_SIGN_TX_BATCH = 0x07
+    INS_RESIGN_TX = 0x08
+    INS_SIGN_SESSION = 0x09
+
+
+class PubkeyFormat(enum.IntEnum):
+    UNCOMPRESSED = 0x00
+    COMPRESSED = 0x01
+    SCRIPT_HASH = 0x02
+    ADDRESS = 0x03
 
 
 class Neo_n3_CommandBuilder:
@@ -143,13 +164,18 @@ class Neo_n3_CommandBuilder:
                               p2=0x00,
                               cdata=b"")
 
-    def get_public_key(self, bip44_path: str, display: bool) -> bytes:
+    def get_public_key(self, bip44_path: str, display: bool,
+                       fmt: PubkeyFormat = PubkeyFormat.UNCOMPRESSED) -> bytes:
         """Command builder for GET_PUBLIC_KEY.
 
         Parameters
         ----------
         bip44_path: str
             String representation of BIP44 path.
+        display: bool
+            Whether the address is shown for confirmation.
+        fmt: PubkeyFormat
+            Format of the returned key.
 
         Returns
         -------
@@ -159,20 +185,66 @@ class Neo_n3_CommandBuilder:
         """
         return self.serialize(cla=self.CLA,
                               ins=InsType.INS_GET_PUBLIC_KEY,
-                              p1=0x00,
+                              p1=fmt,
                               p2=int(display == True),
                               cdata=pack_derivation_path(bip44_path)[1:]) # No length prefix
 
-    def sign_tx(self, bip44_path: str, transaction: payloads.transaction.Transaction, network_magic: int
-                ) -> Iterator[Tuple[bool, bytes]]:
-        """Command builder for INS_SIGN_TX.
+    def get_public_keys(self, bip44_path: str, count: int, fmt: PubkeyFormat) -> bytes:
+        """Command builder for GET_PUBLIC_KEYS.
 
         Parameters
         ----------
         bip44_path : str
-            String representation of BIP44 path.
+            String representation of the BIP44 path of the first address.
+        count : int
+            Number of consecutive address indexes to derive.
+        fmt : PubkeyFormat
+            Format of the returned keys.
+
+        Returns
+        -------
+        bytes
+            APDU command for GET_PUBLIC_KEYS.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_GET_PUBLIC_KEYS,
+                              p1=fmt,
+                              p2=0x00,
+                              cdata=pack_derivation_path(bip44_path)[1:] + count.to_bytes(1, "big")) # No length prefix
+
+    def get_account_xpub(self, bip44_path: str) -> bytes:
+        """Command builder for GET_ACCOUNT_XPUB.
+
+        Parameters
+        ----------
+        bip44_path : str
+            String representation of the account level BIP44 path, e.g. m/44'/888'/0'.
+
+        Returns
+        -------
+        bytes
+            APDU command for GET_ACCOUNT_XPUB.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_GET_ACCOUNT_XPUB,
+                              p1=0x00,
+                              p2=0x00,
+                              cdata=pack_derivation_path(bip44_path)[1:]) # No length prefix
+
+    def sign_tx(self, bip44_path: Union[str, List[str]], transaction: payloads.transaction.Transaction,
+                network_magic: int, compressed: bool = False) -> Iterator[Tuple[bool, bytes]]:
+        """Command builder for INS_SIGN_TX.
+
+        Parameters
+        ----------
+        bip44_path : Union[str, List[str]]
+            String representation of BIP44 path, or a list of them to get one signature per path.
         transaction : payloads.transaction.Transaction
         network_magic: network magic for MainNet, TestNet or a private network.
+        compressed : bool
+            Whether the transaction is sent in the compressed encoding of tx_compression.py.
 
         Yields
         -------
@@ -180,34 +252,259 @@ class Neo_n3_CommandBuilder:
             APDU command chunk for INS_SIGN_TX.
 
         """
-        yield False, self.serialize(cla=self.CLA,
-                                    ins=InsType.INS_SIGN_TX,
-                                    p1=0x00,
-                                    p2=0x80,
-                                    cdata=pack_derivation_path(bip44_path)[1:]) # No length prefix
-
+        if isinstance(bip44_path, list):
+            cdata = len(bip44_path).to_bytes(1, "big") + b"".join(pack_derivation_path(path)[1:]
+                                                                  for path in bip44_path)
+            yield False, self.serialize(cla=self.CLA,
+                                        ins=InsType.INS_SIGN_TX,
+                                        p1=0x00,
+                                        p2=0x80 | P2_PATHS,
+                                        cdata=cdata)
+        else:
+            yield False, self.serialize(cla=self.CLA,
+                                        ins=InsType.INS_SIGN_TX,
+                                        p1=0x00,
+                                        p2=0x80,
+                                        cdata=pack_derivation_path(bip44_path)[1:]) # No length prefix
+
+        encoding = P2_COMPRESSED if compressed else 0x00
         magic = struct.pack("I", network_magic)
         yield False, self.serialize(cla=self.CLA,
                                     ins=InsType.INS_SIGN_TX,
                                     p1=0x01,
-                                    p2=0x80,
+                                    p2=0x80 | encoding,
                                     cdata=magic)
 
         with serialization.BinaryWriter() as writer:
             transaction.serialize_unsigned(writer)
             tx: bytes = writer.to_array()
+        if compressed:
+            tx = compress(tx)
 
         for i, (is_last, chunk) in enumerate(chunkify(tx, MAX_APDU_LEN)):
             if is_last:
                 yield True, self.serialize(cla=self.CLA,
                                            ins=InsType.INS_SIGN_TX,
-                                           p1=i + 2,
-                                           p2=0x00,
+                                           p1=min(i + 2, P1_MAX),
+                                           p2=0x00 | encoding,
                                            cdata=chunk)
                 return
             else:
                 yield False, self.serialize(cla=self.CLA,
                                             ins=InsType.INS_SIGN_TX,
-                                            p1=i + 2,
-                                            p2=0x80,
+                                            p1=min(i + 2, P1_MAX),
+                                            p2=0x80 | encoding,
                                             cdata=chunk)
+
+    def resign_tx(self, nonce: int, system_fee: int, network_fee: int, valid_until_block: int) -> bytes:
+        """Command builder for INS_RESIGN_TX.
+
+        The last transaction approved with INS_SIGN_TX is signed again with a new header, only the changed fields
+        are reviewed.
+
+        Parameters
+        ----------
+        nonce : int
+        system_fee : int
+        network_fee : int
+        valid_until_block : int
+
+        Returns
+        -------
+        bytes
+            APDU command for INS_RESIGN_TX.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_RESIGN_TX,
+                              p1=0x00,
+                              p2=0x00,
+                              cdata=struct.pack("<IqqI", nonce, system_fee, network_fee, valid_until_block))
+
+    def sign_tx_chunk_at(self, offset: int, chunk: bytes, is_last: bool) -> bytes:
+        """Command builder for an INS_SIGN_TX transaction chunk sent with its offset.
+
+        The response is the number of transaction bytes received so far, from which an interrupted upload resumes.
+        An empty chunk at offset 0 only asks for that number.
+
+        Parameters
+        ----------
+        offset : int
+            Offset of the chunk in the serialized transaction.
+        chunk : bytes
+            Transaction bytes, at most MAX_APDU_LEN - 4.
+        is_last : bool
+            Whether the chunk ends the transaction.
+
+        Returns
+        -------
+        bytes
+            APDU command for INS_SIGN_TX.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_SIGN_TX,
+                              p1=0x02,
+                              p2=P2_OFFSET if is_last else P2_OFFSET | P2_MORE,
+                              cdata=struct.pack(">I", offset) + chunk)
+
+    def sign_tx_compact(self, bip44_path: str, transaction: payloads.transaction.Transaction, network_magic: int
+                        ) -> bytes:
+        """Command builder for INS_SIGN_TX in compact mode.
+
+        The BIP44 path, the network magic and the transaction are sent in a single APDU.
+
+        Parameters
+        ----------
+        bip44_path : str
+            String representation of BIP44 path.
+        transaction : payloads.transaction.Transaction
+        network_magic: network magic for MainNet, TestNet or a private network.
+
+        Returns
+        -------
+        bytes
+            APDU command for INS_SIGN_TX.
+
+        """
+        with serialization.BinaryWriter() as writer:
+            transaction.serialize_unsigned(writer)
+            tx: bytes = writer.to_array()
+
+        cdata = pack_derivation_path(bip44_path)[1:] + struct.pack("I", network_magic) + tx  # No length prefix
+        if len(cdata) > MAX_APDU_LEN:
+            raise ValueError(f"Transaction too large for compact mode: {len(cdata)} bytes")
+
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_SIGN_TX,
+                              p1=0x00,
+                              p2=0x00,
+                              cdata=cdata)
+
+    def sign_tx_batch(self, bip44_path: str, transactions: List[payloads.transaction.Transaction], network_magic: int,
+                      compressed: bool = False) -> Iterator[Tuple[bool, bytes]]:
+        """Command builder for INS_SIGN_TX_BATCH.
+
+        Parameters
+        ----------
+        bip44_path : str
+            String representation of BIP44 path, the same for all transactions.
+        transactions : List[payloads.transaction.Transaction]
+            Single NEP-17 transfers of the same signer.
+        network_magic: network magic for MainNet, TestNet or a private network.
+        compressed : bool
+            Whether the transactions are sent in the compressed encoding of tx_compression.py.
+
+        Yields
+        -------
+        bytes
+            APDU command chunk for INS_SIGN_TX_BATCH, the last one is answered once the batch is reviewed.
+
+        """
+        encoding = P2_COMPRESSED if compressed else 0x00
+        cdata = pack_derivation_path(bip44_path)[1:] + struct.pack("<IB", network_magic, len(transactions))
+        yield False, self.serialize(cla=self.CLA,
+                                    ins=InsType.INS_SIGN_TX_BATCH,
+                                    p1=0x00,
+                                    p2=encoding,
+                                    cdata=cdata)
+
+        for i, transaction in enumerate(transactions):
+            with serialization.BinaryWriter() as writer:
+                transaction.serialize_unsigned(writer)
+                tx: bytes = writer.to_array()
+            if compressed:
+                tx = compress(tx)
+
+            for is_last, chunk in chunkify(tx, MAX_APDU_LEN):
+                yield is_last and i == len(transactions) - 1, self.serialize(cla=self.CLA,
+                                                                             ins=InsType.INS_SIGN_TX_BATCH,
+                                                                             p1=0x01,
+                                                                             p2=(0x00 if is_last else P2_MORE) | encoding,
+                                                                             cdata=chunk)
+
+    def get_batch_signature(self, index: int) -> bytes:
+        """Command builder for INS_SIGN_TX_BATCH to get the signature of a transaction of an approved batch.
+
+        Parameters
+        ----------
+        index : int
+            Index of the transaction in the batch.
+
+        Returns
+        -------
+        bytes
+            APDU command for INS_SIGN_TX_BATCH.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_SIGN_TX_BATCH,
+                              p1=0x02,
+                              p2=0x00,
+                              cdata=index.to_bytes(1, "big"))
+
+    def sign_session_open(self, bip44_path: str, network_magic: int) -> bytes:
+        """Command builder for INS_SIGN_SESSION to open a signing session.
+
+        Parameters
+        ----------
+        bip44_path : str
+            String representation of BIP44 path, used by all transactions of the session.
+        network_magic: network magic for MainNet, TestNet or a private network.
+
+        Returns
+        -------
+        bytes
+            APDU command for INS_SIGN_SESSION.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_SIGN_SESSION,
+                              p1=0x00,
+                              p2=0x00,
+                              cdata=pack_derivation_path(bip44_path)[1:] + struct.pack("<I", network_magic))
+
+    def sign_session_close(self) -> bytes:
+        """Command builder for INS_SIGN_SESSION to close the signing session.
+
+        Returns
+        -------
+        bytes
+            APDU command for INS_SIGN_SESSION.
+
+        """
+        return self.serialize(cla=self.CLA,
+                              ins=InsType.INS_SIGN_SESSION,
+                              p1=0x01,
+                              p2=0x00,
+                              cdata=b"")
+
+    def sign_session_tx(self, transaction: payloads.transaction.Transaction, compressed: bool = False
+                        ) -> Iterator[Tuple[bool, bytes]]:
+        """Command builder for INS_SIGN_SESSION to sign a transaction in the open session.
+
+        Parameters
+        ----------
+        transaction : payloads.transaction.Transaction
+        compressed : bool
+            Whether the transaction is sent in the compressed encoding of tx_compression.py.
+
+        Yields
+        -------
+        bytes
+            APDU command chunk for INS_SIGN_SESSION, only the transaction is sent.
+
+        """
+        with serialization.BinaryWriter() as writer:
+            transaction.serialize_unsigned(writer)
+            tx: bytes = writer.to_array()
+        encoding = P2_COMPRESSED if compressed else 0x00
+        if compressed:
+            tx = compress(tx)
+
+        for i, (is_last, chunk) in enumerate(chunkify(tx, MAX_APDU_LEN)):
+            yield is_last, self.serialize(cla=self.CLA,
+                                          ins=InsType.INS_SIGN_SESSION,
+                                          p1=0x02 if i == 0 else 0x03,
+                                          p2=(0x00 if is_last else P2_MORE) | encoding,
+                                          cdata=chunk)
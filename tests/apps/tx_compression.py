@@ -0,0 +1,116 @@
+"""Host encoder of the compressed SIGN_TX transaction encoding, expanded on the device by src/transaction/expander.c.
+
+The encoding is a sequence of tokens:
+
+- 0x00 to 0x7F: literal run, the next (token + 1) bytes are copied as is;
+- 0x80 to 0xBF: entry (token - 0x80) of the static DICTIONARY;
+- 0xC0 to 0xC7: the value remembered with index (token - 0xC0);
+- 0xC8: the next 20 bytes are copied and remembered as the next value, at most MAX_VALUES of them.
+
+The device hashes and signs the expanded bytes, so the signature is the same as for the uncompressed transaction.
+"""
+from typing import List, Optional
+
+# Same table as DICTIONARY in src/transaction/expander.c
+DICTIONARY: List[bytes] = [
+    bytes.fromhex("f563ea40bc283d4d0e05c48ea305b3f2a07340ef"),  # NEO contract
+    bytes.fromhex("cf76e28bd0062c4a478ee35561011319f3cfa4d2"),  # GAS contract
+    bytes.fromhex("14c01f0c08") + b"transfer" + bytes.fromhex("0c14"),  # transfer call, followed by the contract
+    bytes.fromhex("12c01f0c04") + b"vote" + bytes.fromhex("0c14"),  # vote call, followed by the contract
+    bytes.fromhex("41627d5b52"),  # SYSCALL System.Contract.Call
+]
+
+TOKEN_LITERAL_MAX_LEN: int = 0x80
+TOKEN_DICTIONARY: int = 0x80
+TOKEN_BACK_REFERENCE: int = 0xC0
+TOKEN_VALUE: int = 0xC8
+VALUE_LEN: int = 20
+MAX_VALUES: int = 8
+
+
+def compress(tx: bytes) -> bytes:
+    """Encode a serialized unsigned transaction.
+
+    Dictionary entries are used wherever they match. A 20-byte value that appears again later in the transaction is
+    remembered the first time it is sent and referred back to afterwards: the sender is usually both a signer and the
+    'from' argument of the script.
+    """
+    out = bytearray()
+    literal = bytearray()
+    values: List[bytes] = []
+
+    def flush_literal() -> None:
+        for i in range(0, len(literal), TOKEN_LITERAL_MAX_LEN):
+            run = literal[i:i + TOKEN_LITERAL_MAX_LEN]
+            out.append(len(run) - 1)
+            out.extend(run)
+        literal.clear()
+
+    def dictionary_match(offset: int) -> Optional[int]:
+        best: Optional[int] = None
+        for index, entry in enumerate(DICTIONARY):
+            if tx.startswith(entry, offset) and (best is None or len(entry) > len(DICTIONARY[best])):
+                best = index
+        return best
+
+    offset = 0
+    while offset < len(tx):
+        index = dictionary_match(offset)
+        if index is not None:
+            flush_literal()
+            out.append(TOKEN_DICTIONARY + index)
+            offset += len(DICTIONARY[index])
+            continue
+
+        value = tx[offset:offset + VALUE_LEN]
+        if len(value) == VALUE_LEN:
+            if value in values:
+                flush_literal()
+                out.append(TOKEN_BACK_REFERENCE + values.index(value))
+                offset += VALUE_LEN
+                continue
+            if len(values) < MAX_VALUES and tx.find(value, offset + VALUE_LEN) != -1:
+                flush_literal()
+                out.append(TOKEN_VALUE)
+                out.extend(value)
+                values.append(value)
+                offset += VALUE_LEN
+                continue
+
+        literal.append(tx[offset])
+        offset += 1
+
+    flush_literal()
+    return bytes(out)
+
+
+def expand(data: bytes) -> bytes:
+    """Decode the encoding, as the device does."""
+    out = bytearray()
+    values: List[bytes] = []
+    offset = 0
+
+    while offset < len(data):
+        token = data[offset]
+        offset += 1
+        if token < TOKEN_DICTIONARY:
+            run = data[offset:offset + token + 1]
+            if len(run) != token + 1:
+                raise ValueError("Truncated literal run")
+            out.extend(run)
+            offset += token + 1
+        elif token < TOKEN_BACK_REFERENCE:
+            out.extend(DICTIONARY[token - TOKEN_DICTIONARY])
+        elif token < TOKEN_VALUE:
+            out.extend(values[token - TOKEN_BACK_REFERENCE])
+        elif token == TOKEN_VALUE and len(values) < MAX_VALUES:
+            value = data[offset:offset + VALUE_LEN]
+            if len(value) != VALUE_LEN:
+                raise ValueError("Truncated value")
+            out.extend(value)
+            values.append(value)
+            offset += VALUE_LEN
+        else:
+            raise ValueError(f"Invalid token: {token:#x}")
+
+    return bytes(out)
@@ -59,3 +59,18 @@ def read_uint(buf: BytesIO,
         raise ValueError(f"Can't read u{bit_len} in buffer!")
 
     return int.from_bytes(b, byteorder)
+
+
+def compress_public_key(public_key: bytes) -> bytes:
+    """Compress an uncompressed (0x04 prefixed) public key."""
+    assert len(public_key) == 65 and public_key[0] == 0x04
+    return (b"\x03" if public_key[64] & 1 else b"\x02") + public_key[1:33]
+
+
+def public_key_script_hash(public_key: bytes) -> bytes:
+    """Script hash of the single signature verification script of an uncompressed public key."""
+    from neo3.core import to_script_hash
+
+    checksig = 0x27B3E756  # Syscall "System.Crypto.CheckSig"
+    script = b"\x0c\x21" + compress_public_key(public_key) + b"\x41" + checksig.to_bytes(4, "little")
+    return to_script_hash(script).to_array()
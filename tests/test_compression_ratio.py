@@ -0,0 +1,101 @@
+from hashlib import sha256
+from typing import List, Tuple
+
+from apps.neo_n3_cmd_builder import MAX_APDU_LEN
+from apps.tx_compression import compress, expand
+
+from neo3.network.payloads.transaction import Transaction
+from neo3.network.payloads.verification import Witness, WitnessScope, Signer
+from neo3.core import types, serialization
+from neo3 import vm
+from neo3.wallet.utils import address_to_script_hash
+from neo3.api.wrappers import NeoToken, GasToken
+
+
+ACCOUNTS = [address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM"),
+            address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf")] + \
+           [types.UInt160(sha256(bytes([i])).digest()[:20]) for i in range(4)]
+CANDIDATES = [bytes.fromhex("03b209fd4f53a7170ea4444e0cb0a6bb6a53c2bd016926989cf85f9b0fba17a70c"),
+              bytes.fromhex("02") + sha256(b"candidate").digest()]
+
+
+def serialize(sender: types.UInt160, script: bytes, nonce: int, extra_signers: List[Signer] = []) -> bytes:
+    signer = Signer(account=sender, scope=WitnessScope.CALLED_BY_ENTRY)
+    tx = Transaction(version=0,
+                     nonce=nonce,
+                     system_fee=997775 + nonce,
+                     network_fee=1236390 + 7 * nonce,
+                     valid_until_block=5260000 + nonce,
+                     attributes=[],
+                     signers=[signer] + extra_signers,
+                     script=script,
+                     witnesses=[Witness(invocation_script=b'', verification_script=b'\x55')])
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        return writer.to_array()
+
+
+def corpus() -> List[Tuple[str, bytes]]:
+    txs = []
+    nonce = 1
+    for token, name in ((NeoToken().hash, "NEO"), (GasToken().hash, "GAS")):
+        for amount in (1, 10, 150000000, 2 ** 40):
+            for sender, receiver in ((ACCOUNTS[0], ACCOUNTS[1]), (ACCOUNTS[2], ACCOUNTS[3])):
+                sb = vm.ScriptBuilder()
+                sb.emit_contract_call_with_args(token, "transfer",
+                                                [sender.to_array(), receiver.to_array(), amount, None])
+                txs.append((f"{name} transfer", serialize(sender, sb.to_array(), nonce)))
+                nonce += 1
+
+    # payout batch of NEO and GAS from one sender
+    sb = vm.ScriptBuilder()
+    for i, receiver in enumerate(ACCOUNTS[1:]):
+        token = NeoToken().hash if i % 2 == 0 else GasToken().hash
+        sb.emit_contract_call_with_args(token, "transfer", [ACCOUNTS[0].to_array(), receiver.to_array(), i + 1, None])
+    txs.append(("batched transfer", serialize(ACCOUNTS[0], sb.to_array(), nonce)))
+    nonce += 1
+
+    # transfer with a co-signer restricted to the GAS contract
+    co_signer = Signer(account=ACCOUNTS[4], scope=WitnessScope.CUSTOM_CONTRACTS)
+    co_signer.allowed_contracts.append(GasToken().hash)
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer",
+                                    [ACCOUNTS[4].to_array(), ACCOUNTS[5].to_array(), 100000000, None])
+    txs.append(("co-signed transfer", serialize(ACCOUNTS[0], sb.to_array(), nonce, [co_signer])))
+    nonce += 1
+
+    for sender in ACCOUNTS[:3]:
+        for vote_to in CANDIDATES + [None]:
+            sb = vm.ScriptBuilder()
+            sb.emit_contract_call_with_args(NeoToken().hash, "vote", [sender.to_array(), vote_to])
+            txs.append(("vote" if vote_to else "remove vote", serialize(sender, sb.to_array(), nonce)))
+            nonce += 1
+
+    return txs
+
+
+def test_compression_ratio():
+    """
+    Bytes on the wire of the transaction chunks, with and without the compressed encoding.
+    No device is needed: the encoding is checked against the reference expansion.
+    """
+    totals = {}
+    for kind, tx in corpus():
+        compressed = compress(tx)
+        assert expand(compressed) == tx
+
+        raw_len, compressed_len, count = totals.get(kind, (0, 0, 0))
+        totals[kind] = (raw_len + len(tx), compressed_len + len(compressed), count + 1)
+
+    raw_total = sum(raw for raw, _, _ in totals.values())
+    compressed_total = sum(compressed for _, compressed, _ in totals.values())
+    for kind, (raw_len, compressed_len, count) in totals.items():
+        print(f"{kind:>20}: {count:2} txs, {raw_len / count:6.1f} -> {compressed_len / count:6.1f} bytes "
+              f"({100 * (raw_len - compressed_len) / raw_len:4.1f}% saved)")
+    print(f"{'total':>20}: {raw_total} -> {compressed_total} bytes "
+          f"({100 * (raw_total - compressed_total) / raw_total:4.1f}% saved, "
+          f"{MAX_APDU_LEN} bytes per APDU)")
+
+    assert compressed_total < raw_total
+    for kind, (raw_len, compressed_len, _) in totals.items():
+        assert compressed_len < raw_len, kind
@@ -1,6 +1,10 @@
 from pathlib import Path
 
 from apps.neo_n3_cmd import Neo_n3_Command
+from apps.neo_n3_cmd_builder import PubkeyFormat
+from apps.utils import compress_public_key, public_key_script_hash
+
+from neo3.wallet.utils import address_to_script_hash
 
 from ragger.navigator import NavInsID, NavIns
 from ragger.bip import calculate_public_key_and_chaincode, CurveChoice
@@ -16,6 +20,45 @@ def test_get_public_key_no_confirm(backend, firmware):
         assert pub_key.hex() == ref_public_key
         print(pub_key.hex())
 
+def test_get_public_key_formats(backend, firmware):
+    client = Neo_n3_Command(backend)
+    for path in ["m/44'/888'/0'/0/0", "m/44'/888'/10'/1/23"]:
+        pub_key = client.get_public_key(bip44_path=path)
+
+        assert client.get_public_key_formatted(bip44_path=path, fmt=PubkeyFormat.UNCOMPRESSED) == pub_key
+        assert client.get_public_key_formatted(bip44_path=path, fmt=PubkeyFormat.COMPRESSED) == compress_public_key(pub_key)
+        assert client.get_public_key_formatted(bip44_path=path, fmt=PubkeyFormat.SCRIPT_HASH) == public_key_script_hash(pub_key)
+
+        address = client.get_public_key_formatted(bip44_path=path, fmt=PubkeyFormat.ADDRESS).decode("ascii")
+        assert address_to_script_hash(address).to_array() == public_key_script_hash(pub_key)
+
+def test_get_public_keys(backend, firmware):
+    client = Neo_n3_Command(backend)
+    for fmt, count in [(PubkeyFormat.COMPRESSED, 7), (PubkeyFormat.SCRIPT_HASH, 12)]:
+        keys = client.get_public_keys(bip44_path="m/44'/888'/0'/0/3", count=count, fmt=fmt)
+        for index, key in enumerate(keys):
+            pub_key = client.get_public_key(bip44_path=f"m/44'/888'/0'/0/{3 + index}")
+            if fmt == PubkeyFormat.COMPRESSED:
+                assert key == compress_public_key(pub_key)
+            else:
+                assert key == public_key_script_hash(pub_key)
+
+def test_get_public_keys_out_of_range(backend, firmware):
+    client = Neo_n3_Command(backend)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+
+    # too many keys for a single response
+    rapdu = backend.exchange_raw(client.builder.get_public_keys(bip44_path="m/44'/888'/0'/0/0",
+                                                                count=8,
+                                                                fmt=PubkeyFormat.COMPRESSED))
+    assert rapdu.status == 0x6A87 # Wrong data length
+
+    # last address index beyond the BIP44 validation range
+    rapdu = backend.exchange_raw(client.builder.get_public_keys(bip44_path="m/44'/888'/0'/0/4995",
+                                                                count=6,
+                                                                fmt=PubkeyFormat.SCRIPT_HASH))
+    assert rapdu.status == 0xB105 # Bad address index
+
 def test_get_public_key_confirm_ok(backend, scenario_navigator):
     client = Neo_n3_Command(backend)
     path = "m/44'/888'/0'/0/0"
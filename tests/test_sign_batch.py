@@ -0,0 +1,93 @@
+import struct
+from hashlib import sha256
+
+import pytest
+
+from apps.neo_n3_cmd import Neo_n3_Command
+
+from ecdsa.curves import NIST256p
+from ecdsa.keys import VerifyingKey
+from ecdsa.util import sigdecode_der
+
+from neo3.network.payloads.transaction import Transaction
+from neo3.network.payloads.verification import Witness, WitnessScope, Signer
+from neo3.core import serialization, types
+from neo3 import vm
+from neo3.wallet.utils import address_to_script_hash
+from neo3.api.wrappers import NeoToken, GasToken
+
+from ragger.backend import RaisePolicy
+
+BIP44_PATH: str = "m/44'/888'/0'/0/0"
+MAGIC: int = 860833102
+FROM_ACCOUNT = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+OTHER_ACCOUNT = types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654")
+TO_ACCOUNT = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf")
+
+
+def build_tx(token, method: str, args: list, nonce: int, account=FROM_ACCOUNT) -> Transaction:
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(token, method, args)
+    return Transaction(version=0,
+                       nonce=nonce,
+                       system_fee=997775,
+                       network_fee=1236390,
+                       valid_until_block=5260000,
+                       attributes=[],
+                       signers=[Signer(account=account, scope=WitnessScope.CALLED_BY_ENTRY)],
+                       script=sb.to_array(),
+                       witnesses=[Witness(invocation_script=b'', verification_script=b'\x55')])
+
+
+def build_transfer(token, amount: int, nonce: int, account=FROM_ACCOUNT) -> Transaction:
+    return build_tx(token, "transfer", [account.to_array(), TO_ACCOUNT.to_array(), amount, None], nonce, account)
+
+
+@pytest.mark.parametrize("compressed", [False, True])
+def test_sign_tx_batch(backend, scenario_navigator, compressed):
+    client = Neo_n3_Command(backend)
+
+    pub_key = client.get_public_key(bip44_path=BIP44_PATH)
+    pk: VerifyingKey = VerifyingKey.from_string(pub_key, curve=NIST256p, hashfunc=sha256)
+
+    txs = [build_transfer(NeoToken().hash, 10, 1),
+           build_transfer(GasToken().hash, 150000000, 2),
+           build_transfer(NeoToken().hash, 5, 3)]
+
+    with client.sign_tx_batch(bip44_path=BIP44_PATH, transactions=txs, network_magic=MAGIC, compressed=compressed):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    signatures = [backend.last_async_response.data] + client.get_batch_signatures(len(txs))
+
+    for tx, der_sig in zip(txs, signatures):
+        with serialization.BinaryWriter() as writer:
+            tx.serialize_unsigned(writer)
+            tx_data: bytes = writer.to_array()
+
+        assert pk.verify(signature=der_sig,
+                         data=struct.pack("I", MAGIC) + sha256(tx_data).digest(),
+                         hashfunc=sha256,
+                         sigdecode=sigdecode_der) is True
+
+
+@pytest.mark.parametrize("other_tx", [
+    build_tx(NeoToken().hash, "vote", [FROM_ACCOUNT.to_array(), None], 2),
+    # the review shows a single signer for the whole batch
+    build_transfer(GasToken().hash, 150000000, 2, OTHER_ACCOUNT),
+])
+def test_sign_tx_batch_unsupported_tx(backend, other_tx):
+    client = Neo_n3_Command(backend)
+
+    txs = [build_transfer(NeoToken().hash, 10, 1), other_tx]
+    chunks = list(client.builder.sign_tx_batch(bip44_path=BIP44_PATH, transactions=txs, network_magic=MAGIC))
+
+    for _, chunk in chunks[:-1]:
+        backend.exchange_raw(chunk)
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange_raw(chunks[-1][1])
+    assert rapdu.status == 0xB007  # Batch transaction unsupported
+
+    # signatures are only available once the batch is approved
+    rapdu = backend.exchange_raw(client.builder.get_batch_signature(0))
+    assert rapdu.status == 0xB004  # Bad state
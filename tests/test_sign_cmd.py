@@ -2,6 +2,8 @@ import struct
 from hashlib import sha256
 from pathlib import Path
 
+import pytest
+
 from apps.neo_n3_cmd import Neo_n3_Command
 
 from ecdsa.curves import NIST256p
@@ -13,9 +15,10 @@ from neo3.network.payloads.verification import Witness, WitnessScope, Signer
 from neo3.core import types, serialization
 from neo3 import contracts, vm
 from neo3.wallet.utils import address_to_script_hash
-from neo3.api.wrappers import NeoToken
+from neo3.api.wrappers import NeoToken, GasToken
 
 from ragger.navigator import NavInsID
+from ragger.backend import RaisePolicy
 
 ROOT_SCREENSHOT_PATH = Path(__file__).parent.resolve()
 
@@ -80,6 +83,487 @@ def test_sign_tx(backend, scenario_navigator):
                      sigdecode=sigdecode_der) is True
 
 
+def test_sign_tx_compact(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    pub_key = client.get_public_key(bip44_path=bip44_path)
+
+    pk: VerifyingKey = VerifyingKey.from_string(
+        pub_key,
+        curve=NIST256p,
+        hashfunc=sha256
+    )
+
+    signer = Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
+                    scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    # build a NEO transfer script, small enough to fit in a single APDU with the path and the magic
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM").to_array()
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(NeoToken().hash, "transfer", [from_account, to_account, 11, None])
+    tx = Transaction(version=0,
+                     nonce=123,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx_compact(bip44_path=bip44_path,
+                                transaction=tx,
+                                network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+def test_sign_tx_resumed_upload(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    pub_key = client.get_public_key(bip44_path=bip44_path)
+
+    pk: VerifyingKey = VerifyingKey.from_string(
+        pub_key,
+        curve=NIST256p,
+        hashfunc=sha256
+    )
+
+    signer = Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
+                    scope=WitnessScope.CUSTOM_CONTRACTS)
+    for i in range(1, 17):
+        signer.allowed_contracts.append(types.UInt160(20 * i.to_bytes(1, 'little')))
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM").to_array()
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(NeoToken().hash, "transfer", [from_account, to_account, 11, None])
+    tx = Transaction(version=0,
+                     nonce=123,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+    assert len(tx_data) > 400
+
+    # BIP44 path and network magic
+    chunks = list(client.builder.sign_tx(bip44_path=bip44_path, transaction=tx, network_magic=magic))
+    backend.exchange_raw(chunks[0][1])
+    backend.exchange_raw(chunks[1][1])
+
+    def send_at(offset: int, data: bytes) -> int:
+        rapdu = backend.exchange_raw(client.builder.sign_tx_chunk_at(offset, data, is_last=False))
+        return struct.unpack(">I", rapdu.data)[0]
+
+    assert send_at(0, tx_data[:200]) == 200
+    # the acknowledgement was lost: the same chunk again, then a query of the bytes received
+    assert send_at(0, tx_data[:200]) == 200
+    assert send_at(0, b"") == 200
+
+    # a gap in the transaction is refused
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange_raw(client.builder.sign_tx_chunk_at(300, tx_data[300:400], is_last=False))
+    assert rapdu.status == 0xB006  # Wrong tx offset
+    assert struct.unpack(">I", rapdu.data)[0] == 200
+    backend.raise_policy = RaisePolicy.RAISE_ALL_BUT_0x9000
+
+    # the part already received is skipped
+    assert send_at(100, tx_data[100:400]) == 400
+
+    with backend.exchange_async_raw(client.builder.sign_tx_chunk_at(400, tx_data[400:], is_last=True)):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+
+def test_sign_tx_compressed(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    pub_key = client.get_public_key(bip44_path=bip44_path)
+
+    pk: VerifyingKey = VerifyingKey.from_string(
+        pub_key,
+        curve=NIST256p,
+        hashfunc=sha256
+    )
+
+    # the sender is both the signer and the 'from' of the transfer, it is sent once
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    signer = Signer(account=from_account, scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer", [from_account.to_array(), to_account, 150000000, None])
+    tx = Transaction(version=0,
+                     nonce=123,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_path,
+                        transaction=tx,
+                        network_magic=magic,
+                        compressed=True):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    # the signature covers the transaction, not its encoding
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+def test_sign_tx_multiple_paths(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_paths = ["m/44'/888'/0'/0/0", "m/44'/888'/0'/0/1", "m/44'/888'/1'/0/0"]
+
+    pks = [VerifyingKey.from_string(client.get_public_key(bip44_path=path), curve=NIST256p, hashfunc=sha256)
+           for path in bip44_paths]
+
+    # a transfer from an account which needs the witnesses of the three accounts
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    signers = [Signer(account=from_account, scope=WitnessScope.CALLED_BY_ENTRY),
+               Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
+                      scope=WitnessScope.CALLED_BY_ENTRY),
+               Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac412345"),
+                      scope=WitnessScope.CALLED_BY_ENTRY)]
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(NeoToken().hash, "transfer", [from_account.to_array(), to_account, 5, None])
+    tx = Transaction(version=0,
+                     nonce=123,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=signers,
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_paths,
+                        transaction=tx,
+                        network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    signatures = Neo_n3_Command.split_signatures(backend.last_async_response.data)
+    assert len(signatures) == len(bip44_paths)
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    for pk, der_sig in zip(pks, signatures):
+        assert pk.verify(signature=der_sig,
+                         data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                         hashfunc=sha256,
+                         sigdecode=sigdecode_der) is True
+
+def test_sign_tx_retry(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    signer = Signer(account=from_account, scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(NeoToken().hash, "transfer", [from_account.to_array(), to_account, 3, None])
+    tx = Transaction(version=0,
+                     nonce=321,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_path,
+                        transaction=tx,
+                        network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    # the response was lost: the same transaction sent again gets the same signature, without a second review
+    for is_last, chunk in client.builder.sign_tx(bip44_path=bip44_path, transaction=tx, network_magic=magic):
+        rapdu = backend.exchange_raw(chunk)
+    assert rapdu.data == der_sig
+
+def test_resign_tx(backend, scenario_navigator):
+    if backend.firmware.device == "nanos":
+        pytest.skip("RESIGN_TX is not built for Nano S")
+
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    pk: VerifyingKey = VerifyingKey.from_string(client.get_public_key(bip44_path=bip44_path),
+                                                curve=NIST256p,
+                                                hashfunc=sha256)
+
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    signer = Signer(account=from_account, scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer", [from_account.to_array(), to_account, 100, None])
+    tx = Transaction(version=0,
+                     nonce=7,
+                     system_fee=997775,
+                     network_fee=1236390,
+                     valid_until_block=5260000,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_path,
+                        transaction=tx,
+                        network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    # the transaction expired: only the new network fee and validity are sent and reviewed
+    tx.network_fee = 2000000
+    tx.valid_until_block = 5265760
+    with client.resign_tx(nonce=tx.nonce,
+                          system_fee=tx.system_fee,
+                          network_fee=tx.network_fee,
+                          valid_until_block=tx.valid_until_block):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+    # the same values again, e.g. when the response was lost: nothing changes, but the transaction is reviewed again
+    with client.resign_tx(nonce=tx.nonce,
+                          system_fee=tx.system_fee,
+                          network_fee=tx.network_fee,
+                          valid_until_block=tx.valid_until_block):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    assert backend.last_async_response.data == der_sig
+
+
+def test_resign_tx_rejected(backend, scenario_navigator):
+    if backend.firmware.device == "nanos":
+        pytest.skip("RESIGN_TX is not built for Nano S")
+
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    signer = Signer(account=from_account, scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer", [from_account.to_array(), to_account, 100, None])
+    tx = Transaction(version=0,
+                     nonce=7,
+                     system_fee=997775,
+                     network_fee=1236390,
+                     valid_until_block=5260000,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_path,
+                        transaction=tx,
+                        network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    # no field changes: the signature is not sent again unless the user approves
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    with client.resign_tx(nonce=tx.nonce,
+                          system_fee=tx.system_fee,
+                          network_fee=tx.network_fee,
+                          valid_until_block=tx.valid_until_block):
+        scenario_navigator.review_reject(do_comparison=False)
+
+    assert backend.last_async_response.status == 0x6985  # Deny error
+    assert backend.last_async_response.data == b""
+
+def test_resign_tx_without_approval(backend):
+    client = Neo_n3_Command(backend)
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange_raw(client.builder.resign_tx(nonce=1, system_fee=0, network_fee=0, valid_until_block=1))
+    if backend.firmware.device == "nanos":
+        assert rapdu.status == 0x6D00  # Instruction not supported
+    else:
+        assert rapdu.status == 0xB004  # Bad state
+
+def test_sign_batched_transfer_tx(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    pub_key = client.get_public_key(bip44_path=bip44_path)
+
+    pk: VerifyingKey = VerifyingKey.from_string(
+        pub_key,
+        curve=NIST256p,
+        hashfunc=sha256
+    )
+
+    signer = Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
+                    scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    # a payout batch: NEO, GAS and an unknown NEP-17 token, of which the totals are reviewed per token
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM").to_array()
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    to_account2 = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM").to_array()
+    unknown_token = types.UInt160.from_string("5b7074e873973a6ed3708862f219a6fbf4d1c411")
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(NeoToken().hash, "transfer", [from_account, to_account, 11, None])
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer", [from_account, to_account, 150000000, None])
+    sb.emit_contract_call_with_args(NeoToken().hash, "transfer", [from_account, to_account2, 4, None])
+    sb.emit_contract_call_with_args(unknown_token, "transfer", [from_account, to_account2, 123456789, None])
+    tx = Transaction(version=0,
+                     nonce=123,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_path,
+                        transaction=tx,
+                        network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+
+def test_sign_big_amount_transfer_tx(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    bip44_path: str = "m/44'/888'/0'/0/0"
+
+    pub_key = client.get_public_key(bip44_path=bip44_path)
+
+    pk: VerifyingKey = VerifyingKey.from_string(
+        pub_key,
+        curve=NIST256p,
+        hashfunc=sha256
+    )
+
+    signer = Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
+                    scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+    magic = 860833102
+
+    # amounts beyond 64 bits are pushed with PUSHINT128 and PUSHINT256
+    from_account = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM").to_array()
+    to_account = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf").to_array()
+    sb = vm.ScriptBuilder()
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer", [from_account, to_account, 10**30, None])
+    sb.emit_contract_call_with_args(GasToken().hash, "transfer", [from_account, to_account, 2**200, None])
+    assert sb.to_array()[1] == vm.OpCode.PUSHINT128
+    tx = Transaction(version=0,
+                     nonce=123,
+                     system_fee=456,
+                     network_fee=789,
+                     valid_until_block=1,
+                     attributes=[],
+                     signers=[signer],
+                     script=sb.to_array(),
+                     witnesses=[witness])
+
+    with client.sign_tx(bip44_path=bip44_path,
+                        transaction=tx,
+                        network_magic=magic):
+        scenario_navigator.review_approve(do_comparison=False)
+
+    der_sig = backend.last_async_response.data
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", magic) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+
 def test_sign_vote_script_tx(backend, firmware, navigator, test_name):
     client = Neo_n3_Command(backend)
 
@@ -0,0 +1,208 @@
+import struct
+from hashlib import sha256
+from typing import List
+
+from apps.neo_n3_cmd import Neo_n3_Command
+
+from ecdsa.curves import NIST256p
+from ecdsa.keys import VerifyingKey
+from ecdsa.util import sigdecode_der
+
+from neo3.network.payloads.transaction import Transaction
+from neo3.network.payloads.verification import Witness, WitnessScope, Signer
+from neo3.core import types, serialization
+from neo3 import vm
+from neo3.wallet.utils import address_to_script_hash
+from neo3.api.wrappers import NeoToken, GasToken
+
+from ragger.navigator import NavInsID
+from ragger.backend import RaisePolicy
+
+from test_sign_streaming import allow_arbitrary_scripts, build_long_script_tx
+
+BIP44_PATH: str = "m/44'/888'/0'/0/0"
+MAGIC: int = 860833102
+FROM_ACCOUNT = address_to_script_hash("NSiVJYZej4XsxG5CUpdwn7VRQk8iiiDMPM")
+TO_ACCOUNT = address_to_script_hash("NU5unwNcWLqPM21cNCRP1LPuhxsTpYvNTf")
+
+
+def build_transfer(nonce: int, allowed_contracts: int = 0) -> Transaction:
+    """GAS transfer, whose signer allows 'allowed_contracts' contracts: 16 of them take a second chunk."""
+    signer = Signer(account=FROM_ACCOUNT,
+                    scope=WitnessScope.CUSTOM_CONTRACTS if allowed_contracts else WitnessScope.CALLED_BY_ENTRY)
+    for i in range(allowed_contracts):
+        signer.allowed_contracts.append(types.UInt160(20 * (i + 1).to_bytes(1, 'little')))
+
+    sb = vm.ScriptBuilder()
+    token = NeoToken().hash if nonce % 2 else GasToken().hash
+    sb.emit_contract_call_with_args(token, "transfer", [FROM_ACCOUNT.to_array(), TO_ACCOUNT.to_array(), nonce, None])
+    return Transaction(version=0,
+                       nonce=nonce,
+                       system_fee=997775,
+                       network_fee=1236390,
+                       valid_until_block=5260000,
+                       attributes=[],
+                       signers=[signer],
+                       script=sb.to_array(),
+                       witnesses=[Witness(invocation_script=b'', verification_script=b'\x55')])
+
+
+def verify(pk: VerifyingKey, tx: Transaction, der_sig: bytes) -> None:
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", MAGIC) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+
+def test_sign_session(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    pk: VerifyingKey = VerifyingKey.from_string(client.get_public_key(bip44_path=BIP44_PATH),
+                                                curve=NIST256p,
+                                                hashfunc=sha256)
+
+    client.sign_session_open(bip44_path=BIP44_PATH, network_magic=MAGIC)
+
+    for tx in (build_transfer(1), build_transfer(2, allowed_contracts=16), build_transfer(3)):
+        with client.sign_session_tx(transaction=tx):
+            scenario_navigator.review_approve(do_comparison=False)
+        verify(pk, tx, backend.last_async_response.data)
+
+    # other commands don't close the session
+    assert client.get_app_name() == "NEO N3"
+    with client.sign_session_tx(transaction=build_transfer(4), compressed=True):
+        scenario_navigator.review_approve(do_comparison=False)
+    verify(pk, build_transfer(4), backend.last_async_response.data)
+
+    client.sign_session_close()
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    _, chunk = next(client.builder.sign_session_tx(transaction=build_transfer(5)))
+    rapdu = backend.exchange_raw(chunk)
+    assert rapdu.status == 0xB004  # Bad state
+
+
+def test_sign_session_chunks_from_other_instruction(backend, scenario_navigator):
+    client = Neo_n3_Command(backend)
+
+    pk: VerifyingKey = VerifyingKey.from_string(client.get_public_key(bip44_path=BIP44_PATH),
+                                                curve=NIST256p,
+                                                hashfunc=sha256)
+
+    client.sign_session_open(bip44_path=BIP44_PATH, network_magic=MAGIC)
+    tx = build_transfer(2, allowed_contracts=16)
+    session_chunks = [chunk for _, chunk in client.builder.sign_session_tx(transaction=tx)]
+    sign_tx_chunks = [chunk for _, chunk in client.builder.sign_tx(bip44_path=BIP44_PATH, transaction=tx,
+                                                                   network_magic=MAGIC)]
+    assert len(session_chunks) == 2 and len(sign_tx_chunks) == 4
+
+    # SIGN_TX can't continue a transaction of the session
+    backend.exchange_raw(session_chunks[0])
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert backend.exchange_raw(sign_tx_chunks[3]).status == 0xB004  # Bad state
+    backend.raise_policy = RaisePolicy.RAISE_ALL_BUT_0x9000
+
+    with backend.exchange_async_raw(session_chunks[1]):
+        scenario_navigator.review_approve(do_comparison=False)
+    verify(pk, tx, backend.last_async_response.data)
+
+    # nor the session a SIGN_TX transaction
+    for chunk in sign_tx_chunks[:3]:
+        backend.exchange_raw(chunk)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert backend.exchange_raw(session_chunks[1]).status == 0xB004  # Bad state
+    backend.raise_policy = RaisePolicy.RAISE_ALL_BUT_0x9000
+
+    with backend.exchange_async_raw(sign_tx_chunks[3]):
+        scenario_navigator.review_approve(do_comparison=False)
+    verify(pk, tx, backend.last_async_response.data)
+
+    client.sign_session_close()
+
+
+def test_sign_session_streamed_review(backend, navigator):
+    client = Neo_n3_Command(backend)
+
+    pk: VerifyingKey = VerifyingKey.from_string(client.get_public_key(bip44_path=BIP44_PATH),
+                                                curve=NIST256p,
+                                                hashfunc=sha256)
+
+    allow_arbitrary_scripts(backend, navigator)
+    client.sign_session_open(bip44_path=BIP44_PATH, network_magic=MAGIC)
+
+    tx = build_long_script_tx()
+    chunks = list(client.builder.sign_session_tx(transaction=tx))
+
+    # the first chunk holds the script length: the review starts, the next chunks of the session are still accepted
+    backend.exchange_raw(chunks[0][1])
+    backend.wait_for_screen_change()
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert backend.exchange_raw(client.builder.get_app_name()).status == 0xB004  # Bad state
+    _, first_chunk = next(client.builder.sign_session_tx(transaction=build_transfer(1)))
+    assert backend.exchange_raw(first_chunk).status == 0xB004  # Bad state
+    backend.raise_policy = RaisePolicy.RAISE_ALL_BUT_0x9000
+
+    for _, chunk in chunks[1:-1]:
+        backend.exchange_raw(chunk)
+
+    with backend.exchange_async_raw(chunks[-1][1]):
+        if backend.firmware.device.startswith("nano"):
+            navigator.navigate_until_text(navigate_instruction=NavInsID.RIGHT_CLICK,
+                                          validation_instructions=[NavInsID.BOTH_CLICK],
+                                          text="Approve",
+                                          screen_change_before_first_instruction=False)
+        elif backend.firmware.device == "flex" or backend.firmware.device == "stax":
+            navigator.navigate_until_text(NavInsID.SWIPE_CENTER_TO_LEFT,
+                                          [NavInsID.USE_CASE_REVIEW_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
+                                          "Hold to sign",
+                                          screen_change_before_first_instruction=False)
+    verify(pk, tx, backend.last_async_response.data)
+
+    client.sign_session_close()
+
+
+def test_sign_session_apdus_per_signature(backend, scenario_navigator):
+    """
+    APDUs and bytes sent per signature, with SIGN_TX and within a session, for transactions of one and two chunks.
+    Run on Speculos with -s to see the figures: doc/COMMANDS.md only gives the counts expected from the APDU layout.
+    """
+    client = Neo_n3_Command(backend)
+    pk: VerifyingKey = VerifyingKey.from_string(client.get_public_key(bip44_path=BIP44_PATH),
+                                                curve=NIST256p,
+                                                hashfunc=sha256)
+    txs: List[Transaction] = [build_transfer(nonce, allowed_contracts=16 if nonce % 4 == 0 else 0)
+                              for nonce in range(1, 9)]
+
+    def sign(chunks: List[bytes], tx: Transaction) -> None:
+        for chunk in chunks[:-1]:
+            backend.exchange_raw(chunk)
+        with backend.exchange_async_raw(chunks[-1]):
+            scenario_navigator.review_approve(do_comparison=False)
+        verify(pk, tx, backend.last_async_response.data)
+
+    before: List[bytes] = []
+    for tx in txs:
+        chunks = [chunk for _, chunk in client.builder.sign_tx(bip44_path=BIP44_PATH, transaction=tx,
+                                                               network_magic=MAGIC)]
+        sign(chunks, tx)
+        before += chunks
+
+    after: List[bytes] = [client.builder.sign_session_open(bip44_path=BIP44_PATH, network_magic=MAGIC)]
+    backend.exchange_raw(after[0])
+    for tx in txs:
+        chunks = [chunk for _, chunk in client.builder.sign_session_tx(transaction=tx)]
+        sign(chunks, tx)
+        after += chunks
+    after.append(client.builder.sign_session_close())
+    backend.exchange_raw(after[-1])
+
+    for name, apdus in (("SIGN_TX", before), ("SIGN_SESSION", after)):
+        print(f"{name:>12}: {len(apdus) / len(txs):.2f} APDUs, "
+              f"{sum(len(apdu) for apdu in apdus) / len(txs):.1f} bytes per signature")
+
+    assert len(after) < len(before)
@@ -0,0 +1,138 @@
+import struct
+from hashlib import sha256
+
+from apps.neo_n3_cmd import Neo_n3_Command
+
+from ecdsa.curves import NIST256p
+from ecdsa.keys import VerifyingKey
+from ecdsa.util import sigdecode_der
+
+from neo3.network.payloads.transaction import Transaction
+from neo3.network.payloads.verification import Witness, WitnessScope, Signer
+from neo3.core import types, serialization
+from neo3 import vm
+from neo3.api.wrappers import NeoToken
+
+from ragger.navigator import NavInsID, NavIns
+from ragger.backend import RaisePolicy
+
+
+BIP44_PATH = "m/44'/888'/0'/0/0"
+MAGIC = 860833102
+
+
+def allow_arbitrary_scripts(backend, navigator):
+    if backend.firmware.device.startswith("nano"):
+        navigator.navigate_until_text(navigate_instruction=NavInsID.RIGHT_CLICK,
+                                      validation_instructions=[NavInsID.BOTH_CLICK, NavInsID.BOTH_CLICK],
+                                      text="Setting",
+                                      screen_change_before_first_instruction=False)
+    elif backend.firmware.device == "stax" or backend.firmware.device == "flex":
+        navigator.navigate([NavInsID.USE_CASE_HOME_SETTINGS,
+                            NavIns(NavInsID.TOUCH, (350,115)),
+                            NavInsID.USE_CASE_SETTINGS_MULTI_PAGE_EXIT],
+                           screen_change_before_first_instruction=False)
+
+
+def build_long_script_tx() -> Transaction:
+    signer = Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
+                    scope=WitnessScope.CALLED_BY_ENTRY)
+    witness = Witness(invocation_script=b'', verification_script=b'\x55')
+
+    # the script takes several APDUs: the review starts with the chunk holding its length
+    sb = vm.ScriptBuilder()
+    sb.emit_push(b'\x42' * 1500)
+    sb.emit(vm.OpCode.DROP)
+    sb.emit_contract_call_with_args(NeoToken().hash, "arbitrary", [])
+
+    return Transaction(version=0,
+                       nonce=123,
+                       system_fee=456,
+                       network_fee=789,
+                       valid_until_block=1,
+                       attributes=[],
+                       signers=[signer],
+                       script=sb.to_array(),
+                       witnesses=[witness])
+
+
+def test_sign_tx_streamed_review(backend, firmware, navigator):
+    client = Neo_n3_Command(backend)
+
+    pub_key = client.get_public_key(bip44_path=BIP44_PATH)
+    pk: VerifyingKey = VerifyingKey.from_string(pub_key, curve=NIST256p, hashfunc=sha256)
+
+    allow_arbitrary_scripts(backend, navigator)
+    tx = build_long_script_tx()
+    chunks = list(client.builder.sign_tx(bip44_path=BIP44_PATH, transaction=tx, network_magic=MAGIC))
+
+    # the header is displayed while the rest of the transaction is received
+    backend.exchange_raw(chunks[0][1])
+    backend.exchange_raw(chunks[1][1])
+    backend.exchange_raw(chunks[2][1])
+    backend.wait_for_screen_change()
+
+    # nothing else is accepted until the review ends
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    assert backend.exchange_raw(client.builder.get_app_name()).status == 0xB004  # Bad state
+    backend.raise_policy = RaisePolicy.RAISE_ALL_BUT_0x9000
+
+    for _, chunk in chunks[3:-1]:
+        backend.exchange_raw(chunk)
+
+    with backend.exchange_async_raw(chunks[-1][1]):
+        if backend.firmware.device.startswith("nano"):
+            navigator.navigate_until_text(navigate_instruction=NavInsID.RIGHT_CLICK,
+                                          validation_instructions=[NavInsID.BOTH_CLICK],
+                                          text="Approve",
+                                          screen_change_before_first_instruction=False)
+        elif backend.firmware.device == "flex" or backend.firmware.device == "stax":
+            navigator.navigate_until_text(NavInsID.SWIPE_CENTER_TO_LEFT,
+                                          [NavInsID.USE_CASE_REVIEW_CONFIRM, NavInsID.USE_CASE_STATUS_DISMISS],
+                                          "Hold to sign",
+                                          screen_change_before_first_instruction=False)
+
+    der_sig = backend.last_async_response.data
+
+    with serialization.BinaryWriter() as writer:
+        tx.serialize_unsigned(writer)
+        tx_data: bytes = writer.to_array()
+
+    assert pk.verify(signature=der_sig,
+                     data=struct.pack("I", MAGIC) + sha256(tx_data).digest(),
+                     hashfunc=sha256,
+                     sigdecode=sigdecode_der) is True
+
+
+def test_sign_tx_streamed_review_rejected(backend, firmware, navigator):
+    client = Neo_n3_Command(backend)
+
+    allow_arbitrary_scripts(backend, navigator)
+    chunks = list(client.builder.sign_tx(bip44_path=BIP44_PATH, transaction=build_long_script_tx(),
+                                         network_magic=MAGIC))
+
+    backend.exchange_raw(chunks[0][1])
+    backend.exchange_raw(chunks[1][1])
+    backend.exchange_raw(chunks[2][1])
+    backend.wait_for_screen_change()
+
+    # rejected before the end of the transaction is received
+    if backend.firmware.device.startswith("nano"):
+        navigator.navigate_until_text(navigate_instruction=NavInsID.RIGHT_CLICK,
+                                      validation_instructions=[NavInsID.BOTH_CLICK],
+                                      text="Reject",
+                                      screen_change_before_first_instruction=False)
+    elif backend.firmware.device == "flex" or backend.firmware.device == "stax":
+        navigator.navigate([NavInsID.USE_CASE_REVIEW_REJECT,
+                            NavInsID.USE_CASE_CHOICE_CONFIRM,
+                            NavInsID.USE_CASE_STATUS_DISMISS],
+                           screen_change_before_first_instruction=False)
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange_raw(chunks[3][1])
+    assert rapdu.status == 0x6985  # Deny error
+    assert rapdu.data == b""
+
+    # the rest of the transaction is no longer expected
+    rapdu = backend.exchange_raw(chunks[4][1])
+    assert rapdu.status == 0xB004  # Bad state
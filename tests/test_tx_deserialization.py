@@ -5,7 +5,7 @@ import struct
 import logging
 
 from apps.neo_n3_cmd import Neo_n3_Command
-from apps.neo_n3_cmd_builder import InsType, Neo_n3_CommandBuilder
+from apps.neo_n3_cmd_builder import InsType, Neo_n3_CommandBuilder, P2_COMPRESSED
 from apps.exception import errors, DeviceException
 
 from ragger.backend.interface import BackendInterface, RAPDU
@@ -52,8 +52,7 @@ class ParserStatus(enum.IntEnum):
     ATTRIBUTES_DUPLICATE_TYPE = -25
     SCRIPT_LENGTH_PARSING_ERROR = -26
     SCRIPT_LENGTH_VALUE_ERROR = -27
-    SIGNER_SCOPE_GROUPS_NOT_ALLOWED_ERROR = -28
-    SIGNER_SCOPE_CONTRACTS_NOT_ALLOWED_ERROR = -29
+    COMPRESSED_DATA_ERROR = -28
 
 
 PARSER_RE = re.compile("\s+(?P<name>.*) = (?P<value>-?\d{1,2})")
@@ -217,14 +216,14 @@ def test_signers_length(backend, firmware):
 
 
 def test_signers_length2(backend, firmware):
-    # test signer length too large (3 vs max 2 allowed)
+    # test signer length too large (17 vs max 16 allowed)
     send_bip44_and_magic(backend)
     version = b'\x00'
     nonce = b'\x00' * 4
     system_fee = struct.pack(">q", 0)
     network_fee = struct.pack(">q", 0)
     valid_until_block = b'\x00' * 4
-    signer_length = b'\x03'  # max allowed is 2
+    signer_length = b'\x11'  # max allowed is 16
     backend.raise_policy = RaisePolicy.RAISE_NOTHING
     rapdu = send_raw_tx_data(backend, version + nonce + system_fee + network_fee + valid_until_block + signer_length)
     assert DeviceException.exc[rapdu.status] == errors.TxParsingFailError
@@ -339,7 +338,7 @@ def test_signers_scope_groups(backend, firmware):
 
     scope = WitnessScope.CUSTOM_GROUPS
     scope = scope.to_bytes(1, 'little')
-    groups_count = b'\x03'
+    groups_count = b'\x11'  # max allowed is 16
 
     data = version + nonce + system_fee + network_fee + valid_until_block + signer_length + account + scope + groups_count
     backend.raise_policy = RaisePolicy.RAISE_NOTHING
@@ -348,6 +347,33 @@ def test_signers_scope_groups(backend, firmware):
     assert int.from_bytes(rapdu.data, 'little', signed=True) == ParserStatus.SIGNER_ALLOWED_GROUPS_LENGTH_VALUE_ERROR
 
 
+def test_signers_data_exhausted(backend, firmware):
+    # the allowed contracts and groups of all signers share a pool of 16 groups, the second signer doesn't fit
+    send_bip44_and_magic(backend)
+    version = b'\x00'
+    nonce = b'\x00' * 4
+    system_fee = struct.pack(">q", 0)
+    network_fee = struct.pack(">q", 0)
+    valid_until_block = b'\x00' * 4
+    signer_length = b'\x02'
+
+    scope = WitnessScope.CUSTOM_GROUPS
+    scope = scope.to_bytes(1, 'little')
+    groups_count = b'\x10'
+    groups = b'\x02' * 33 * 16
+
+    data = version + nonce + system_fee + network_fee + valid_until_block + signer_length
+    data += b'\x00' * 20 + scope + groups_count + groups
+    data += b'\x01' * 20 + scope + groups_count
+    # the first chunks only hold the first signer and are accepted
+    backend.exchange_raw(serialize(cla=CLA, ins=InsType.INS_SIGN_TX, p1=0x02, p2=0x80, cdata=data[:255]))
+    backend.exchange_raw(serialize(cla=CLA, ins=InsType.INS_SIGN_TX, p1=0x03, p2=0x80, cdata=data[255:510]))
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange_raw(serialize(cla=CLA, ins=InsType.INS_SIGN_TX, p1=0x04, p2=0x00, cdata=data[510:]))
+    assert DeviceException.exc[rapdu.status] == errors.TxParsingFailError
+    assert int.from_bytes(rapdu.data, 'little', signed=True) == ParserStatus.SIGNER_ALLOWED_GROUPS_LENGTH_VALUE_ERROR
+
+
 def test_signers_scope_groups_no_data(backend, firmware):
     send_bip44_and_magic(backend)
     version = b'\x00'
@@ -394,8 +420,8 @@ def test_attributes_value(backend, firmware):
     send_bip44_and_magic(backend)
     signer = Signer(account=types.UInt160.from_string("d7678dd97c000be3f33e9362e673101bac4ca654"),
                     scope=WitnessScope.CALLED_BY_ENTRY)
-    # exceed max attributes count (2)
-    attributes = [HighPriorityAttribute(), HighPriorityAttribute(), HighPriorityAttribute()]
+    # exceed max attributes count (16 - 1 signer)
+    attributes = [HighPriorityAttribute()] * 16
     tx = Transaction(version=0, nonce=0, system_fee=0, network_fee=0, valid_until_block=1, signers=[signer],
                      attributes=attributes)
 
@@ -462,3 +488,39 @@ def test_script(backend, firmware):
     rapdu = send_raw_tx_data(backend, data)
     assert DeviceException.exc[rapdu.status] == errors.TxParsingFailError
     assert int.from_bytes(rapdu.data, 'little', signed=True) == ParserStatus.SCRIPT_LENGTH_VALUE_ERROR
+
+
+def test_compressed_invalid_token(backend, firmware):
+    backend.exchange_raw(serialize(cla=CLA,
+                                   ins=InsType.INS_SIGN_TX,
+                                   p1=0x00,
+                                   p2=0x80,
+                                   cdata=pack_derivation_path(bip44_path)[1:])) # No length prefix
+    backend.exchange_raw(serialize(cla=CLA,
+                                   ins=InsType.INS_SIGN_TX,
+                                   p1=0x01,
+                                   p2=0x80 | P2_COMPRESSED,
+                                   cdata=struct.pack("I", network_magic)))
+
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    # version 0 as a literal run, then a back-reference to a value that was never sent
+    rapdu = backend.exchange_raw(serialize(cla=CLA,
+                                           ins=InsType.INS_SIGN_TX,
+                                           p1=0x02,
+                                           p2=0x00 | P2_COMPRESSED,
+                                           cdata=bytes([0x00, 0x00, 0xC0])))
+    assert DeviceException.exc[rapdu.status] == errors.TxParsingFailError
+    assert int.from_bytes(rapdu.data, 'little', signed=True) == ParserStatus.COMPRESSED_DATA_ERROR
+
+
+def test_compressed_chunk_encoding_mismatch(backend, firmware):
+    send_bip44_and_magic(backend)
+
+    # the encoding is selected with the network magic
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+    rapdu = backend.exchange_raw(serialize(cla=CLA,
+                                           ins=InsType.INS_SIGN_TX,
+                                           p1=0x02,
+                                           p2=0x00 | P2_COMPRESSED,
+                                           cdata=bytes([0x00, 0x00])))
+    assert DeviceException.exc[rapdu.status] == errors.WrongP1P2Error
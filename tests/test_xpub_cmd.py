@@ -0,0 +1,38 @@
+from apps.neo_n3_cmd import Neo_n3_Command
+from apps import bip32
+
+from ragger.bip import calculate_public_key_and_chaincode, CurveChoice
+from ragger.backend import RaisePolicy
+
+
+def test_get_account_xpub(backend, firmware):
+    client = Neo_n3_Command(backend)
+    for account in [0, 1, 16]:
+        path = f"m/44'/888'/{account}'"
+        public_key, chain_code = client.get_account_xpub(bip44_path=path)
+
+        ref_public_key, ref_chain_code = calculate_public_key_and_chaincode(curve=CurveChoice.Nist256p1,
+                                                                            path=path,
+                                                                            compress_public_key=True)
+        assert public_key.hex() == ref_public_key
+        assert chain_code.hex() == ref_chain_code
+
+def test_account_xpub_host_derivation(backend, firmware):
+    client = Neo_n3_Command(backend)
+    public_key, chain_code = client.get_account_xpub(bip44_path="m/44'/888'/0'")
+
+    # every change/address key is derived on the host and must match the device
+    for change in [0, 1]:
+        for index in range(0, 10):
+            derived = bip32.derive_uncompressed(public_key, chain_code, [change, index])
+            assert derived == client.get_public_key(bip44_path=f"m/44'/888'/0'/{change}/{index}")
+
+def test_get_account_xpub_invalid_path(backend, firmware):
+    client = Neo_n3_Command(backend)
+    backend.raise_policy = RaisePolicy.RAISE_NOTHING
+
+    rapdu = backend.exchange_raw(client.builder.get_account_xpub(bip44_path="m/44'/888'/0"))
+    assert rapdu.status == 0xB102 # Account not hardened
+
+    rapdu = backend.exchange_raw(client.builder.get_account_xpub(bip44_path="m/44'/888'/17'"))
+    assert rapdu.status == 0xB103 # Bad account
@@ -0,0 +1,216 @@
+/**
+ * Native micro-benchmark of the decimal formatting kernels.
+ *
+ * Compares format_u64() and format_i64() with the previous digit-by-digit
+ * implementations (64-bit '% 10' and '/ 10' per digit), and format_u256()
+ * with a digit-by-digit long division of its limbs, after checking that both
+ * produce the same strings. Host timings only give a relative idea: on
+ * the Cortex-M0 of the Nano S every 64-bit division is a software call.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "common/format.h"
+
+#define NB_VALUES     1024
+#define NB_ITERATIONS 2000
+
+static bool legacy_format_u64(char *out, size_t outLen, uint64_t in) {
+    size_t i = 0;
+
+    if (outLen == 0) {
+        return false;
+    }
+    outLen--;
+
+    while (in > 9) {
+        out[i] = in % 10 + '0';
+        in /= 10;
+        i++;
+        if (i + 1 > outLen) {
+            return false;
+        }
+    }
+    out[i] = in + '0';
+    out[i + 1] = '\0';
+
+    size_t j = 0;
+    char tmp;
+
+    while (j < i) {
+        tmp = out[j];
+        out[j] = out[i];
+        out[i] = tmp;
+
+        i--;
+        j++;
+    }
+    return true;
+}
+
+static bool legacy_format_i64(char *dst, size_t dst_len, const int64_t value) {
+    char temp[] = "-9223372036854775808";
+
+    char *ptr = temp;
+    int64_t num = value;
+    int sign = 1;
+
+    if (value < 0) {
+        sign = -1;
+    }
+
+    while (num != 0) {
+        *ptr++ = '0' + (num % 10) * sign;
+        num /= 10;
+    }
+
+    if (value < 0) {
+        *ptr++ = '-';
+    } else if (value == 0) {
+        *ptr++ = '0';
+    }
+
+    int distance = (ptr - temp) + 1;
+
+    if ((int) dst_len < distance) {
+        return false;
+    }
+
+    size_t index = 0;
+
+    while (--ptr >= temp) {
+        dst[index++] = *ptr;
+    }
+
+    dst[index] = '\0';
+
+    return true;
+}
+
+/**
+ * One long division of the limbs by 10 per digit.
+ */
+static bool naive_format_u256(char *dst, size_t dst_len, const uint256_t *value) {
+    uint256_t rest = *value;
+    char reversed[UINT256_MAX_DIGITS];
+    size_t len = 0;
+    bool zero;
+
+    do {
+        uint64_t remainder = 0;
+        zero = true;
+        for (int i = UINT256_LIMBS - 1; i >= 0; i--) {
+            const uint64_t current = (remainder << 32) | rest.limbs[i];
+            rest.limbs[i] = (uint32_t) (current / 10);
+            remainder = current % 10;
+            zero = zero && rest.limbs[i] == 0;
+        }
+        reversed[len++] = (char) ('0' + remainder);
+    } while (!zero);
+
+    if (dst_len < len + 1) {
+        return false;
+    }
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = reversed[len - 1 - i];
+    }
+    dst[len] = '\0';
+
+    return true;
+}
+
+static double now_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+// checksum of the outputs, so that the compiler can't drop the calls
+static volatile uint32_t g_sink;
+
+#define BENCH(name, call)                                                             \
+    do {                                                                              \
+        char out[UINT256_MAX_DIGITS + 2 + 18];                                        \
+        uint32_t sink = 0;                                                            \
+        const double start = now_ns();                                                \
+        for (int it = 0; it < NB_ITERATIONS; it++) {                                  \
+            for (int i = 0; i < NB_VALUES; i++) {                                     \
+                call;                                                                 \
+                sink += (uint8_t) out[0];                                             \
+            }                                                                         \
+        }                                                                             \
+        const double elapsed = now_ns() - start;                                      \
+        g_sink = sink;                                                                \
+        printf("%-18s %8.2f ns/call\n", name, elapsed / (NB_ITERATIONS * NB_VALUES)); \
+    } while (0)
+
+int main(void) {
+    static uint64_t values[NB_VALUES];
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+
+    // amounts as they show up in a review: from a few units to the full 64-bit range
+    for (int i = 0; i < NB_VALUES; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        values[i] = seed >> (i % 64);
+    }
+
+    for (int i = 0; i < NB_VALUES; i++) {
+        char expected[22];
+        char actual[22];
+
+        if (!legacy_format_u64(expected, sizeof(expected), values[i]) ||
+            !format_u64(actual, sizeof(actual), values[i]) || strcmp(expected, actual) != 0) {
+            fprintf(stderr, "format_u64 mismatch for value #%d\n", i);
+            return 1;
+        }
+        if (!legacy_format_i64(expected, sizeof(expected), (int64_t) values[i]) ||
+            !format_i64(actual, sizeof(actual), (int64_t) values[i]) ||
+            strcmp(expected, actual) != 0) {
+            fprintf(stderr, "format_i64 mismatch for value #%d\n", i);
+            return 1;
+        }
+    }
+
+    BENCH("legacy_format_u64", legacy_format_u64(out, sizeof(out), values[i]));
+    BENCH("format_u64", format_u64(out, sizeof(out), values[i]));
+    BENCH("legacy_format_i64", legacy_format_i64(out, sizeof(out), (int64_t) values[i]));
+    BENCH("format_i64", format_i64(out, sizeof(out), (int64_t) values[i]));
+    BENCH("format_fpu64", format_fpu64(out, sizeof(out), values[i] >> 8, 8));
+
+    // PUSHINT128 amounts of 18 decimals tokens, then full 256-bit values
+    static uint256_t values_128[NB_VALUES];
+    static uint256_t values_256[NB_VALUES];
+
+    for (int i = 0; i < NB_VALUES; i++) {
+        for (int j = 0; j < UINT256_LIMBS; j++) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            values_256[i].limbs[j] = (uint32_t) (seed >> 32);
+            values_128[i].limbs[j] = (j < 4) ? values_256[i].limbs[j] : 0;
+        }
+        values_128[i].limbs[3] >>= i % 32;
+    }
+
+    for (int i = 0; i < NB_VALUES; i++) {
+        char expected[UINT256_MAX_DIGITS + 1];
+        char actual[UINT256_MAX_DIGITS + 1];
+
+        if (!naive_format_u256(expected, sizeof(expected), &values_256[i]) ||
+            !format_u256(actual, sizeof(actual), &values_256[i]) || strcmp(expected, actual) != 0) {
+            fprintf(stderr, "format_u256 mismatch for value #%d\n", i);
+            return 1;
+        }
+    }
+
+    BENCH("naive_format_u128", naive_format_u256(out, sizeof(out), &values_128[i]));
+    BENCH("format_u128", format_u256(out, sizeof(out), &values_128[i]));
+    BENCH("naive_format_u256", naive_format_u256(out, sizeof(out), &values_256[i]));
+    BENCH("format_u256", format_u256(out, sizeof(out), &values_256[i]));
+    BENCH("format_fpu256", format_fpu256(out, sizeof(out), &values_128[i], 18));
+
+    return 0;
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <stddef.h>  // size_t
+#include <stdint.h>  // uint*_t
+
+/**
+ * Stand-in for the cx.h of the SDK in unit tests: only the hash context held in G_context, with the layout of the
+ * SDK, so that the structures of types.h have the same fields as on the device.
+ */
+typedef struct cx_hash_info_s cx_hash_info_t;
+
+typedef struct cx_hash_header_s {
+    const cx_hash_info_t *info;
+    uint32_t counter;
+} cx_hash_t;
+
+typedef struct cx_sha256_s {
+    cx_hash_t header;
+    size_t blen;
+    uint8_t block[64];
+    uint8_t acc[8 * 4];
+} cx_sha256_t;
@@ -27,8 +27,65 @@ static void test_base58(void **state) {
     assert_string_equal((char *) out2, expected_out2);
 }
 
+static void check_encode_address(const uint8_t in[static BASE58_ADDRESS_INPUT_SIZE]) {
+    char expected[64] = {0};
+    char out[64] = {0};
+
+    const int expected_len = base58_encode(in, BASE58_ADDRESS_INPUT_SIZE, expected, sizeof(expected));
+    const int out_len = base58_encode_address(in, out, sizeof(out));
+    assert_int_equal(out_len, expected_len);
+    assert_string_equal(out, expected);
+
+    // exact fit, then one byte short
+    assert_int_equal(base58_encode_address(in, out, expected_len), expected_len);
+    assert_int_equal(base58_encode_address(in, out, expected_len - 1), -1);
+}
+
+static void test_base58_encode_address(void **state) {
+    (void) state;
+
+    // version byte, script hash 0x0b6ac9b2bc1cc0d79a28fec2a2d5b1eb3e8ec0d3 (little-endian) and checksum
+    const uint8_t address[BASE58_ADDRESS_INPUT_SIZE] = {
+        0x35, 0xd3, 0xc0, 0x8e, 0x3e, 0xeb, 0xb1, 0xd5, 0xa2, 0xc2, 0xfe, 0x28, 0x9a,
+        0xd7, 0xc0, 0x1c, 0xbc, 0xb2, 0xc9, 0x6a, 0x0b, 0x1c, 0x53, 0x98, 0xab};
+    char address_out[64] = {0};
+    assert_int_equal(base58_encode_address(address, address_out, sizeof(address_out)), 34);
+    assert_string_equal(address_out, "NfDcSEUSrUKCDpwGmg1JrrkYw1EYPhcQVY");
+    check_encode_address(address);
+
+    uint8_t in[BASE58_ADDRESS_INPUT_SIZE];
+
+    memset(in, 0x00, sizeof(in));
+    check_encode_address(in);
+    memset(in, 0xFF, sizeof(in));
+    check_encode_address(in);
+
+    // leading zero bytes and single set bytes at every position
+    for (size_t i = 0; i < sizeof(in); i++) {
+        memset(in, 0x00, sizeof(in));
+        in[i] = 0x01;
+        check_encode_address(in);
+        in[i] = 0xFF;
+        check_encode_address(in);
+        memset(in, 0xFF, sizeof(in));
+        memset(in, 0x00, i);
+        check_encode_address(in);
+    }
+
+    // pseudo-random payloads
+    uint32_t seed = 0x12345678;
+    for (int n = 0; n < 20000; n++) {
+        for (size_t i = 0; i < sizeof(in); i++) {
+            seed = seed * 1103515245u + 12345u;
+            in[i] = (uint8_t) (seed >> 16);
+        }
+        check_encode_address(in);
+    }
+}
+
 int main() {
-    const struct CMUnitTest tests[] = {cmocka_unit_test(test_base58)};
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_base58),
+                                       cmocka_unit_test(test_base58_encode_address)};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
 }
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "transaction/expander.h"
+
+#define TO_ACCOUNT                                                                                              \
+    0x6d, 0xfb, 0xd7, 0x5c, 0x6d, 0x7a, 0x3e, 0x31, 0x2c, 0x22, 0xd0, 0x2b, 0x7c, 0x74, 0xee, 0xb1, 0x91, 0x07, \
+        0x0b, 0x45
+#define FROM_ACCOUNT                                                                                            \
+    0x0c, 0x5d, 0x0e, 0x9f, 0x8e, 0x2d, 0x20, 0x1c, 0xf8, 0x91, 0xfb, 0xf9, 0x3a, 0x43, 0x5f, 0x15, 0x91, 0x4e, \
+        0x0b, 0x2b
+
+// NEO transfer(from, to, 10, null), followed by the two accounts again
+static const uint8_t EXPANDED[] = {
+    0x0b, 0x1a, 0x0c, 0x14, TO_ACCOUNT, 0x0c, 0x14, FROM_ACCOUNT, 0x14, 0xc0, 0x1f, 0x0c, 0x08, 0x74, 0x72,
+    0x61, 0x6e, 0x73, 0x66, 0x65, 0x72, 0x0c, 0x14, 0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e,
+    0x05, 0xc4, 0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef, 0x41, 0x62, 0x7d, 0x5b, 0x52, FROM_ACCOUNT,
+    TO_ACCOUNT};
+
+static const uint8_t COMPRESSED[] = {
+    0x03, 0x0b, 0x1a, 0x0c, 0x14,  // literal run
+    0xc8, TO_ACCOUNT,              // value 0
+    0x01, 0x0c, 0x14,              // literal run
+    0xc8, FROM_ACCOUNT,            // value 1
+    0x82, 0x80, 0x84,              // transfer call, NEO, System.Contract.Call
+    0xc1, 0xc0};                   // back-references
+
+/**
+ * Expand 'in' fed in chunks of 'chunk_len' bytes, with an output of 'out_size' bytes.
+ */
+static parser_status_e expand(const uint8_t *in,
+                              size_t in_len,
+                              size_t chunk_len,
+                              size_t out_size,
+                              tx_expander_t *expander,
+                              uint8_t *expanded,
+                              size_t *expanded_len) {
+    uint8_t out[256];
+
+    tx_expander_init(expander);
+    *expanded_len = 0;
+    for (size_t offset = 0; offset < in_len; offset += chunk_len) {
+        buffer_t buf = {.ptr = in + offset, .size = (in_len - offset < chunk_len) ? in_len - offset : chunk_len};
+
+        while (buf.offset < buf.size) {
+            size_t len = 0;
+            parser_status_e status = tx_expand(expander, &buf, out, out_size, &len);
+
+            if (status != PARSING_OK) {
+                return status;
+            }
+            assert_true(len <= out_size);
+            memcpy(expanded + *expanded_len, out, len);
+            *expanded_len += len;
+        }
+    }
+    return PARSING_OK;
+}
+
+static void test_expand(void **state) {
+    (void) state;
+
+    tx_expander_t expander;
+    uint8_t expanded[256];
+    size_t len;
+
+    // whole input at once, then any split of the input and of the output
+    for (size_t chunk_len = sizeof(COMPRESSED); chunk_len > 0; chunk_len--) {
+        for (size_t out_size = 256; out_size >= EXPAND_MAX_TOKEN_LEN; out_size /= 2) {
+            assert_int_equal(
+                expand(COMPRESSED, sizeof(COMPRESSED), chunk_len, out_size, &expander, expanded, &len),
+                PARSING_OK);
+            assert_true(tx_expander_complete(&expander));
+            assert_int_equal(len, sizeof(EXPANDED));
+            assert_memory_equal(expanded, EXPANDED, sizeof(EXPANDED));
+        }
+    }
+
+    // longest literal run
+    uint8_t literal[129];
+    memset(literal, 0x42, sizeof(literal));
+    literal[0] = 0x7f;
+    assert_int_equal(expand(literal, sizeof(literal), sizeof(literal), 256, &expander, expanded, &len), PARSING_OK);
+    assert_true(tx_expander_complete(&expander));
+    assert_int_equal(len, 128);
+}
+
+static void test_expand_invalid(void **state) {
+    (void) state;
+
+    tx_expander_t expander;
+    uint8_t expanded[256];
+    size_t len;
+
+    // unknown dictionary entry
+    const uint8_t dictionary[] = {0xbf};
+    assert_int_equal(expand(dictionary, sizeof(dictionary), 1, 256, &expander, expanded, &len),
+                     COMPRESSED_DATA_ERROR);
+
+    // back-reference to a value not received yet
+    const uint8_t back_reference[] = {0xc8, FROM_ACCOUNT, 0xc1};
+    assert_int_equal(expand(back_reference, sizeof(back_reference), 1, 256, &expander, expanded, &len),
+                     COMPRESSED_DATA_ERROR);
+
+    // reserved token
+    const uint8_t reserved[] = {0xff};
+    assert_int_equal(expand(reserved, sizeof(reserved), 1, 256, &expander, expanded, &len), COMPRESSED_DATA_ERROR);
+
+    // more values than can be remembered
+    uint8_t values[(MAX_EXPAND_VALUES + 1) * (1 + UINT160_LEN)] = {0};
+    for (size_t i = 0; i <= MAX_EXPAND_VALUES; i++) {
+        values[i * (1 + UINT160_LEN)] = EXPAND_TOKEN_VALUE;
+    }
+    assert_int_equal(expand(values, sizeof(values) - 1 - UINT160_LEN, 7, 256, &expander, expanded, &len),
+                     PARSING_OK);
+    assert_int_equal(expand(values, sizeof(values), 7, 256, &expander, expanded, &len), COMPRESSED_DATA_ERROR);
+
+    // truncated literal run and value
+    const uint8_t truncated_literal[] = {0x03, 0x0b, 0x1a};
+    assert_int_equal(expand(truncated_literal, sizeof(truncated_literal), 1, 256, &expander, expanded, &len),
+                     PARSING_OK);
+    assert_false(tx_expander_complete(&expander));
+    assert_int_equal(expand(COMPRESSED, 6, 6, 256, &expander, expanded, &len), PARSING_OK);
+    assert_false(tx_expander_complete(&expander));
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_expand), cmocka_unit_test(test_expand_invalid)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -4,6 +4,8 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
 
 #include <cmocka.h>
 
@@ -50,6 +52,96 @@ static void test_format_u64(void **state) {
     assert_false(format_u64(temp, sizeof(temp) - 5, value));
 }
 
+static void check_u64(uint64_t value) {
+    char expected[21] = {0};
+    char temp[21] = {0};
+    const int len = snprintf(expected, sizeof(expected), "%" PRIu64, value);
+
+    assert_true(format_u64(temp, sizeof(temp), value));
+    assert_string_equal(temp, expected);
+
+    // exact fit, then one byte short
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_u64(temp, len + 1, value));
+    assert_string_equal(temp, expected);
+    assert_false(format_u64(temp, len, value));
+}
+
+static void check_i64(int64_t value) {
+    char expected[22] = {0};
+    char temp[22] = {0};
+    const int len = snprintf(expected, sizeof(expected), "%" PRId64, value);
+
+    assert_true(format_i64(temp, sizeof(temp), value));
+    assert_string_equal(temp, expected);
+
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_i64(temp, len + 1, value));
+    assert_string_equal(temp, expected);
+    assert_false(format_i64(temp, len, value));
+}
+
+static void test_format_u64_edge_cases(void **state) {
+    (void) state;
+
+    // every power of ten and its neighbours: digit count and chunk boundaries
+    uint64_t power = 1;
+    for (int i = 0; i < 20; i++) {
+        check_u64(power - 1);
+        check_u64(power);
+        check_u64(power + 1);
+        check_i64((int64_t) (power - 1));
+        check_i64(-(int64_t) (power - 1));
+        if (power <= INT64_MAX / 10) {
+            check_i64((int64_t) power);
+            check_i64(-(int64_t) power);
+        }
+        if (i < 19) {
+            power *= 10;
+        }
+    }
+
+    // every power of two and its neighbours: limits of the reciprocal multiplications
+    for (int i = 0; i < 64; i++) {
+        const uint64_t value = 1ull << i;
+        check_u64(value - 1);
+        check_u64(value);
+        check_u64(value + 1);
+        check_i64((int64_t) (value - 1));
+        check_i64(-(int64_t) (value - 1));
+    }
+
+    check_u64(UINT64_MAX);
+    check_u64(UINT64_MAX - 1);
+    check_i64(INT64_MAX);
+    check_i64(INT64_MIN);
+    check_i64(INT64_MIN + 1);
+
+    // all two-digit pairs, in every 8-digit chunk position
+    for (uint64_t pair = 0; pair < 100; pair++) {
+        check_u64(pair);
+        check_u64(pair * 1000000ull + 99);
+        check_u64(pair * 100000000ull + 12345678);
+        check_u64(pair * 10000000000000000ull + 1);
+    }
+
+    // pseudo-random values spread over every magnitude
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 100000; i++) {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        const uint64_t value = seed >> (i % 64);
+        check_u64(value);
+        check_i64((int64_t) value);
+    }
+
+    // a single digit still needs room for the terminator
+    char temp[2] = {0};
+    assert_false(format_u64(temp, 1, 7));
+    assert_false(format_u64(temp, 0, 7));
+    assert_true(format_u64(temp, 2, 7));
+    assert_string_equal(temp, "7");
+}
+
 static void test_format_fpu64(void **state) {
     (void) state;
 
@@ -82,6 +174,186 @@ static void test_format_fpu64(void **state) {
     assert_false(format_fpu64(temp2, sizeof(temp2) - 20, amount, 18));
 }
 
+static uint256_t u256_from_u64(uint64_t value) {
+    uint256_t result = {0};
+
+    result.limbs[0] = (uint32_t) value;
+    result.limbs[1] = (uint32_t) (value >> 32);
+    return result;
+}
+
+static uint256_t u256_max_u128(void) {
+    uint256_t result = {0};
+
+    memset(result.limbs, 0xFF, 4 * sizeof(uint32_t));
+    return result;
+}
+
+/**
+ * Digit by digit reference: long division of the limbs by 10 with native divisions.
+ */
+static void reference_u256(const uint256_t *value, char *out) {
+    uint256_t rest = *value;
+    char reversed[UINT256_MAX_DIGITS + 1];
+    size_t len = 0;
+    bool zero;
+
+    do {
+        uint64_t remainder = 0;
+        zero = true;
+        for (int i = UINT256_LIMBS - 1; i >= 0; i--) {
+            const uint64_t current = (remainder << 32) | rest.limbs[i];
+            rest.limbs[i] = (uint32_t) (current / 10);
+            remainder = current % 10;
+            zero = zero && rest.limbs[i] == 0;
+        }
+        reversed[len++] = (char) ('0' + remainder);
+    } while (!zero);
+
+    for (size_t i = 0; i < len; i++) {
+        out[i] = reversed[len - 1 - i];
+    }
+    out[len] = '\0';
+}
+
+static void check_u256(const uint256_t *value) {
+    char expected[UINT256_MAX_DIGITS + 1] = {0};
+    char temp[UINT256_MAX_DIGITS + 1] = {0};
+
+    reference_u256(value, expected);
+    const size_t len = strlen(expected);
+
+    assert_true(format_u256(temp, sizeof(temp), value));
+    assert_string_equal(temp, expected);
+
+    // exact fit, then one byte short
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_u256(temp, len + 1, value));
+    assert_string_equal(temp, expected);
+    assert_false(format_u256(temp, len, value));
+}
+
+static void test_format_u256(void **state) {
+    (void) state;
+
+    char temp[UINT256_MAX_DIGITS + 1] = {0};
+    uint256_t value = {0};
+
+    assert_true(format_u256(temp, sizeof(temp), &value));
+    assert_string_equal(temp, "0");
+
+    value = u256_max_u128();  // MAX_UINT128
+    assert_true(format_u256(temp, sizeof(temp), &value));
+    assert_string_equal(temp, "340282366920938463463374607431768211455");
+
+    memset(&value, 0xFF, sizeof(value));  // MAX_UINT256
+    assert_true(format_u256(temp, sizeof(temp), &value));
+    assert_string_equal(temp, "115792089237316195423570985008687907853269984665640564039457584007913129639935");
+    assert_int_equal(strlen(temp), UINT256_MAX_DIGITS);
+
+    // buffer too small
+    assert_false(format_u256(temp, sizeof(temp) - 1, &value));
+
+    value.limbs[UINT256_LIMBS - 1] = 0x7FFFFFFF;  // largest PUSHINT256 operand
+    assert_true(format_u256(temp, sizeof(temp), &value));
+    assert_string_equal(temp, "57896044618658097711785492504343953926634992332820282019728792003956564819967");
+
+    // 10^18, the unit of 18 decimals tokens, matches the 64-bit formatting
+    value = u256_from_u64(1000000000000000000ull);
+    assert_true(format_u256(temp, sizeof(temp), &value));
+    assert_string_equal(temp, "1000000000000000000");
+}
+
+static void test_format_u256_edge_cases(void **state) {
+    (void) state;
+
+    // every power of ten and its neighbours: digit count and 9-digit group boundaries
+    uint256_t power = {0};
+    power.limbs[0] = 1;
+    for (int i = 0; i < UINT256_MAX_DIGITS; i++) {
+        uint256_t value = power;
+
+        check_u256(&value);
+        // power - 1, no power of ten is a multiple of 2^32
+        value.limbs[0]--;
+        check_u256(&value);
+        value.limbs[0] += 2;
+        check_u256(&value);
+
+        uint64_t carry = 0;
+        for (int j = 0; j < UINT256_LIMBS; j++) {
+            const uint64_t current = (uint64_t) power.limbs[j] * 10 + carry;
+            power.limbs[j] = (uint32_t) current;
+            carry = current >> 32;
+        }
+    }
+
+    // every power of two and its neighbours: limits of the reciprocal multiplication
+    for (int i = 0; i < 32 * UINT256_LIMBS; i++) {
+        uint256_t value = {0};
+
+        value.limbs[i / 32] = 1u << (i % 32);
+        check_u256(&value);
+        value.limbs[i / 32]++;
+        check_u256(&value);
+        // 2^i - 1
+        memset(&value, 0, sizeof(value));
+        for (int j = 0; j < i; j++) {
+            value.limbs[j / 32] |= 1u << (j % 32);
+        }
+        check_u256(&value);
+    }
+
+    // pseudo-random values of every limb count
+    uint64_t seed = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 20000; i++) {
+        uint256_t value = {0};
+
+        for (int j = 0; j <= i % UINT256_LIMBS; j++) {
+            seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+            value.limbs[j] = (uint32_t) (seed >> 32);
+        }
+        check_u256(&value);
+    }
+}
+
+static void test_format_fpu256(void **state) {
+    (void) state;
+
+    // like format_fpu64(), the buffer must also have room for 'decimals' more digits
+    char temp[UINT256_MAX_DIGITS + 2 + 18] = {0};
+    uint256_t value = u256_from_u64(1000000000000000000ull);  // 1 token of 18 decimals
+
+    assert_true(format_fpu256(temp, sizeof(temp), &value, 18));
+    assert_string_equal(temp, "1.000000000000000000");
+
+    value = u256_from_u64(100ull);
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_fpu256(temp, sizeof(temp), &value, 18));
+    assert_string_equal(temp, "0.000000000000000100");
+
+    // same result as the 64-bit formatting
+    char temp64[22] = {0};
+    value = u256_from_u64(24964823ull);
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_fpu256(temp, sizeof(temp), &value, 8));
+    assert_true(format_fpu64(temp64, sizeof(temp64), 24964823ull, 8));
+    assert_string_equal(temp, temp64);
+
+    // 2^128 - 1 with 18 decimals
+    value = u256_max_u128();
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_fpu256(temp, sizeof(temp), &value, 18));
+    assert_string_equal(temp, "340282366920938463463.374607431768211455");
+    // buffer too small
+    assert_false(format_fpu256(temp, strlen(temp), &value, 18));
+
+    memset(&value, 0xFF, sizeof(value));
+    memset(temp, 0, sizeof(temp));
+    assert_true(format_fpu256(temp, sizeof(temp), &value, 18));
+    assert_string_equal(temp, "115792089237316195423570985008687907853269984665640564039457.584007913129639935");
+}
+
 static void test_format_hex(void **state) {
     (void) state;
 
@@ -97,7 +369,11 @@ static void test_format_hex(void **state) {
 int main() {
     const struct CMUnitTest tests[] = {cmocka_unit_test(test_format_i64),
                                        cmocka_unit_test(test_format_u64),
+                                       cmocka_unit_test(test_format_u64_edge_cases),
                                        cmocka_unit_test(test_format_fpu64),
+                                       cmocka_unit_test(test_format_u256),
+                                       cmocka_unit_test(test_format_u256_edge_cases),
+                                       cmocka_unit_test(test_format_fpu256),
                                        cmocka_unit_test(test_format_hex)};
 
     return cmocka_run_group_tests(tests, NULL, NULL);
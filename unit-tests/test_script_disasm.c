@@ -0,0 +1,223 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdio.h>
+
+#include <cmocka.h>
+
+#include "transaction/script_disasm.h"
+
+// size of the review values of the app
+#define OUT_LEN 96
+
+// NEO transfer(from, to, 10, null)
+static const uint8_t TRANSFER_SCRIPT[] = {
+    0x0b, 0x1a, 0x0c, 0x14, 0x6d, 0xfb, 0xd7, 0x5c, 0x6d, 0x7a, 0x3e, 0x31, 0x2c, 0x22, 0xd0, 0x2b, 0x7c, 0x74,
+    0xee, 0xb1, 0x91, 0x07, 0x0b, 0x45, 0x0c, 0x14, 0x0c, 0x5d, 0x0e, 0x9f, 0x8e, 0x2d, 0x20, 0x1c, 0xf8, 0x91,
+    0xfb, 0xf9, 0x3a, 0x43, 0x5f, 0x15, 0x91, 0x4e, 0x0b, 0x2b, 0x14, 0xc0, 0x1f, 0x0c, 0x08, 0x74, 0x72, 0x61,
+    0x6e, 0x73, 0x66, 0x65, 0x72, 0x0c, 0x14, 0xf5, 0x63, 0xea, 0x40, 0xbc, 0x28, 0x3d, 0x4d, 0x0e, 0x05, 0xc4,
+    0x8e, 0xa3, 0x05, 0xb3, 0xf2, 0xa0, 0x73, 0x40, 0xef, 0x41, 0x62, 0x7d, 0x5b, 0x52};
+
+static const char *const TRANSFER_LISTING[] = {
+    "PUSHNULL",
+    "PUSH10",
+    "PUSHDATA1 6DFBD75C6D7A3E312C22D02B7C74EEB191070B45",
+    "PUSHDATA1 0C5D0E9F8E2D201CF891FBF93A435F15914E0B2B",
+    "PUSH4",
+    "PACK",
+    "PUSH15",
+    "PUSHDATA1 7472616E73666572",
+    "PUSHDATA1 F563EA40BC283D4D0E05C48EA305B3F2A07340EF",
+    "SYSCALL System.Contract.Call",
+};
+
+static void check_item(script_disasm_t *cursor,
+                       const uint8_t *script,
+                       size_t len,
+                       size_t script_size,
+                       uint16_t index,
+                       const char *expected) {
+    char out[OUT_LEN];
+
+    assert_true(script_disasm_format(cursor, script, len, script_size, index, out, sizeof(out)));
+    assert_string_equal(out, expected);
+}
+
+static void test_disasm_transfer(void **state) {
+    (void) state;
+
+    const size_t count = sizeof(TRANSFER_LISTING) / sizeof(TRANSFER_LISTING[0]);
+    script_disasm_t cursor;
+    char out[OUT_LEN];
+
+    assert_int_equal(script_disasm_count(TRANSFER_SCRIPT, sizeof(TRANSFER_SCRIPT), sizeof(TRANSFER_SCRIPT)), count);
+    assert_int_equal(script_disasm_decoded_len(TRANSFER_SCRIPT, sizeof(TRANSFER_SCRIPT), sizeof(TRANSFER_SCRIPT)),
+                     sizeof(TRANSFER_SCRIPT));
+
+    // forward, backward, then random access
+    script_disasm_init(&cursor);
+    for (size_t i = 0; i < count; i++) {
+        check_item(&cursor, TRANSFER_SCRIPT, sizeof(TRANSFER_SCRIPT), sizeof(TRANSFER_SCRIPT), i, TRANSFER_LISTING[i]);
+    }
+    for (size_t i = count; i-- > 0;) {
+        check_item(&cursor, TRANSFER_SCRIPT, sizeof(TRANSFER_SCRIPT), sizeof(TRANSFER_SCRIPT), i, TRANSFER_LISTING[i]);
+    }
+    const uint16_t order[] = {7, 2, 9, 0, 5, 5, 8};
+    for (size_t i = 0; i < sizeof(order) / sizeof(order[0]); i++) {
+        check_item(&cursor,
+                   TRANSFER_SCRIPT,
+                   sizeof(TRANSFER_SCRIPT),
+                   sizeof(TRANSFER_SCRIPT),
+                   order[i],
+                   TRANSFER_LISTING[order[i]]);
+    }
+
+    // no item past the end
+    assert_false(script_disasm_format(&cursor,
+                                      TRANSFER_SCRIPT,
+                                      sizeof(TRANSFER_SCRIPT),
+                                      sizeof(TRANSFER_SCRIPT),
+                                      count,
+                                      out,
+                                      sizeof(out)));
+}
+
+static void test_disasm_operands(void **state) {
+    (void) state;
+
+    // clang-format off
+    const uint8_t script[] = {
+        0x00, 0xfb,                                      // PUSHINT8 -5
+        0x01, 0x00, 0x80,                                // PUSHINT16 -32768
+        0x03, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0x7f,  // PUSHINT64 max
+        0x05, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,  // PUSHINT256 -2^255
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x80,
+        0x22, 0xfd,                                      // JMP -3
+        0x57, 0x01, 0x02,                                // INITSLOT 0102
+        0x6a,                                            // LDLOC2
+        0x0c, 0x00,                                      // PUSHDATA1 empty
+        0x0d, 0x02, 0x00, 0xab, 0xcd,                    // PUSHDATA2 ABCD
+        0x41, 0xf8, 0x27, 0xec, 0x8c,                    // SYSCALL System.Runtime.CheckWitness
+        0x41, 0x01, 0x02, 0x03, 0x04,                    // SYSCALL unknown
+        0x40,                                            // RET
+    };
+    // clang-format on
+    const char *const listing[] = {
+        "PUSHINT8 -5",
+        "PUSHINT16 -32768",
+        "PUSHINT64 9223372036854775807",
+        "PUSHINT256 -57896044618658097711785492504343953926634992332820282019728792003956564819968",
+        "JMP -3",
+        "INITSLOT 0102",
+        "LDLOC2",
+        "PUSHDATA1",
+        "PUSHDATA2 ABCD",
+        "SYSCALL System.Runtime.CheckWitness",
+        "SYSCALL 01020304",
+        "RET",
+    };
+    const size_t count = sizeof(listing) / sizeof(listing[0]);
+    script_disasm_t cursor;
+
+    script_disasm_init(&cursor);
+    assert_int_equal(script_disasm_count(script, sizeof(script), sizeof(script)), count);
+    for (size_t i = 0; i < count; i++) {
+        check_item(&cursor, script, sizeof(script), sizeof(script), i, listing[i]);
+    }
+}
+
+static void test_disasm_not_decoded(void **state) {
+    (void) state;
+
+    uint8_t script[128];
+    script_disasm_t cursor;
+    char out[OUT_LEN];
+
+    // unknown opcode: the rest of the script is summed up
+    const uint8_t unknown[] = {0x11, 0x06, 0x11, 0x11};
+    script_disasm_init(&cursor);
+    assert_int_equal(script_disasm_count(unknown, sizeof(unknown), sizeof(unknown)), 2);
+    check_item(&cursor, unknown, sizeof(unknown), sizeof(unknown), 0, "PUSH1");
+    check_item(&cursor, unknown, sizeof(unknown), sizeof(unknown), 1, "3 more bytes not shown");
+    assert_int_equal(script_disasm_decoded_len(unknown, sizeof(unknown), sizeof(unknown)), 1);
+
+    // operand truncated by the end of the script
+    const uint8_t truncated[] = {0x10, 0x02, 0x01};
+    script_disasm_init(&cursor);
+    assert_int_equal(script_disasm_count(truncated, sizeof(truncated), sizeof(truncated)), 2);
+    check_item(&cursor, truncated, sizeof(truncated), sizeof(truncated), 1, "2 more bytes not shown");
+    assert_int_equal(script_disasm_decoded_len(truncated, sizeof(truncated), sizeof(truncated)), 1);
+
+    // only the prefix of a large script is retained: the data crossing its end is cut, then the rest is summed up
+    memset(script, 0x21, sizeof(script));  // NOP
+    script[120] = 0x0d;                    // PUSHDATA2 of 1000 bytes
+    script[121] = 0xe8;
+    script[122] = 0x03;
+    const size_t script_size = 60000;
+    assert_int_equal(script_disasm_count(script, sizeof(script), script_size), 122);
+    script_disasm_init(&cursor);
+    check_item(&cursor, script, sizeof(script), script_size, 119, "NOP");
+    check_item(&cursor, script, sizeof(script), script_size, 120, "PUSHDATA2 2121212121... (1000 bytes)");
+    check_item(&cursor, script, sizeof(script), script_size, 121, "58877 more bytes not shown");
+    assert_int_equal(script_disasm_decoded_len(script, sizeof(script), script_size), 60000 - 58877);
+    assert_false(script_disasm_format(&cursor, script, sizeof(script), script_size, 122, out, sizeof(out)));
+
+    // data too long for the output
+    memset(script, 0x42, sizeof(script));
+    script[0] = 0x0c;
+    script[1] = 75;
+    script_disasm_init(&cursor);
+    assert_int_equal(script_disasm_count(script, 77, 77), 1);
+    assert_true(script_disasm_format(&cursor, script, 77, 77, 0, out, sizeof(out)));
+    assert_true(strlen(out) >= sizeof(out) - 2);
+    assert_string_equal(out + strlen(out) - strlen("... (75 bytes)"), "... (75 bytes)");
+
+    // output too small
+    script_disasm_init(&cursor);
+    assert_false(script_disasm_format(&cursor, TRANSFER_SCRIPT, sizeof(TRANSFER_SCRIPT), sizeof(TRANSFER_SCRIPT),
+                                      9, out, 10));
+    assert_true(script_disasm_format(&cursor, TRANSFER_SCRIPT, sizeof(TRANSFER_SCRIPT), sizeof(TRANSFER_SCRIPT),
+                                     0, out, 9));
+    assert_string_equal(out, "PUSHNULL");
+}
+
+static void test_disasm_every_opcode(void **state) {
+    (void) state;
+
+    uint8_t script[64];
+    script_disasm_t cursor;
+    char out[OUT_LEN];
+    int known = 0;
+
+    // any opcode either decodes as one item with its zeroed operand, or is summed up with the rest of the script
+    for (int opcode = 0; opcode < 256; opcode++) {
+        memset(script, 0, sizeof(script));
+        script[0] = (uint8_t) opcode;
+        script_disasm_init(&cursor);
+
+        const uint16_t count = script_disasm_count(script, sizeof(script), sizeof(script));
+        assert_true(script_disasm_format(&cursor, script, sizeof(script), sizeof(script), 0, out, sizeof(out)));
+        if (strstr(out, "not shown") == NULL) {
+            assert_true(count > 1);
+            known++;
+        } else {
+            assert_int_equal(count, 1);
+            assert_string_equal(out, "64 more bytes not shown");
+        }
+    }
+    assert_int_equal(known, 196);
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_disasm_transfer),
+                                       cmocka_unit_test(test_disasm_operands),
+                                       cmocka_unit_test(test_disasm_not_decoded),
+                                       cmocka_unit_test(test_disasm_every_opcode)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}
@@ -0,0 +1,73 @@
+#include <stdarg.h>
+#include <stddef.h>
+#include <setjmp.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include <cmocka.h>
+
+#include "sign_cache.h"
+
+static const uint32_t PATH[BIP44_PATH_LEN] = {0x8000002C, 0x80000378, 0x80000000, 0, 0};
+static const uint32_t OTHER_PATH[BIP44_PATH_LEN] = {0x8000002C, 0x80000378, 0x80000000, 0, 1};
+
+static void test_sign_cache_find(void **state) {
+    (void) state;
+
+    uint8_t hash[32] = {0x42};
+    uint8_t signature[MAX_DER_SIG_LEN];
+    memset(signature, 0x30, sizeof(signature));
+
+    sign_cache_clear();
+    assert_null(sign_cache_find(860833102, hash, PATH));
+
+    sign_cache_add(860833102, hash, PATH, signature, 70);
+    const sign_cache_entry_t *entry = sign_cache_find(860833102, hash, PATH);
+    assert_non_null(entry);
+    assert_int_equal(entry->signature_len, 70);
+    assert_memory_equal(entry->signature, signature, 70);
+
+    // any difference in the magic, the hash or the path is another transaction
+    assert_null(sign_cache_find(894710606, hash, PATH));
+    assert_null(sign_cache_find(860833102, hash, OTHER_PATH));
+    hash[31] = 1;
+    assert_null(sign_cache_find(860833102, hash, PATH));
+
+    sign_cache_clear();
+    hash[31] = 0;
+    assert_null(sign_cache_find(860833102, hash, PATH));
+}
+
+static void test_sign_cache_bounded(void **state) {
+    (void) state;
+
+    uint8_t hash[32] = {0};
+    uint8_t signature[MAX_DER_SIG_LEN] = {0x30};
+
+    sign_cache_clear();
+    for (uint8_t i = 0; i <= SIGN_CACHE_SIZE; i++) {
+        hash[0] = i;
+        sign_cache_add(860833102, hash, PATH, signature, 71);
+    }
+
+    // the oldest signature was replaced
+    hash[0] = 0;
+    assert_null(sign_cache_find(860833102, hash, PATH));
+    for (uint8_t i = 1; i <= SIGN_CACHE_SIZE; i++) {
+        hash[0] = i;
+        assert_non_null(sign_cache_find(860833102, hash, PATH));
+    }
+
+    // adding the same signature again does not take another entry
+    sign_cache_add(860833102, hash, PATH, signature, 71);
+    hash[0] = 1;
+    assert_non_null(sign_cache_find(860833102, hash, PATH));
+}
+
+int main() {
+    const struct CMUnitTest tests[] = {cmocka_unit_test(test_sign_cache_find),
+                                       cmocka_unit_test(test_sign_cache_bounded)};
+
+    return cmocka_run_group_tests(tests, NULL, NULL);
+}